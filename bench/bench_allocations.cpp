@@ -0,0 +1,46 @@
+#include "bench_common.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+  std::atomic<std::size_t> allocation_count{0};
+  std::atomic<std::size_t> allocation_bytes{0};
+}
+
+void* operator new(std::size_t size)
+{
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+  void* memory = std::malloc(size ? size : 1);
+  if (!memory)
+  {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+  ::operator delete(memory);
+}
+
+namespace gds_bench {
+
+  std::size_t allocations()
+  {
+    return allocation_count.load(std::memory_order_relaxed);
+  }
+
+  std::size_t allocated_bytes()
+  {
+    return allocation_bytes.load(std::memory_order_relaxed);
+  }
+
+} // namespace gds_bench
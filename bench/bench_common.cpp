@@ -0,0 +1,20 @@
+#include "bench_common.hpp"
+
+#include <cstdlib>
+
+namespace gds_bench {
+
+  int runs_argument(int argc, char** argv, int fallback)
+  {
+    if (argc > 1)
+    {
+      const int runs = std::atoi(argv[1]);
+      if (runs > 0)
+      {
+        return runs;
+      }
+    }
+    return fallback;
+  }
+
+} // namespace gds_bench
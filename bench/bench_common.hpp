@@ -0,0 +1,59 @@
+#ifndef GDS_BENCH_COMMON_HPP
+#define GDS_BENCH_COMMON_HPP
+
+#include "fixtures.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+/**
+ * Helpers shared by the benchmarks: sample messages and a timer that also counts the heap allocations.
+ * The allocations are counted by replacing the global operator new in bench_allocations.cpp.
+ */
+namespace gds_bench {
+
+    // the operator new calls and the bytes requested since the program started
+    std::size_t allocations();
+    std::size_t allocated_bytes();
+
+    using gds_fixtures::make_header;
+    using gds_fixtures::make_query_reply;
+    using gds_fixtures::pack_message;
+
+    struct Measurement {
+        double milliseconds = 0; // per run
+        double allocations = 0; // per run
+        double kilobytes = 0; // allocated per run
+    };
+
+    // runs the function the given number of times
+    template <typename Function>
+    Measurement measure(int runs, Function&& function)
+    {
+        const std::size_t allocations_before = allocations();
+        const std::size_t bytes_before = allocated_bytes();
+        const auto start = std::chrono::steady_clock::now();
+        for (int run = 0; run < runs; ++run)
+        {
+            function();
+        }
+        const auto end = std::chrono::steady_clock::now();
+        Measurement result;
+        result.milliseconds = std::chrono::duration<double, std::milli>(end - start).count() / runs;
+        result.allocations = double(allocations() - allocations_before) / runs;
+        result.kilobytes = double(allocated_bytes() - bytes_before) / 1024 / runs;
+        return result;
+    }
+
+    inline void print(const char* name, const Measurement& result)
+    {
+        std::printf("%-40s %12.4f ms %8.1f allocs %10.1f KB\n", name, result.milliseconds, result.allocations, result.kilobytes);
+    }
+
+    // the first command line argument as a positive number, or the default
+    int runs_argument(int argc, char** argv, int fallback);
+
+} // namespace gds_bench
+
+#endif // GDS_BENCH_COMMON_HPP
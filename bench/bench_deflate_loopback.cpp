@@ -0,0 +1,208 @@
+// Round trips through the client to a local echo server, with and without permessage-deflate: the server answers the
+// login and sends every other message back, compressed with its own context if the extension was agreed on. Measures
+// the packing, compressing, inflating and peeking of query replies of 20 and 5000 rows over the loopback interface,
+// and prints the bytes sent on the wire per message. Usage: bench_deflate_loopback [runs]
+#include "bench_common.hpp"
+#include "gds_connection.hpp"
+#include "gds_deflate.hpp"
+
+#include <simple-websocket-server/server_ws.hpp>
+
+#include <condition_variable>
+#include <future>
+
+using namespace gds_lib::gds_types;
+using gds_lib::connection::MessageDeflater;
+using gds_lib::connection::MessageInflater;
+
+namespace {
+  using WsServer = SimpleWeb::SocketServer<SimpleWeb::WS>;
+
+  // one connection at a time, the handlers run on the thread of the server
+  class EchoServer
+  {
+    WsServer m_server;
+    std::thread m_thread;
+    std::unique_ptr<MessageDeflater> m_deflater;
+    std::unique_ptr<MessageInflater> m_inflater;
+    std::string m_inflated;
+    std::string m_deflated;
+    std::atomic<std::size_t> m_received_bytes{0};
+
+    void send(const std::shared_ptr<WsServer::Connection>& connection, const std::string& message)
+    {
+      auto out = std::make_shared<WsServer::OutMessage>(message.size());
+      if (m_deflater && message.size() >= gds_lib::connection::DeflateOptions{}.min_size)
+      {
+        m_deflater->compress(message.data(), message.size(), m_deflated);
+        out->write(m_deflated.data(), static_cast<std::streamsize>(m_deflated.size()));
+        connection->send(out, nullptr, 130 | 0x40);
+      }
+      else
+      {
+        out->write(message.data(), static_cast<std::streamsize>(message.size()));
+        connection->send(out, nullptr, 130);
+      }
+    }
+
+    void on_message(const std::shared_ptr<WsServer::Connection>& connection, const std::shared_ptr<WsServer::InMessage>& in)
+    {
+      m_received_bytes += in->size();
+      std::string message = in->string();
+      if (in->fin_rsv_opcode & 0x40)
+      {
+        m_inflater->decompress(message.data(), message.size(), m_inflated);
+        message.swap(m_inflated);
+      }
+      const GdsMessageHeader header = GdsMessageHeader::peek(message.data(), message.size(), ValidationLevel::TRUSTED);
+      if (header.dataType != GdsMsgType::LOGIN)
+      {
+        send(connection, message);
+        return;
+      }
+      const GdsMessage login = gds_fixtures::unpack_message(message);
+      GdsMessage reply = gds_bench::make_header(GdsMsgType::LOGIN_REPLY);
+      auto body = std::make_shared<GdsLoginReplyMessage>();
+      body->ackStatus = 200;
+      body->loginReply = *std::static_pointer_cast<GdsLoginMessage>(login.messageBody);
+      reply.messageBody = body;
+      send(connection, gds_bench::pack_message(reply));
+    }
+
+  public:
+    EchoServer()
+    {
+      m_server.config.address = "127.0.0.1";
+      m_server.config.port = 0;
+      auto& endpoint = m_server.endpoint["^/gate/?$"];
+      endpoint.on_handshake = [this](std::shared_ptr<WsServer::Connection> connection, SimpleWeb::CaseInsensitiveMultimap& response_header) {
+        // the offer of the client is accepted with the defaults: context takeover and 15 bit windows on both sides
+        auto offer = connection->header.find("Sec-WebSocket-Extensions");
+        const bool deflate = offer != connection->header.end() && offer->second.find("permessage-deflate") != std::string::npos;
+        m_deflater = deflate ? std::make_unique<MessageDeflater>(-1, 15, false) : nullptr;
+        m_inflater = deflate ? std::make_unique<MessageInflater>(false, gds_lib::connection::DeflateOptions{}.max_message_size) : nullptr;
+        if (deflate)
+        {
+          response_header.emplace("Sec-WebSocket-Extensions", "permessage-deflate");
+        }
+        return SimpleWeb::StatusCode::information_switching_protocols;
+      };
+      endpoint.on_message = [this](std::shared_ptr<WsServer::Connection> connection, std::shared_ptr<WsServer::InMessage> in) {
+        on_message(connection, in);
+      };
+    }
+
+    ~EchoServer()
+    {
+      m_server.stop();
+      m_thread.join();
+    }
+
+    unsigned short start()
+    {
+      std::promise<unsigned short> port;
+      m_thread = std::thread([&]() {
+        m_server.start([&](unsigned short bound) { port.set_value(bound); });
+      });
+      return port.get_future().get();
+    }
+
+    std::size_t received_bytes() const { return m_received_bytes; }
+  };
+
+  // counts the echoed messages, they are only peeked
+  struct Listener : public gds_lib::connection::GDSMessageListener
+  {
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool logged_in = false;
+    bool failed = false;
+    std::size_t echoed = 0;
+
+    bool on_message_header(const GdsMessageHeader&) override
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      ++echoed;
+      changed.notify_all();
+      return true;
+    }
+
+    void on_connection_success(gds_message_t, std::shared_ptr<GdsLoginReplyMessage>) override
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      logged_in = true;
+      changed.notify_all();
+    }
+
+    void on_connection_failure(const std::optional<gds_lib::connection::connection_error>&,
+                               std::optional<std::pair<gds_message_t, std::shared_ptr<GdsLoginReplyMessage>>>) override
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      failed = true;
+      changed.notify_all();
+    }
+
+    // false if the connection failed
+    bool wait_for_login()
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      changed.wait(lock, [this]() { return logged_in || failed; });
+      return logged_in;
+    }
+
+    void wait_for_echo(std::size_t count)
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      changed.wait(lock, [&]() { return echoed >= count || failed; });
+    }
+  };
+
+  void round_trips(int runs, unsigned short port, bool deflate, EchoServer& server)
+  {
+    const char* mode = deflate ? "deflate" : "plain";
+    auto listener = std::make_shared<Listener>();
+    gds_lib::connection::DeflateOptions options;
+    options.enabled = deflate;
+    auto client = gds_lib::connection::GDSBuilder()
+                      .with_uri("127.0.0.1:" + std::to_string(port) + "/gate")
+                      .with_callbacks(listener)
+                      .with_compression(options)
+                      .build();
+    client->start();
+    if (!listener->wait_for_login())
+    {
+      std::printf("%s: the login failed\n", mode);
+      return;
+    }
+
+    for (std::size_t rows : {20, 5000})
+    {
+      const GdsMessage reply = gds_bench::make_query_reply(rows);
+      const std::size_t received_before = server.received_bytes();
+      const std::string name = "query reply " + std::to_string(rows) + " rows, " + mode;
+      gds_bench::print(name.c_str(), gds_bench::measure(runs, [&]() {
+        std::size_t expected;
+        {
+          std::lock_guard<std::mutex> lock(listener->mutex);
+          expected = listener->echoed + 1;
+        }
+        client->send(reply);
+        listener->wait_for_echo(expected);
+      }));
+      std::printf("%-40s %12zu bytes\n", (name + ", sent").c_str(), (server.received_bytes() - received_before) / runs);
+    }
+    client->close();
+  }
+}
+
+int main(int argc, char** argv)
+{
+  const int runs = gds_bench::runs_argument(argc, argv, 50);
+  std::printf("%d runs\n", runs);
+
+  EchoServer server;
+  const unsigned short port = server.start();
+  round_trips(runs, port, false, server);
+  round_trips(runs, port, true, server);
+  return 0;
+}
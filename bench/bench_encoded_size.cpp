@@ -0,0 +1,72 @@
+// Packing into a fresh WebSocket message buffer as the client does, growing the buffer and sizing it with
+// encoded_size() first: an event with 4 x 1 MB attachments and a query reply of 5000 rows. The computed size is compared
+// with packing the message into a CountingPackBuffer as well. Usage: bench_encoded_size [runs]
+#include "bench_common.hpp"
+#include "gds_clients.hpp"
+
+using namespace gds_lib::gds_types;
+
+namespace {
+  std::size_t pack_into_streambuf(const GdsHeaderTemplate& header, const GdsMessage& message, bool sized)
+  {
+    SimpleWeb::asio::streambuf streambuf;
+    {
+      gds_lib::client::StreambufPackBuffer<SimpleWeb::asio::streambuf> buffer(streambuf);
+      if (sized)
+      {
+        buffer.reserve(header.encoded_size(message));
+      }
+      header.pack(buffer, message);
+    }
+    return streambuf.size();
+  }
+
+  std::size_t counted_size(const GdsMessage& message)
+  {
+    EncodeOptions trusted;
+    trusted.validation = ValidationLevel::TRUSTED;
+    CountingPackBuffer counter;
+    message.pack_into(counter, trusted);
+    return counter.size();
+  }
+}
+
+int main(int argc, char** argv)
+{
+  const int runs = gds_bench::runs_argument(argc, argv, 50);
+  std::printf("%d runs\n", runs);
+
+  GdsMessage event = gds_bench::make_header(GdsMsgType::EVENT);
+  auto body = std::make_shared<GdsEventMessage>();
+  body->operations = "INSERT INTO multi_event VALUES(1)";
+  for (int index = 0; index < 4; ++index)
+  {
+    body->binaryContents["attachment-" + std::to_string(index)] = byte_array(1 << 20, static_cast<uint8_t>(index));
+  }
+  event.messageBody = body;
+  const GdsMessage reply = gds_bench::make_query_reply(5000);
+  const GdsHeaderTemplate header("user");
+
+  gds_bench::print("event 4 x 1 MB, growing", gds_bench::measure(runs, [&]() {
+    pack_into_streambuf(header, event, false);
+  }));
+  gds_bench::print("event 4 x 1 MB, encoded_size", gds_bench::measure(runs, [&]() {
+    pack_into_streambuf(header, event, true);
+  }));
+  gds_bench::print("query reply 5000 rows, growing", gds_bench::measure(runs, [&]() {
+    pack_into_streambuf(header, reply, false);
+  }));
+  gds_bench::print("query reply 5000 rows, encoded_size", gds_bench::measure(runs, [&]() {
+    pack_into_streambuf(header, reply, true);
+  }));
+  std::size_t sizes = 0;
+  gds_bench::print("query reply 5000 rows, size computed", gds_bench::measure(runs, [&]() {
+    sizes += reply.encoded_size();
+  }));
+  gds_bench::print("query reply 5000 rows, size counted", gds_bench::measure(runs, [&]() {
+    sizes += counted_size(reply);
+  }));
+  // both ways give the same size, it is summed so the computation is not left out
+  std::printf("%-40s %12zu bytes\n", "query reply 5000 rows, size", sizes / (2 * static_cast<std::size_t>(runs)));
+  return 0;
+}
@@ -0,0 +1,77 @@
+// Decoding the map-heavy parts of the messages: an event with 8 attachments and 2 priority levels, and a row of
+// 16 MAP cells of 4 entries, from the packed bytes with MessageReader and through a msgpack object. Usage: bench_flat_map [runs]
+#include "bench_common.hpp"
+#include "gds_reader.hpp"
+
+using namespace gds_lib::gds_types;
+
+int main(int argc, char** argv)
+{
+  const int runs = gds_bench::runs_argument(argc, argv, 100000);
+  std::printf("%d runs\n", runs);
+
+  GdsEventMessage event;
+  event.operations = "INSERT INTO multi_event VALUES(1)";
+  for (int index = 0; index < 8; ++index)
+  {
+    event.binaryContents["attachment-" + std::to_string(index)] = byte_array(16, static_cast<uint8_t>(index));
+  }
+  flat_map<int32_t, bool> levels;
+  levels[1] = true;
+  levels[2] = false;
+  event.priorityLevels = {{levels}, {levels}};
+  std::string packed_event;
+  {
+    msgpack::sbuffer buffer;
+    PackBufferAdapter<msgpack::sbuffer> adapter(buffer);
+    Packer packer(adapter);
+    event.pack(packer);
+    packed_event.assign(buffer.data(), buffer.size());
+  }
+
+  std::string packed_cells;
+  {
+    msgpack::sbuffer buffer;
+    msgpack::packer<msgpack::sbuffer> packer(buffer);
+    packer.pack_array(16);
+    for (int cell = 0; cell < 16; ++cell)
+    {
+      packer.pack_map(4);
+      for (int entry = 1; entry <= 4; ++entry)
+      {
+        packer.pack("k" + std::to_string(entry));
+        packer.pack("v" + std::to_string(entry));
+      }
+    }
+    packed_cells.assign(buffer.data(), buffer.size());
+  }
+
+  gds_bench::print("event, reader", gds_bench::measure(runs, [&]() {
+    MessageReader reader(packed_event.data(), packed_event.size());
+    GdsEventMessage message;
+    message.read(reader, DecodeOptions{});
+  }));
+  gds_bench::print("event, object unpack", gds_bench::measure(runs, [&]() {
+    msgpack::object_handle handle = msgpack::unpack(packed_event.data(), packed_event.size());
+    GdsEventMessage message;
+    message.unpack(handle.get());
+  }));
+  gds_bench::print("16 MAP cells, reader", gds_bench::measure(runs, [&]() {
+    MessageReader reader(packed_cells.data(), packed_cells.size());
+    std::vector<GdsFieldValue> row(reader.read_array_header());
+    for (GdsFieldValue& value : row)
+    {
+      value.read(reader, DecodeOptions{});
+    }
+  }));
+  gds_bench::print("16 MAP cells, object unpack", gds_bench::measure(runs, [&]() {
+    msgpack::object_handle handle = msgpack::unpack(packed_cells.data(), packed_cells.size());
+    const msgpack::object_array& cells = handle.get().via.array;
+    std::vector<GdsFieldValue> row(cells.size);
+    for (uint32_t index = 0; index < cells.size; ++index)
+    {
+      row[index].unpack(cells.ptr[index]);
+    }
+  }));
+  return 0;
+}
@@ -0,0 +1,72 @@
+// Packing the small messages a client sends most often, by GdsMessage::pack() and from a GdsHeaderTemplate of the user:
+// an INSERT event, an attachment request and a query. The messages are packed into a reused buffer, a run packs
+// every message 1000 times. Usage: bench_header_template [runs]
+#include "bench_common.hpp"
+
+using namespace gds_lib::gds_types;
+
+namespace {
+  constexpr int messages_per_run = 1000;
+
+  GdsMessage with_body(int32_t type, std::shared_ptr<Packable> body)
+  {
+    GdsMessage message = gds_bench::make_header(type);
+    message.messageBody = std::move(body);
+    return message;
+  }
+
+  void compare(const char* name, int runs, const GdsHeaderTemplate& header, const GdsMessage& message)
+  {
+    msgpack::sbuffer buffer;
+    message.pack_into(buffer);
+    const std::string packed(buffer.data(), buffer.size());
+    buffer.clear();
+    header.pack_into(buffer, message);
+    // the template falls back to GdsMessage::pack() if it does not match, the output is the same either way
+    if (!header.matches(message) || packed != std::string(buffer.data(), buffer.size()))
+    {
+      std::printf("%s: the template did not pack the same bytes\n", name);
+      return;
+    }
+
+    const std::string message_name = std::string(name) + ", GdsMessage";
+    gds_bench::print(message_name.c_str(), gds_bench::measure(runs, [&]() {
+      for (int index = 0; index < messages_per_run; ++index)
+      {
+        buffer.clear();
+        message.pack_into(buffer);
+      }
+    }));
+    const std::string template_name = std::string(name) + ", template";
+    gds_bench::print(template_name.c_str(), gds_bench::measure(runs, [&]() {
+      for (int index = 0; index < messages_per_run; ++index)
+      {
+        buffer.clear();
+        header.pack_into(buffer, message);
+      }
+    }));
+  }
+}
+
+int main(int argc, char** argv)
+{
+  const int runs = gds_bench::runs_argument(argc, argv, 200);
+  std::printf("%d runs of %d messages\n", runs, messages_per_run);
+
+  const GdsHeaderTemplate header("user");
+
+  auto event = std::make_shared<GdsEventMessage>();
+  event->operations = "INSERT INTO multi_event (id, plate, speed) VALUES('EVNT202001010000000000', 'ABC123', 90)";
+  compare("event INSERT", runs, header, with_body(GdsMsgType::EVENT, event));
+
+  auto attachment = std::make_shared<GdsAttachmentRequestMessage>();
+  attachment->request = "SELECT meta, data, \"@to_valid\" FROM \"multi_event-@attachment\" WHERE id='ATID202001010000000000' and ownerid='EVNT202001010000000000' FOR UPDATE WAIT 86400";
+  compare("attachment request", runs, header, with_body(GdsMsgType::ATTACHMENT_REQUEST, attachment));
+
+  auto query = std::make_shared<GdsQueryRequestMessage>();
+  query->selectString = "SELECT * FROM multi_event";
+  query->consistency = "PAGES";
+  query->timeout = 60000;
+  compare("query", runs, header, with_body(GdsMsgType::QUERY, query));
+  return 0;
+}
@@ -0,0 +1,54 @@
+// Packing and decoding a query reply of 200000 rows with the given number of threads, the best of the runs.
+// Usage: bench_parallel [threads] [runs], 0 threads is the number of cores. The pool is started once, before the runs
+#include "bench_common.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+using namespace gds_lib::gds_types;
+
+int main(int argc, char** argv)
+{
+  const unsigned threads = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 1;
+  const int runs = argc > 2 ? std::max(1, std::atoi(argv[2])) : 5;
+  ParallelOptions parallel;
+  parallel.pool = WorkerPool::create(threads);
+
+  const GdsMessage reply = gds_bench::make_query_reply(200000);
+  const std::string packed = gds_bench::pack_message(reply);
+  std::printf("query reply, 200000 rows, %zu bytes, %zu pool threads, best of %d runs\n", packed.size(),
+              parallel.pool ? parallel.pool->size() : std::size_t(0), runs);
+
+  DecodeOptions options;
+  options.parallel = parallel;
+  EncodeOptions encode;
+  encode.parallel = parallel;
+  gds_bench::Measurement pack, read, unpack;
+  pack.milliseconds = read.milliseconds = unpack.milliseconds = 1e12;
+  auto keep_best = [](gds_bench::Measurement& best, const gds_bench::Measurement& result) {
+    if (result.milliseconds < best.milliseconds)
+    {
+      best = result;
+    }
+  };
+  for (int run = 0; run < runs; ++run)
+  {
+    keep_best(pack, gds_bench::measure(1, [&]() {
+      msgpack::sbuffer buffer(packed.size());
+      reply.pack_into(buffer, encode);
+    }));
+    keep_best(read, gds_bench::measure(1, [&]() {
+      GdsMessage message;
+      message.unpack(packed.data(), packed.size(), options);
+    }));
+    keep_best(unpack, gds_bench::measure(1, [&]() {
+      msgpack::object_handle handle = msgpack::unpack(packed.data(), packed.size());
+      GdsMessage message;
+      message.unpack(handle.get(), options);
+    }));
+  }
+  gds_bench::print("pack", pack);
+  gds_bench::print("reader", read);
+  gds_bench::print("object unpack", unpack);
+  return 0;
+}
@@ -0,0 +1,36 @@
+// Decoding a query reply of 20000 rows from the packed bytes: through a msgpack object tree and with MessageReader,
+// in the rows and the columns layout. Usage: bench_reader [runs]
+#include "bench_common.hpp"
+
+using namespace gds_lib::gds_types;
+
+int main(int argc, char** argv)
+{
+  const int runs = gds_bench::runs_argument(argc, argv, 20);
+  const std::string packed = gds_bench::pack_message(gds_bench::make_query_reply(20000));
+  std::printf("query reply, 20000 rows x 6 fields, %zu bytes, %d runs\n", packed.size(), runs);
+
+  DecodeOptions rows;
+  DecodeOptions columns;
+  columns.hits = HitsLayout::COLUMNS;
+
+  gds_bench::print("object path, rows", gds_bench::measure(runs, [&]() {
+    msgpack::object_handle handle = msgpack::unpack(packed.data(), packed.size());
+    GdsMessage message;
+    message.unpack(handle.get(), rows);
+  }));
+  gds_bench::print("reader, rows", gds_bench::measure(runs, [&]() {
+    GdsMessage message;
+    message.unpack(packed.data(), packed.size(), rows);
+  }));
+  gds_bench::print("object path, columns", gds_bench::measure(runs, [&]() {
+    msgpack::object_handle handle = msgpack::unpack(packed.data(), packed.size());
+    GdsMessage message;
+    message.unpack(handle.get(), columns);
+  }));
+  gds_bench::print("reader, columns", gds_bench::measure(runs, [&]() {
+    GdsMessage message;
+    message.unpack(packed.data(), packed.size(), columns);
+  }));
+  return 0;
+}
@@ -0,0 +1,77 @@
+// Generating message ids on the given number of threads at once, 100000 ids per thread in a run: the text form, the
+// binary form, and for comparison binary ids drawn from one generator shared under a lock. The time is the wall time of
+// a run, every thread is started in it. Usage: bench_uuid [threads] [runs], 0 threads is the number of cores
+#include "bench_common.hpp"
+#include "gds_uuid.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+  constexpr int ids_per_thread = 100000;
+
+  // the ids are folded into a checksum, so the generation is not left out
+  std::atomic<uint64_t> checksum{0};
+
+  template <typename Generate>
+  void on_threads(unsigned threads, Generate&& generate)
+  {
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (unsigned thread = 0; thread < threads; ++thread)
+    {
+      workers.emplace_back([&]() {
+        uint64_t sum = 0;
+        for (int index = 0; index < ids_per_thread; ++index)
+        {
+          sum += generate();
+        }
+        checksum += sum;
+      });
+    }
+    for (std::thread& worker : workers)
+    {
+      worker.join();
+    }
+  }
+
+  void print(const char* name, unsigned threads, const gds_bench::Measurement& result)
+  {
+    gds_bench::print(name, result);
+    std::printf("%-40s %12.1f ns per id\n", name, result.milliseconds * 1e6 / (double(threads) * ids_per_thread));
+  }
+}
+
+int main(int argc, char** argv)
+{
+  unsigned threads = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 1;
+  if (threads == 0)
+  {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  const int runs = argc > 2 ? std::max(1, std::atoi(argv[2])) : 10;
+  std::printf("%u threads, %d ids per thread, %d runs\n", threads, ids_per_thread, runs);
+
+  print("text ids", threads, gds_bench::measure(runs, [&]() {
+    on_threads(threads, []() { return uint64_t(uuid::generate_uuid_v4()[0]); });
+  }));
+  print("binary ids", threads, gds_bench::measure(runs, [&]() {
+    on_threads(threads, []() { return uint64_t(uuid::generate_binary_uuid_v4().bytes[0]); });
+  }));
+
+  // the generator of the first thread shared by all of them
+  std::mutex mutex;
+  uuid::detail::random_generator& shared = uuid::detail::thread_generator();
+  print("binary ids, one locked generator", threads, gds_bench::measure(runs, [&]() {
+    on_threads(threads, [&]() {
+      std::lock_guard<std::mutex> lock(mutex);
+      return shared.next() ^ shared.next();
+    });
+  }));
+  std::printf("checksum %llu\n", static_cast<unsigned long long>(checksum.load()));
+  return 0;
+}
@@ -63,6 +63,13 @@ void GDSConsoleClient::run()
     if(args.has_arg("password")){
         builder.with_password(args.get_arg("password"));
     }
+
+    if(args.has_arg("queryall")){
+        // the pages of the query share the field descriptors of the first one
+        gds_lib::gds_types::DecodeOptions options;
+        options.schemas = std::make_shared<gds_lib::gds_types::SchemaCache>();
+        builder.with_decode_options(options);
+    }
     mGDSInterface = builder.build();
     setupConnection();
 
@@ -121,7 +128,8 @@ void GDSConsoleClient::send_next_query()
 
     std::shared_ptr<GdsNextQueryRequestMessage> selectBody(new GdsNextQueryRequestMessage());
     {
-        selectBody->contextDescriptor = contextDescriptor;
+        // the descriptor of the last page is not needed anymore, the reply to this request brings the next one
+        selectBody->contextDescriptor = std::move(contextDescriptor);
         selectBody->timeout = 0;
     }
     fullMessage.messageBody = selectBody;
@@ -7,10 +7,16 @@
 
 #include "countdownlatch.hpp"
 
+#include <algorithm>
 #include <iostream>
 #include <chrono>
+#include <cstring>
+#include <deque>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <thread>
+#include <utility>
 
 #include <simple-websocket-server/client_ws.hpp>
 #include <simple-websocket-server/client_wss.hpp>
@@ -18,6 +24,54 @@
 namespace gds_lib {
 namespace client {
 
+    /**
+ * Packs into the asio::streambuf of an outgoing WebSocket message. The space is prepared in chunks
+ * and filled with memcpy, instead of going through the stream interface for every msgpack token.
+ */
+    template <typename Streambuf>
+    class StreambufPackBuffer : public gds_lib::gds_types::PackBuffer {
+        Streambuf& m_buffer;
+        char* m_data = nullptr;
+        std::size_t m_size = 0;
+        std::size_t m_capacity = 0;
+
+    public:
+        explicit StreambufPackBuffer(Streambuf& buffer)
+            : m_buffer(buffer)
+        {
+        }
+        ~StreambufPackBuffer() { flush(); }
+
+        void write(const char* data, std::size_t size) override
+        {
+            if (size > m_capacity - m_size) {
+                flush();
+                m_capacity = std::max<std::size_t>(size, m_buffer.size() + 4096);
+                m_data = static_cast<char*>(m_buffer.prepare(m_capacity).data());
+            }
+            std::memcpy(m_data + m_size, data, size);
+            m_size += size;
+        }
+
+        // makes room for the next size bytes in a single allocation
+        void reserve(std::size_t size)
+        {
+            if (size > m_capacity - m_size) {
+                flush();
+                m_capacity = size;
+                m_data = static_cast<char*>(m_buffer.prepare(m_capacity).data());
+            }
+        }
+
+        void flush()
+        {
+            m_buffer.commit(m_size);
+            m_capacity -= m_size;
+            m_data += m_size;
+            m_size = 0;
+        }
+    };
+
     template <typename ws_client_type>
     class BaseGDSClient : public gds_lib::connection::GDSInterface {
     protected:
@@ -39,9 +93,13 @@ namespace client {
 
     public:
         //NO / PASSWORD AUTH
-        BaseGDSClient(const std::string& url, std::shared_ptr<gds_lib::connection::GDSMessageListener> callbacks, const std::string& username, const std::string& password, const uint64_t timeout);
+        BaseGDSClient(const std::string& url, std::shared_ptr<gds_lib::connection::GDSMessageListener> callbacks, const std::string& username, const std::string& password, const uint64_t timeout,
+            const gds_lib::gds_types::DecodeOptions& decode_options = {}, std::size_t pool_size = 16, const gds_lib::gds_types::FragmentOptions& fragments = {},
+            const gds_lib::connection::DeflateOptions& deflate = {});
         //TLS AUTH
-        BaseGDSClient(const std::string& url, std::shared_ptr<gds_lib::connection::GDSMessageListener> callbacks, const std::string& username, const uint64_t timeout, const std::string& cert, const std::string& cert_pw);
+        BaseGDSClient(const std::string& url, std::shared_ptr<gds_lib::connection::GDSMessageListener> callbacks, const std::string& username, const uint64_t timeout, const std::string& cert, const std::string& cert_pw,
+            const gds_lib::gds_types::DecodeOptions& decode_options = {}, std::size_t pool_size = 16, const gds_lib::gds_types::FragmentOptions& fragments = {},
+            const gds_lib::connection::DeflateOptions& deflate = {});
 
         BaseGDSClient(const BaseGDSClient<ws_client_type>&) = delete;
         BaseGDSClient(const BaseGDSClient<ws_client_type>&&) = delete;
@@ -53,12 +111,24 @@ namespace client {
 
         void send(const gds_lib::gds_types::GdsMessage& msg) override;
         gds_lib::connection::State get_state() override;
+        gds_lib::gds_types::PoolStats message_pool_stats() const override { return m_message_pool.stats(); }
+        gds_lib::gds_types::PoolStats send_buffer_pool_stats() const override { return m_send_pool.stats(); }
+        gds_lib::gds_types::FragmentStats fragment_stats() const override
+        {
+            std::lock_guard<std::mutex> lock(m_assembler_mutex);
+            return m_assembler.stats();
+        }
         void start() override;
         void close() override;
 
     private:
         void login();
         void init();
+        void send_message(const gds_lib::gds_types::GdsMessage& msg);
+        // an empty WebSocket message from the pool
+        std::shared_ptr<typename ws_client_type::OutMessage> acquire_out_message();
+        // sends a packed message, compressed if permessage-deflate was agreed on
+        void send_out_message(const std::shared_ptr<typename ws_client_type::OutMessage>& stream);
         bool m_closed;
         bool m_started;
         bool m_logged_in;
@@ -66,6 +136,30 @@ namespace client {
         std::string m_username;
         std::string m_password;
         uint64_t m_timeout;
+        gds_lib::gds_types::DecodeOptions m_decode_options;
+        // the header of the messages sent by this user is packed once
+        gds_lib::gds_types::GdsHeaderTemplate m_header_template;
+        // the received messages are recycled once the listener dropped them, their bodies are decoded in place
+        gds_lib::gds_types::SharedPool<gds_lib::gds_types::GdsMessage> m_message_pool;
+        gds_lib::gds_types::SharedPool<typename ws_client_type::OutMessage> m_send_pool;
+        gds_lib::gds_types::FragmentOptions m_fragment_options;
+        // the fragments are added on the thread of the connection, the lock is only for the stats
+        mutable std::mutex m_assembler_mutex;
+        gds_lib::gds_types::FragmentAssembler m_assembler;
+        // the fragment unit agreed on at the login, 0 if the messages are not fragmented
+        std::atomic<std::size_t> m_fragment_unit;
+        gds_lib::connection::DeflateOptions m_deflate_options;
+        // set at the handshake if the GDS accepted permessage-deflate. The messages are compressed and queued under the lock,
+        // so they are sent in the order of the compression (the context of the GDS follows that order).
+        // One thread at a time hands the queue to the connection, outside the lock
+        std::mutex m_deflate_mutex;
+        std::unique_ptr<gds_lib::connection::MessageDeflater> m_deflater;
+        std::string m_deflated;
+        std::deque<std::pair<std::shared_ptr<typename ws_client_type::OutMessage>, unsigned char>> m_deflate_queue;
+        bool m_deflate_sending = false;
+        // the received messages are inflated on the thread of the connection, into recycled buffers
+        std::unique_ptr<gds_lib::connection::MessageInflater> m_inflater;
+        gds_lib::gds_types::SharedPool<std::string> m_inflate_pool;
 
         std::atomic<gds_lib::connection::State> m_state;
     };
@@ -77,16 +171,23 @@ namespace client {
 
     template <typename ws_client_type>
     BaseGDSClient<ws_client_type>::BaseGDSClient(const std::string& url,
-     std::shared_ptr<gds_lib::connection::GDSMessageListener> callbacks, const std::string& username, const std::string& password, const uint64_t timeout)
-    : mWebSocket(std::make_shared<ws_client_type>(url)), mCallbacks(callbacks), mCountdownlatch(1), m_username(username), m_password(password), m_timeout(timeout)
+     std::shared_ptr<gds_lib::connection::GDSMessageListener> callbacks, const std::string& username, const std::string& password, const uint64_t timeout,
+     const gds_lib::gds_types::DecodeOptions& decode_options, std::size_t pool_size, const gds_lib::gds_types::FragmentOptions& fragments,
+     const gds_lib::connection::DeflateOptions& deflate)
+    : mWebSocket(std::make_shared<ws_client_type>(url)), mCallbacks(callbacks), mCountdownlatch(1), m_username(username), m_password(password), m_timeout(timeout), m_decode_options(decode_options), m_header_template(username),
+      m_message_pool(pool_size), m_send_pool(pool_size), m_fragment_options(fragments), m_assembler(fragments), m_fragment_unit(0),
+      m_deflate_options(deflate), m_inflate_pool(pool_size)
     {
         init();
     }
 
     template <typename ws_client_type>
     BaseGDSClient<ws_client_type>::BaseGDSClient(const std::string& url,  std::shared_ptr<gds_lib::connection::GDSMessageListener> callbacks, const std::string& username, 
-        const uint64_t timeout, const std::string& cert_path, const std::string& cert_pw)
-    :mCallbacks(callbacks), mCountdownlatch(1), m_username(username), m_timeout(timeout)
+        const uint64_t timeout, const std::string& cert_path, const std::string& cert_pw, const gds_lib::gds_types::DecodeOptions& decode_options, std::size_t pool_size,
+        const gds_lib::gds_types::FragmentOptions& fragments, const gds_lib::connection::DeflateOptions& deflate)
+    :mCallbacks(callbacks), mCountdownlatch(1), m_username(username), m_timeout(timeout), m_decode_options(decode_options), m_header_template(username),
+      m_message_pool(pool_size), m_send_pool(pool_size), m_fragment_options(fragments), m_assembler(fragments), m_fragment_unit(0),
+      m_deflate_options(deflate), m_inflate_pool(pool_size)
     {
         tls_files = parse_cert(cert_path, cert_pw);
         mWebSocket = std::make_shared<ws_client_type>(url, false, tls_files.first, tls_files.second);
@@ -118,6 +219,10 @@ namespace client {
         mWebSocket->on_close = std::bind(&BaseGDSClient<ws_client_type>::m_on_close, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3);
         mWebSocket->on_error = std::bind(&BaseGDSClient<ws_client_type>::m_on_error, this, std::placeholders::_1, std::placeholders::_2);
 
+        if (m_deflate_options.enabled) {
+            mWebSocket->config.header.emplace("Sec-WebSocket-Extensions", gds_lib::connection::DeflateParameters::offer(m_deflate_options));
+        }
+
         m_closed = false;
         m_started = false;
 
@@ -173,14 +278,76 @@ namespace client {
     void BaseGDSClient<ws_client_type>::m_on_message(connection_sptr /*connection*/,
         std::shared_ptr<typename ws_client_type::InMessage> in_msg)
     {
-        std::string message = in_msg->string();
-        msgpack::object_handle oh = msgpack::unpack(message.data(), message.size());
-        msgpack::object replyMsg = oh.get();
-
         //gds_lib::gds_types::GdsMessage msg;
-        gds_lib::gds_types::gds_message_t msg = std::make_shared<gds_types::GdsMessage>();
         try {
-            msg->unpack(replyMsg);
+            // the streambuf of the message is contiguous, so it is unpacked in place instead of copying it to a string first.
+            // the buffer keeps the WebSocket message alive, strings and binaries are referenced from there.
+            const char* bytes;
+            std::size_t size;
+            {
+                using namespace SimpleWeb;
+                auto data = static_cast<asio::streambuf*>(in_msg->rdbuf())->data();
+                bytes = static_cast<const char*>(data.data());
+                size = data.size();
+            }
+
+            // the WebSocket message, or the buffer it was inflated into, or the message reassembled from the fragments keeps the bytes alive
+            std::shared_ptr<const void> owner = in_msg;
+
+            // compressed by the GDS if the first byte of the frame has the RSV1 bit set
+            if (in_msg->fin_rsv_opcode & 0x40) {
+                if (!m_inflater) {
+                    throw gds_lib::gds_types::invalid_message_error(gds_lib::gds_types::GdsMsgType::HEADER_MESSAGE, "the message is compressed, but permessage-deflate was not agreed on");
+                }
+                std::shared_ptr<std::string> inflated = m_inflate_pool.acquire();
+                m_inflater->decompress(bytes, size, *inflated);
+                bytes = inflated->data();
+                size = inflated->size();
+                owner = inflated;
+            }
+
+            // only the header is decoded here, so the messages consumed by the listener do not pay for their body.
+            gds_lib::gds_types::GdsMessageHeader header = gds_lib::gds_types::GdsMessageHeader::peek(bytes, size, m_decode_options.validation);
+            if (header.isFragmented) {
+                std::shared_ptr<const std::string> whole;
+                {
+                    std::lock_guard<std::mutex> lock(m_assembler_mutex);
+                    whole = m_assembler.add(header);
+                }
+                if (!whole) {
+                    return;
+                }
+                bytes = whole->data();
+                size = whole->size();
+                owner = whole;
+                header = gds_lib::gds_types::GdsMessageHeader::peek(bytes, size, m_decode_options.validation);
+            }
+            if (header.dataType != gds_types::GdsMsgType::LOGIN_REPLY && mCallbacks->on_message_header(header)) {
+                return;
+            }
+
+            gds_lib::gds_types::message_buffer_t buffer = gds_lib::gds_types::MessageBuffer::unpack(owner, bytes, size);
+
+            const msgpack::object& replyMsg = buffer->root();
+            if (header.dataType != gds_types::GdsMsgType::LOGIN_REPLY) {
+                gds_lib::gds_types::GdsMessageView view(buffer);
+                if (mCallbacks->on_message_view(view)) {
+                    return;
+                }
+                if (view.dataType() == gds_types::GdsMsgType::QUERY_REPLY) {
+                    gds_lib::gds_types::QueryReplyView reply = view.body<gds_lib::gds_types::QueryReplyView>();
+                    if (reply.has_data()) {
+                        gds_lib::gds_types::QueryRowCursor cursor(reply);
+                        if (mCallbacks->on_query_rows(view, cursor)) {
+                            return;
+                        }
+                    }
+                }
+            }
+
+            // a recycled message, the previous body is overwritten if the listener does not hold it anymore
+            gds_lib::gds_types::gds_message_t msg = m_message_pool.acquire();
+            msg->unpack(replyMsg, m_decode_options);
             switch (msg->dataType) {
                 case gds_types::GdsMsgType::LOGIN_REPLY: // Type 1
                 {
@@ -195,6 +362,16 @@ namespace client {
                     std::shared_ptr<gds_lib::gds_types::GdsLoginReplyMessage> body =
                     std::dynamic_pointer_cast<gds_types::GdsLoginReplyMessage>(msg->messageBody);
                     if(body->ackStatus == 200 ){
+                        // the unit of the GDS is used if it is smaller, no fragments are sent if it declined the fragmentation
+                        std::size_t unit = 0;
+                        if (m_fragment_options.unit != 0 && body->loginReply && body->loginReply->fragmentation_supported) {
+                            unit = m_fragment_options.unit;
+                            int32_t accepted = body->loginReply->fragment_transmission_unit.value_or(0);
+                            if (accepted > 0) {
+                                unit = std::min<std::size_t>(unit, static_cast<std::size_t>(accepted));
+                            }
+                        }
+                        m_fragment_unit.store(unit);
                         m_state.store(gds_lib::connection::State::LOGGED_IN);
                         mCallbacks->on_connection_success(msg, body);
                     }
@@ -261,6 +438,12 @@ namespace client {
         catch (gds_lib::gds_types::invalid_message_error& e) {
             std::cerr << "Invalid format on the incoming message!" << std::endl;
             std::cerr << e.what() << std::endl;
+            // with context takeover the later messages of the GDS cannot be inflated either
+            if (m_inflater && m_inflater->failed()) {
+                m_state.store(gds_lib::connection::State::FAILED);
+                close();
+                mCallbacks->on_connection_failure(gds_lib::connection::connection_error(e.what()), {});
+            }
         }
         catch (msgpack::type_error& e) {
             std::cerr << "MessagePack type error on the incoming message.." << std::endl;
@@ -277,6 +460,31 @@ namespace client {
         }
         mConnection = connection;
 
+        if (m_deflate_options.enabled) {
+            auto header = connection->header.find("Sec-WebSocket-Extensions");
+            std::optional<gds_lib::connection::DeflateParameters> parameters;
+            try {
+                if (header != connection->header.end()) {
+                    parameters = gds_lib::connection::DeflateParameters::accept(header->second, m_deflate_options);
+                }
+            }
+            catch (std::invalid_argument& e) {
+                mCountdownlatch.countdown();
+                m_state.store(gds_lib::connection::State::FAILED);
+                close();
+                mCallbacks->on_connection_failure(gds_lib::connection::connection_error(e.what()), {});
+                return;
+            }
+            if (parameters) {
+                m_inflater = std::make_unique<gds_lib::connection::MessageInflater>(parameters->server_no_context_takeover, m_deflate_options.max_message_size);
+                // zlib cannot compress with the smallest window, the messages are sent uncompressed if the GDS asks for that
+                if (parameters->client_max_window_bits > 8) {
+                    m_deflater = std::make_unique<gds_lib::connection::MessageDeflater>(m_deflate_options.level, parameters->client_max_window_bits,
+                        parameters->client_no_context_takeover);
+                }
+            }
+        }
+
         old_state = gds_lib::connection::State::CONNECTED;
         if(!m_state.compare_exchange_strong(old_state, gds_lib::connection::State::LOGGING_IN)) {
             throw gds_lib::connection::state_error(gds_lib::connection::State::CONNECTED, old_state, "on_open(2)");
@@ -327,22 +535,18 @@ namespace client {
         {
             loginBody->serve_on_the_same_connection = false;
             loginBody->protocol_version_number = (5 << 16 | 1);
-            loginBody->fragmentation_supported = false;
+            loginBody->fragmentation_supported = m_fragment_options.unit != 0;
+            if (loginBody->fragmentation_supported) {
+                loginBody->fragment_transmission_unit = static_cast<int32_t>(
+                    std::min<std::size_t>(m_fragment_options.unit, std::numeric_limits<int32_t>::max()));
+            }
             if(m_password.length()) {
                 loginBody->reserved_fields = std::vector<std::string>{};
                 loginBody->reserved_fields.value().emplace_back(m_password);
             }
         }
         fullMessage.messageBody = loginBody;
-        {
-            msgpack::sbuffer buffer;
-            msgpack::packer<msgpack::sbuffer> pk(&buffer);
-            fullMessage.pack(pk);
-            std::shared_ptr<typename ws_client_type::OutMessage> stream = std::make_shared<typename ws_client_type::OutMessage>();
-            stream->write(buffer.data(), buffer.size());
-            mConnection->send(stream, nullptr, 130);
-
-        }
+        send_message(fullMessage);
     }
 
     template <typename ws_client_type>
@@ -351,14 +555,113 @@ namespace client {
         if(get_state() != gds_lib::connection::State::LOGGED_IN) {
             throw std::runtime_error("Cannot send message without a successful login!");
         }
-        msgpack::sbuffer buffer;
-        msgpack::packer<msgpack::sbuffer> pk(&buffer);
+        send_message(msg);
+    }
+
+    template <typename ws_client_type>
+    std::shared_ptr<typename ws_client_type::OutMessage> BaseGDSClient<ws_client_type>::acquire_out_message()
+    {
+        using namespace SimpleWeb;
+        std::shared_ptr<typename ws_client_type::OutMessage> stream = m_send_pool.acquire();
+        asio::streambuf& streambuf = *static_cast<asio::streambuf*>(stream->rdbuf());
+        // the leftover of a send that failed
+        streambuf.consume(streambuf.size());
+        stream->clear();
+        return stream;
+    }
+
+    template <typename ws_client_type>
+    void BaseGDSClient<ws_client_type>::send_message(const gds_lib::gds_types::GdsMessage& msg)
+    {
+        using namespace SimpleWeb;
+        // packed straight into the buffer of the WebSocket message, the library builds the (masked) frame from that.
+        // the frame is a copy made before send() returns, so the buffer goes back to the pool right after
+        std::shared_ptr<typename ws_client_type::OutMessage> stream = acquire_out_message();
+        asio::streambuf& streambuf = *static_cast<asio::streambuf*>(stream->rdbuf());
+        {
+            // the messages are checked at the level the received ones are
+            gds_lib::gds_types::EncodeOptions options;
+            options.validation = m_decode_options.validation;
+            options.parallel = m_decode_options.parallel;
+            StreambufPackBuffer<asio::streambuf> buffer(streambuf);
+            // the size is computed from the structure of the message without packing it, so the buffer is allocated once
+            // and the attachments are not copied while it grows
+            buffer.reserve(m_header_template.encoded_size(msg));
+            m_header_template.pack(buffer, msg, options);
+        }
 
-        msg.pack(pk);
+        // a message longer than the agreed unit is sent in fragments, each of them is a WebSocket message of its own,
+        // so the messages sent by other threads in the meantime get between them instead of waiting for the whole
+        const std::size_t unit = m_fragment_unit.load();
+        if (unit != 0 && !msg.isFragmented && streambuf.size() > unit) {
+            auto packed = streambuf.data();
+            gds_lib::gds_types::MessageFragmenter fragmenter(static_cast<const char*>(packed.data()), packed.size(), unit);
+            if (fragmenter.count() > 1) {
+                for (std::size_t ii = 0; ii < fragmenter.count(); ++ii) {
+                    std::shared_ptr<typename ws_client_type::OutMessage> fragment = acquire_out_message();
+                    {
+                        StreambufPackBuffer<asio::streambuf> buffer(*static_cast<asio::streambuf*>(fragment->rdbuf()));
+                        fragmenter.pack(buffer, ii);
+                    }
+                    send_out_message(fragment);
+                }
+                return;
+            }
+        }
+        send_out_message(stream);
+    }
 
-        std::shared_ptr<typename ws_client_type::OutMessage> stream = std::make_shared<typename ws_client_type::OutMessage>();
-        stream->write(buffer.data(), buffer.size());
-        mConnection->send(stream, nullptr, 130);
+    template <typename ws_client_type>
+    void BaseGDSClient<ws_client_type>::send_out_message(const std::shared_ptr<typename ws_client_type::OutMessage>& stream)
+    {
+        using namespace SimpleWeb;
+        asio::streambuf& streambuf = *static_cast<asio::streambuf*>(stream->rdbuf());
+        if (!m_deflater) {
+            mConnection->send(stream, nullptr, 130);
+            return;
+        }
+        // the short messages are queued uncompressed, so the fragments of a message keep their order
+        const bool compress = streambuf.size() >= m_deflate_options.min_size;
+        std::shared_ptr<typename ws_client_type::OutMessage> compressed = compress ? acquire_out_message() : nullptr;
+        {
+            std::lock_guard<std::mutex> lock(m_deflate_mutex);
+            if (compress) {
+                auto packed = streambuf.data();
+                m_deflater->compress(static_cast<const char*>(packed.data()), packed.size(), m_deflated);
+                StreambufPackBuffer<asio::streambuf> buffer(*static_cast<asio::streambuf*>(compressed->rdbuf()));
+                buffer.write(m_deflated.data(), m_deflated.size());
+                // FIN, RSV1 (compressed), binary
+                m_deflate_queue.emplace_back(compressed, 130 | 0x40);
+            }
+            else {
+                m_deflate_queue.emplace_back(stream, 130);
+            }
+            // the thread sending the queue sends this one too
+            if (m_deflate_sending) {
+                return;
+            }
+            m_deflate_sending = true;
+        }
+        while (true) {
+            std::pair<std::shared_ptr<typename ws_client_type::OutMessage>, unsigned char> next;
+            {
+                std::lock_guard<std::mutex> lock(m_deflate_mutex);
+                if (m_deflate_queue.empty()) {
+                    m_deflate_sending = false;
+                    return;
+                }
+                next = std::move(m_deflate_queue.front());
+                m_deflate_queue.pop_front();
+            }
+            try {
+                mConnection->send(next.first, nullptr, next.second);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(m_deflate_mutex);
+                m_deflate_sending = false;
+                throw;
+            }
+        }
     }
 
     template <typename ws_client_type>
@@ -0,0 +1,299 @@
+#include "gds_deflate.hpp"
+#include "gds_types.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <zlib.h>
+
+namespace gds_lib {
+namespace connection {
+
+  namespace {
+    constexpr char extension_name[] = "permessage-deflate";
+    // every compressed message ends with an empty stored block, that is not sent (RFC 7692 7.2.1)
+    constexpr unsigned char block_tail[] = {0x00, 0x00, 0xff, 0xff};
+    // the most zlib takes or writes in a call, it counts in uInt
+    constexpr std::size_t max_chunk = std::numeric_limits<uInt>::max();
+
+    std::string_view trim(std::string_view item)
+    {
+      const std::size_t begin = item.find_first_not_of(" \t");
+      if (begin == std::string_view::npos)
+      {
+        return {};
+      }
+      const std::size_t end = item.find_last_not_of(" \t");
+      return item.substr(begin, end - begin + 1);
+    }
+
+    // the items of a list separated by the delimiter, trimmed
+    std::vector<std::string_view> split(std::string_view list, char delimiter)
+    {
+      std::vector<std::string_view> items;
+      std::size_t begin = 0;
+      while (begin <= list.size())
+      {
+        std::size_t end = list.find(delimiter, begin);
+        if (end == std::string_view::npos)
+        {
+          end = list.size();
+        }
+        items.push_back(trim(list.substr(begin, end - begin)));
+        begin = end + 1;
+      }
+      return items;
+    }
+
+    int window_bits_of(std::string_view value, int minimum)
+    {
+      if (value.size() >= 2 && value.front() == '"' && value.back() == '"')
+      {
+        value = value.substr(1, value.size() - 2);
+      }
+      if (value.empty() || value.size() > 2 || !std::all_of(value.begin(), value.end(), [](char ch) { return ch >= '0' && ch <= '9'; }))
+      {
+        throw std::invalid_argument("permessage-deflate: invalid window bits");
+      }
+      const int bits = std::stoi(std::string(value));
+      if (bits < minimum || bits > 15)
+      {
+        throw std::invalid_argument("permessage-deflate: invalid window bits");
+      }
+      return bits;
+    }
+  }
+
+  std::string DeflateParameters::offer(const DeflateOptions& options)
+  {
+    std::string header = extension_name;
+    if (options.client_no_context_takeover)
+    {
+      header += "; client_no_context_takeover";
+    }
+    if (options.server_no_context_takeover)
+    {
+      header += "; server_no_context_takeover";
+    }
+    if (options.server_max_window_bits < 15)
+    {
+      header += "; server_max_window_bits=" + std::to_string(options.server_max_window_bits);
+    }
+    // the server may ask for a smaller window of the client only if the parameter is offered
+    header += "; client_max_window_bits";
+    if (options.client_max_window_bits < 15)
+    {
+      header += "=" + std::to_string(options.client_max_window_bits);
+    }
+    return header;
+  }
+
+  std::optional<DeflateParameters> DeflateParameters::accept(std::string_view header, const DeflateOptions& options)
+  {
+    for (std::string_view extension : split(header, ','))
+    {
+      std::vector<std::string_view> items = split(extension, ';');
+      if (items.front() != extension_name)
+      {
+        continue;
+      }
+      DeflateParameters parameters;
+      parameters.client_max_window_bits = options.client_max_window_bits;
+      parameters.client_no_context_takeover = options.client_no_context_takeover;
+      bool client_bits = false;
+      bool server_bits = false;
+      for (std::size_t ii = 1; ii < items.size(); ++ii)
+      {
+        const std::size_t equals = items[ii].find('=');
+        const std::string_view name = trim(items[ii].substr(0, equals));
+        const std::string_view value = equals == std::string_view::npos ? std::string_view() : trim(items[ii].substr(equals + 1));
+        if (name == "server_no_context_takeover" && value.empty() && !parameters.server_no_context_takeover)
+        {
+          parameters.server_no_context_takeover = true;
+        }
+        else if (name == "client_no_context_takeover" && value.empty())
+        {
+          parameters.client_no_context_takeover = true;
+        }
+        else if (name == "server_max_window_bits" && !server_bits)
+        {
+          parameters.server_max_window_bits = window_bits_of(value, 8);
+          server_bits = true;
+        }
+        else if (name == "client_max_window_bits" && !client_bits)
+        {
+          parameters.client_max_window_bits = std::min(options.client_max_window_bits, window_bits_of(value, 8));
+          client_bits = true;
+        }
+        else
+        {
+          throw std::invalid_argument("permessage-deflate: unexpected parameter " + std::string(items[ii]));
+        }
+      }
+      // the server may not compress with a larger window than it was asked to
+      if (parameters.server_max_window_bits > options.server_max_window_bits)
+      {
+        throw std::invalid_argument("permessage-deflate: the server window is larger than the offered one");
+      }
+      if (options.server_no_context_takeover && !parameters.server_no_context_takeover)
+      {
+        throw std::invalid_argument("permessage-deflate: the server did not accept server_no_context_takeover");
+      }
+      return parameters;
+    }
+    return std::nullopt;
+  }
+
+  struct MessageDeflater::Stream
+  {
+    z_stream zs{};
+  };
+
+  MessageDeflater::MessageDeflater(int level, int window_bits, bool no_context_takeover)
+    : m_stream(new Stream()), m_no_context_takeover(no_context_takeover)
+  {
+    // raw deflate (negative window bits), zlib does not support a window of 8 bits for compression
+    if (window_bits < 9 || window_bits > 15 ||
+        deflateInit2(&m_stream->zs, level, Z_DEFLATED, -window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+      throw std::invalid_argument("MessageDeflater: invalid compression parameters");
+    }
+  }
+
+  MessageDeflater::~MessageDeflater()
+  {
+    deflateEnd(&m_stream->zs);
+  }
+
+  void MessageDeflater::compress(const char* data, std::size_t size, std::string& out)
+  {
+    z_stream& zs = m_stream->zs;
+    // the bound of the first chunk, with room for the flush markers. The output grows if more is needed
+    out.resize(deflateBound(&zs, static_cast<uLong>(std::min<std::size_t>(size, max_chunk))) + 16);
+    // zlib counts in uInt, a longer message is fed in chunks, it is flushed after the last one
+    std::size_t consumed = 0;
+    std::size_t produced = 0;
+    zs.avail_in = 0;
+    do
+    {
+      if (zs.avail_in == 0 && consumed < size)
+      {
+        zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data + consumed));
+        zs.avail_in = static_cast<uInt>(std::min<std::size_t>(size - consumed, max_chunk));
+        consumed += zs.avail_in;
+      }
+      if (produced == out.size())
+      {
+        out.resize(out.size() * 2);
+      }
+      const uInt room = static_cast<uInt>(std::min<std::size_t>(out.size() - produced, max_chunk));
+      zs.next_out = reinterpret_cast<Bytef*>(&out[produced]);
+      zs.avail_out = room;
+      deflate(&zs, consumed == size ? Z_SYNC_FLUSH : Z_NO_FLUSH);
+      produced += room - zs.avail_out;
+    } while (zs.avail_in > 0 || consumed < size || zs.avail_out == 0);
+
+    if (produced >= sizeof(block_tail) && std::equal(block_tail, block_tail + sizeof(block_tail),
+                                                     reinterpret_cast<const unsigned char*>(out.data()) + produced - sizeof(block_tail)))
+    {
+      produced -= sizeof(block_tail);
+    }
+    out.resize(produced);
+    if (m_no_context_takeover)
+    {
+      deflateReset(&zs);
+    }
+  }
+
+  struct MessageInflater::Stream
+  {
+    z_stream zs{};
+  };
+
+  MessageInflater::MessageInflater(bool no_context_takeover, std::size_t max_size)
+    : m_stream(new Stream()), m_no_context_takeover(no_context_takeover), m_max_size(max_size)
+  {
+    // the largest window decodes the messages of any smaller one
+    if (inflateInit2(&m_stream->zs, -15) != Z_OK)
+    {
+      throw std::bad_alloc();
+    }
+  }
+
+  MessageInflater::~MessageInflater()
+  {
+    inflateEnd(&m_stream->zs);
+  }
+
+  void MessageInflater::decompress(const char* data, std::size_t size, std::string& out)
+  {
+    if (m_failed)
+    {
+      throw gds_types::invalid_message_error(gds_types::GdsMsgType::HEADER_MESSAGE, "the compression context of the connection is lost");
+    }
+    z_stream& zs = m_stream->zs;
+    // the whole capacity of a reused buffer is written into, it grows geometrically up to the maximum
+    out.resize(std::max<std::size_t>(out.capacity(), std::min<std::size_t>(m_max_size, 16 * 1024)));
+    std::size_t produced = 0;
+    // with context takeover the next message refers to this one, so after an error no message of the connection can be inflated
+    auto fail = [&](const char* info) {
+      if (m_no_context_takeover)
+      {
+        inflateReset(&zs);
+      }
+      else
+      {
+        m_failed = true;
+      }
+      throw gds_types::invalid_message_error(gds_types::GdsMsgType::HEADER_MESSAGE, info);
+    };
+    auto inflate_input = [&](const unsigned char* input, std::size_t input_size) {
+      // zlib counts in uInt, a longer payload is fed in chunks
+      std::size_t consumed = 0;
+      zs.avail_in = 0;
+      do
+      {
+        if (zs.avail_in == 0 && consumed < input_size)
+        {
+          zs.next_in = const_cast<Bytef*>(input + consumed);
+          zs.avail_in = static_cast<uInt>(std::min<std::size_t>(input_size - consumed, max_chunk));
+          consumed += zs.avail_in;
+        }
+        if (produced == out.size())
+        {
+          if (out.size() >= m_max_size)
+          {
+            fail("the inflated message is too large");
+          }
+          out.resize(std::min(m_max_size, out.size() * 2));
+        }
+        const uInt room = static_cast<uInt>(std::min<std::size_t>(out.size() - produced, max_chunk));
+        zs.next_out = reinterpret_cast<Bytef*>(&out[produced]);
+        zs.avail_out = room;
+        const int result = inflate(&zs, Z_SYNC_FLUSH);
+        produced += room - zs.avail_out;
+        if (result == Z_STREAM_END)
+        {
+          // a final block, the rest of the payload starts a new stream
+          inflateReset(&zs);
+        }
+        else if (result != Z_OK && result != Z_BUF_ERROR)
+        {
+          fail("the compressed message is invalid");
+        }
+        // a full output may have more data buffered in zlib
+      } while (zs.avail_in > 0 || consumed < input_size || zs.avail_out == 0);
+    };
+    inflate_input(reinterpret_cast<const unsigned char*>(data), size);
+    inflate_input(block_tail, sizeof(block_tail));
+    out.resize(produced);
+    if (m_no_context_takeover)
+    {
+      inflateReset(&zs);
+    }
+  }
+
+} // namespace connection
+} // namespace gds_lib
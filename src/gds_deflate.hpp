@@ -0,0 +1,96 @@
+#ifndef GDS_DEFLATE_HPP
+#define GDS_DEFLATE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace gds_lib {
+namespace connection {
+
+    /**
+ * Settings of the permessage-deflate WebSocket extension (RFC 7692).
+ * The client offers the extension at the handshake if it is enabled, the messages are compressed only if the GDS accepts it.
+ */
+    struct DeflateOptions {
+        bool enabled = false;
+        int level = -1; // the zlib compression level (0-9), -1 is the zlib default
+        std::size_t min_size = 256; // the messages shorter than this are sent uncompressed
+        int client_max_window_bits = 15; // the window the sent messages are compressed with (9-15)
+        int server_max_window_bits = 15; // the window the GDS is asked to compress with (8-15)
+        // the sent messages are compressed one by one, without referring to the previous ones.
+        // It needs less memory on both sides, but repeated content (the descriptors, the same values) compresses worse
+        bool client_no_context_takeover = false;
+        // the GDS is asked to compress its messages one by one
+        bool server_no_context_takeover = false;
+        std::size_t max_message_size = 64 * 1024 * 1024; // the largest message inflated, a longer one is rejected
+    };
+
+    /**
+ * The parameters of the extension agreed on at the handshake
+ */
+    struct DeflateParameters {
+        int client_max_window_bits = 15;
+        int server_max_window_bits = 15;
+        bool client_no_context_takeover = false;
+        bool server_no_context_takeover = false;
+
+        // the value of the Sec-WebSocket-Extensions request header that offers the extension
+        static std::string offer(const DeflateOptions& options);
+        // the parameters accepted by the server in its Sec-WebSocket-Extensions response header, nullopt if it declined the extension.
+        // Throws std::invalid_argument if the response is not a valid answer to the offer
+        static std::optional<DeflateParameters> accept(std::string_view header, const DeflateOptions& options);
+    };
+
+    /**
+ * Compresses the messages of a connection. With context takeover the messages have to be sent in the order they were compressed.
+ */
+    class MessageDeflater {
+        struct Stream;
+        std::unique_ptr<Stream> m_stream;
+        bool m_no_context_takeover;
+
+    public:
+        // throws std::invalid_argument if zlib does not accept the parameters
+        MessageDeflater(int level, int window_bits, bool no_context_takeover);
+        ~MessageDeflater();
+
+        MessageDeflater(const MessageDeflater&) = delete;
+        MessageDeflater& operator=(const MessageDeflater&) = delete;
+
+        // the compressed payload of the message (without the closing empty block), replaces the content of out
+        void compress(const char* data, std::size_t size, std::string& out);
+    };
+
+    /**
+ * Decompresses the messages of a connection, in the order they were received.
+ * With context takeover a message refers to the previous ones, so once a message could not be inflated
+ * (corrupt or too large) the inflater has failed, every later message is rejected and the connection has to be closed.
+ */
+    class MessageInflater {
+        struct Stream;
+        std::unique_ptr<Stream> m_stream;
+        bool m_no_context_takeover;
+        std::size_t m_max_size;
+        bool m_failed = false;
+
+    public:
+        MessageInflater(bool no_context_takeover, std::size_t max_size);
+        ~MessageInflater();
+
+        MessageInflater(const MessageInflater&) = delete;
+        MessageInflater& operator=(const MessageInflater&) = delete;
+
+        // the message decompressed from the payload, replaces the content of out (keeps its capacity).
+        // Throws gds_types::invalid_message_error if the payload is corrupt or the message is longer than the maximum
+        void decompress(const char* data, std::size_t size, std::string& out);
+        // a message could not be inflated with context takeover, the later ones cannot be either
+        bool failed() const noexcept { return m_failed; }
+    };
+
+} // namespace connection
+} // namespace gds_lib
+
+#endif // GDS_DEFLATE_HPP
@@ -0,0 +1,264 @@
+#ifndef GDS_FLAT_MAP_HPP
+#define GDS_FLAT_MAP_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <msgpack.hpp>
+
+namespace gds_lib {
+namespace gds_types {
+
+    /**
+ * Map with its entries sorted by the key in a single vector. The maps of the messages have a few entries,
+ * they are decoded into one allocation and looked up by a binary search over contiguous memory instead of the nodes of a tree.
+ * It has the std::map interface used with the messages, but inserting or erasing an entry moves the entries behind it,
+ * and invalidates the iterators and the references to the entries. The keys must not be modified through the iterators.
+ */
+    template <typename K, typename V>
+    class flat_map {
+    public:
+        using key_type = K;
+        using mapped_type = V;
+        using value_type = std::pair<K, V>;
+        using container_type = std::vector<value_type>;
+        using size_type = std::size_t;
+        using iterator = typename container_type::iterator;
+        using const_iterator = typename container_type::const_iterator;
+
+    private:
+        container_type m_items;
+
+        // compares an entry with a key, the string keys can be looked up by a std::string_view
+        struct key_less {
+            template <typename Key>
+            bool operator()(const value_type& item, const Key& key) const { return item.first < key; }
+            template <typename Key>
+            bool operator()(const Key& key, const value_type& item) const { return key < item.first; }
+        };
+
+        // sorts the entries by their keys and removes the duplicates, keeping the first or the last one of the same key
+        void normalize(bool keep_last)
+        {
+            auto less = [](const value_type& left, const value_type& right) { return left.first < right.first; };
+            if (std::adjacent_find(m_items.begin(), m_items.end(), [&less](const value_type& left, const value_type& right) {
+                    return !less(left, right);
+                })
+                == m_items.end()) {
+                return;
+            }
+            std::stable_sort(m_items.begin(), m_items.end(), less);
+            auto last = m_items.begin();
+            for (auto it = m_items.begin(); it != m_items.end();) {
+                auto next = std::find_if(std::next(it), m_items.end(), [&](const value_type& item) { return less(*it, item); });
+                auto kept = keep_last ? std::prev(next) : it;
+                if (last != kept) {
+                    *last = std::move(*kept);
+                }
+                ++last;
+                it = next;
+            }
+            m_items.erase(last, m_items.end());
+        }
+
+    public:
+        flat_map() = default;
+        flat_map(std::initializer_list<value_type> items)
+            : m_items(items)
+        {
+            normalize(false);
+        }
+        template <typename InputIt>
+        flat_map(InputIt first, InputIt last)
+            : m_items(first, last)
+        {
+            normalize(false);
+        }
+        // the entries of a std::map, they are in order already
+        template <typename Alloc>
+        flat_map(const std::map<K, V, std::less<K>, Alloc>& items)
+            : m_items(items.begin(), items.end())
+        {
+        }
+
+        iterator begin() noexcept { return m_items.begin(); }
+        iterator end() noexcept { return m_items.end(); }
+        const_iterator begin() const noexcept { return m_items.begin(); }
+        const_iterator end() const noexcept { return m_items.end(); }
+        const_iterator cbegin() const noexcept { return m_items.cbegin(); }
+        const_iterator cend() const noexcept { return m_items.cend(); }
+
+        bool empty() const noexcept { return m_items.empty(); }
+        size_type size() const noexcept { return m_items.size(); }
+        void reserve(size_type capacity) { m_items.reserve(capacity); }
+        // removes the entries, keeps the capacity
+        void clear() noexcept { m_items.clear(); }
+
+        template <typename Key>
+        iterator lower_bound(const Key& key) { return std::lower_bound(m_items.begin(), m_items.end(), key, key_less()); }
+        template <typename Key>
+        const_iterator lower_bound(const Key& key) const { return std::lower_bound(m_items.begin(), m_items.end(), key, key_less()); }
+
+        template <typename Key>
+        iterator find(const Key& key)
+        {
+            iterator it = lower_bound(key);
+            return it != m_items.end() && !(key < it->first) ? it : m_items.end();
+        }
+        template <typename Key>
+        const_iterator find(const Key& key) const
+        {
+            const_iterator it = lower_bound(key);
+            return it != m_items.end() && !(key < it->first) ? it : m_items.end();
+        }
+        template <typename Key>
+        size_type count(const Key& key) const { return find(key) != end() ? 1 : 0; }
+        template <typename Key>
+        bool contains(const Key& key) const { return find(key) != end(); }
+
+        template <typename Key>
+        V& at(const Key& key)
+        {
+            iterator it = find(key);
+            if (it == m_items.end()) {
+                throw std::out_of_range("flat_map::at");
+            }
+            return it->second;
+        }
+        template <typename Key>
+        const V& at(const Key& key) const
+        {
+            const_iterator it = find(key);
+            if (it == m_items.end()) {
+                throw std::out_of_range("flat_map::at");
+            }
+            return it->second;
+        }
+
+        V& operator[](const K& key) { return try_emplace(key).first->second; }
+        V& operator[](K&& key) { return try_emplace(std::move(key)).first->second; }
+
+        // inserts the entry if the key is not in the map yet, the value is constructed only then
+        template <typename Key, typename... Args>
+        std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args)
+        {
+            iterator it = lower_bound(key);
+            if (it != m_items.end() && !(key < it->first)) {
+                return { it, false };
+            }
+            it = m_items.emplace(it, std::piecewise_construct, std::forward_as_tuple(std::forward<Key>(key)),
+                std::forward_as_tuple(std::forward<Args>(args)...));
+            return { it, true };
+        }
+        template <typename Key, typename M>
+        std::pair<iterator, bool> insert_or_assign(Key&& key, M&& value)
+        {
+            std::pair<iterator, bool> result = try_emplace(std::forward<Key>(key), std::forward<M>(value));
+            if (!result.second) {
+                result.first->second = std::forward<M>(value);
+            }
+            return result;
+        }
+        std::pair<iterator, bool> insert(value_type item) { return try_emplace(std::move(item.first), std::move(item.second)); }
+        template <typename... Args>
+        std::pair<iterator, bool> emplace(Args&&... args) { return insert(value_type(std::forward<Args>(args)...)); }
+
+        iterator erase(const_iterator position) { return m_items.erase(position); }
+        template <typename Key>
+        size_type erase(const Key& key)
+        {
+            const_iterator it = find(key);
+            if (it == m_items.cend()) {
+                return 0;
+            }
+            m_items.erase(it);
+            return 1;
+        }
+
+        /**
+ * Appends an entry without looking for its place, sort() has to be called after the last one.
+ * The decoders build the map in one pass by this, the entries are sorted only if they were not received in order.
+ */
+        template <typename... Args>
+        value_type& append(Args&&... args) { return m_items.emplace_back(std::forward<Args>(args)...); }
+        // orders the appended entries, of the entries with the same key the last one is kept (as by the std::map conversion of msgpack)
+        void sort() { normalize(true); }
+
+        bool operator==(const flat_map& other) const { return m_items == other.m_items; }
+        bool operator!=(const flat_map& other) const { return m_items != other.m_items; }
+    };
+
+} // namespace gds_types
+} // namespace gds_lib
+
+namespace msgpack {
+MSGPACK_API_VERSION_NAMESPACE(MSGPACK_DEFAULT_API_NS)
+{
+    namespace adaptor {
+
+        template <typename K, typename V>
+        struct convert<gds_lib::gds_types::flat_map<K, V> > {
+            const msgpack::object& operator()(const msgpack::object& o, gds_lib::gds_types::flat_map<K, V>& v) const
+            {
+                if (o.type != msgpack::type::MAP) {
+                    throw msgpack::type_error();
+                }
+                v.clear();
+                v.reserve(o.via.map.size);
+                for (const msgpack::object_kv *p = o.via.map.ptr, *pend = o.via.map.ptr + o.via.map.size; p != pend; ++p) {
+                    auto& item = v.append();
+                    p->key.convert(item.first);
+                    p->val.convert(item.second);
+                }
+                v.sort();
+                return o;
+            }
+        };
+
+        template <typename K, typename V>
+        struct pack<gds_lib::gds_types::flat_map<K, V> > {
+            template <typename Stream>
+            msgpack::packer<Stream>& operator()(msgpack::packer<Stream>& o, const gds_lib::gds_types::flat_map<K, V>& v) const
+            {
+                o.pack_map(checked_get_container_size(v.size()));
+                for (const auto& item : v) {
+                    o.pack(item.first);
+                    o.pack(item.second);
+                }
+                return o;
+            }
+        };
+
+        template <typename K, typename V>
+        struct object_with_zone<gds_lib::gds_types::flat_map<K, V> > {
+            void operator()(msgpack::object::with_zone& o, const gds_lib::gds_types::flat_map<K, V>& v) const
+            {
+                o.type = msgpack::type::MAP;
+                o.via.map.size = checked_get_container_size(v.size());
+                o.via.map.ptr = nullptr;
+                if (v.empty()) {
+                    return;
+                }
+                msgpack::object_kv* p = static_cast<msgpack::object_kv*>(
+                    o.zone.allocate_align(sizeof(msgpack::object_kv) * v.size(), MSGPACK_ZONE_ALIGNOF(msgpack::object_kv)));
+                o.via.map.ptr = p;
+                for (const auto& item : v) {
+                    p->key = msgpack::object(item.first, o.zone);
+                    p->val = msgpack::object(item.second, o.zone);
+                    ++p;
+                }
+            }
+        };
+
+    } // namespace adaptor
+} // MSGPACK_API_VERSION_NAMESPACE(MSGPACK_DEFAULT_API_NS)
+} // namespace msgpack
+
+#endif // GDS_FLAT_MAP_HPP
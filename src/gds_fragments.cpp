@@ -0,0 +1,181 @@
+#include "gds_fragments.hpp"
+#include "gds_reader.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace gds_lib {
+namespace gds_types {
+
+  namespace {
+    // lets a msgpack::packer append to a std::string
+    struct string_writer
+    {
+      std::string& out;
+      void write(const char* data, std::size_t size) { out.append(data, size); }
+    };
+
+    constexpr std::size_t max_data_size = static_cast<std::size_t>(std::numeric_limits<int32_t>::max());
+  }
+
+  MessageFragmenter::MessageFragmenter(const char* data, std::size_t size, std::size_t unit)
+    : m_header(GdsMessageHeader::peek(data, size)), m_unit(unit)
+  {
+    if (unit == 0)
+    {
+      throw std::invalid_argument("MessageFragmenter: the fragment unit has to be positive");
+    }
+    if (m_header.isFragmented)
+    {
+      throw std::invalid_argument("MessageFragmenter: the message is a fragment already");
+    }
+    // the offset and the full data size are 32 bit integers in the header
+    if (m_header.body.size() > max_data_size)
+    {
+      throw invalid_message_error(GdsMsgType::HEADER_MESSAGE, "the message is too large to be fragmented");
+    }
+    m_count = std::max<std::size_t>(1, (m_header.body.size() + unit - 1) / unit);
+  }
+
+  std::string MessageFragmenter::fragment_id(std::size_t index) const
+  {
+    if (index == 0)
+    {
+      return m_header.messageId;
+    }
+    return m_header.messageId + '-' + std::to_string(index);
+  }
+
+  void MessageFragmenter::pack(PackBuffer& buffer, std::size_t index) const
+  {
+    if (index >= m_count)
+    {
+      throw std::out_of_range("MessageFragmenter::pack");
+    }
+    const std::size_t offset = index * m_unit;
+    const std::size_t size = std::min(m_unit, m_header.body.size() - offset);
+
+    Packer packer(buffer);
+    packer.pack_array(GdsHeader::DATA + 1);
+    packer.pack(m_header.userName);
+    packer.pack(fragment_id(index));
+    packer.pack_int64(m_header.createTime);
+    packer.pack_int64(m_header.requestTime);
+    packer.pack_true();
+    packer.pack(m_header.messageId);
+    packer.pack(fragment_id(m_count - 1));
+    packer.pack_int32(static_cast<int32_t>(offset));
+    packer.pack_int32(static_cast<int32_t>(m_header.body.size()));
+    packer.pack_int32(m_header.dataType);
+    packer.pack_bin(static_cast<uint32_t>(size));
+    packer.pack_bin_body(m_header.body.data() + offset, static_cast<uint32_t>(size));
+  }
+
+  FragmentAssembler::FragmentAssembler(const FragmentOptions& options)
+    : m_max_message_size(std::min(options.max_message_size, max_data_size)), m_max_pending(std::max<std::size_t>(1, options.max_pending)) {}
+
+  void FragmentAssembler::drop(const std::string& id)
+  {
+    if (m_pending.erase(id))
+    {
+      ++m_stats.dropped;
+    }
+  }
+
+  std::shared_ptr<const std::string> FragmentAssembler::add(const GdsMessageHeader& fragment)
+  {
+    ++m_stats.fragments;
+    if (!fragment.isFragmented)
+    {
+      throw invalid_message_error(GdsMsgType::HEADER_MESSAGE, "the message is not a fragment");
+    }
+    const std::string& first = *fragment.firstFragment;
+    const int32_t offset = *fragment.offset;
+    const int32_t full_size = *fragment.fds;
+    MessageReader reader(fragment.body.data(), fragment.body.size());
+    const byte_view slice = reader.read_binary_view();
+
+    auto it = m_pending.find(first);
+    if (it == m_pending.end())
+    {
+      if (offset != 0 || fragment.messageId != first)
+      {
+        ++m_stats.dropped;
+        throw invalid_message_error(GdsMsgType::HEADER_MESSAGE, "the first fragment of the message is missing");
+      }
+      if (full_size < 0 || static_cast<std::size_t>(full_size) > m_max_message_size)
+      {
+        ++m_stats.dropped;
+        throw invalid_message_error(GdsMsgType::HEADER_MESSAGE, "the fragmented message is too large");
+      }
+      if (m_pending.size() >= m_max_pending)
+      {
+        auto oldest = std::min_element(m_pending.begin(), m_pending.end(),
+          [](const auto& lhs, const auto& rhs) { return lhs.second.started < rhs.second.started; });
+        m_pending.erase(oldest);
+        ++m_stats.dropped;
+      }
+
+      // the header of the whole message is the one of its first fragment, not fragmented
+      Pending pending;
+      pending.message = std::make_shared<std::string>();
+      {
+        string_writer writer{*pending.message};
+        msgpack::packer<string_writer> packer(writer);
+        packer.pack_array(GdsHeader::DATA + 1);
+        packer.pack(fragment.userName);
+        packer.pack(first);
+        packer.pack_int64(fragment.createTime);
+        packer.pack_int64(fragment.requestTime);
+        packer.pack_false();
+        packer.pack_nil();
+        packer.pack_nil();
+        packer.pack_nil();
+        packer.pack_nil();
+        packer.pack_int32(fragment.dataType);
+      }
+      pending.header_size = pending.message->size();
+      pending.full_size = static_cast<std::size_t>(full_size);
+      pending.message->reserve(pending.header_size + pending.full_size);
+      pending.last_fragment = *fragment.lastFragment;
+      pending.dataType = fragment.dataType;
+      pending.started = m_started++;
+      it = m_pending.emplace(first, std::move(pending)).first;
+    } else if (static_cast<std::size_t>(full_size) != it->second.full_size || fragment.dataType != it->second.dataType ||
+               *fragment.lastFragment != it->second.last_fragment)
+    {
+      drop(first);
+      throw invalid_message_error(GdsMsgType::HEADER_MESSAGE, "the header of the fragment differs from the first fragment");
+    }
+
+    Pending& pending = it->second;
+    const std::size_t received = pending.message->size() - pending.header_size;
+    if (offset < 0 || static_cast<std::size_t>(offset) != received)
+    {
+      drop(first);
+      throw invalid_message_error(GdsMsgType::HEADER_MESSAGE, "the fragments of the message are out of order");
+    }
+    if (slice.size > pending.full_size - received)
+    {
+      drop(first);
+      throw invalid_message_error(GdsMsgType::HEADER_MESSAGE, "the fragments are longer than the full data size");
+    }
+    pending.message->append(reinterpret_cast<const char*>(slice.data), slice.size);
+
+    if (received + slice.size < pending.full_size)
+    {
+      return nullptr;
+    }
+    if (fragment.messageId != pending.last_fragment)
+    {
+      drop(first);
+      throw invalid_message_error(GdsMsgType::HEADER_MESSAGE, "the data of the message ended before its last fragment");
+    }
+    std::shared_ptr<const std::string> message = std::move(pending.message);
+    m_pending.erase(it);
+    ++m_stats.messages;
+    return message;
+  }
+
+} // namespace gds_types
+} // namespace gds_lib
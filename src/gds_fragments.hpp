@@ -0,0 +1,121 @@
+#ifndef GDS_FRAGMENTS_HPP
+#define GDS_FRAGMENTS_HPP
+
+#include "gds_types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace gds_lib {
+namespace gds_types {
+
+    /**
+ * Settings of the message fragmentation
+ */
+    struct FragmentOptions {
+        // the largest DATA element sent in one piece, the bodies longer than this are split into fragments.
+        // 0 turns the fragmentation off, the client does not offer it at the login then
+        std::size_t unit = 0;
+        // the largest message reassembled from fragments, the fragments of a longer one are rejected
+        std::size_t max_message_size = 64 * 1024 * 1024;
+        // the number of messages reassembled at the same time, the oldest one is dropped if a new one starts over this
+        std::size_t max_pending = 16;
+    };
+
+    /**
+ * Counters of the reassembly
+ */
+    struct FragmentStats {
+        std::size_t fragments = 0; // the fragments received
+        std::size_t messages = 0; // the messages reassembled
+        std::size_t dropped = 0; // the partial messages dropped, because they were invalid or too many were pending
+        std::size_t pending = 0; // the messages being reassembled
+    };
+
+    /**
+ * Splits a packed message into fragments. The packed DATA element is cut into slices of at most `unit` bytes,
+ * every fragment is a whole message with the header of the original one and a slice as its (binary) DATA.
+ * The first fragment has the id of the message, the others get an index appended ("<id>-1", "<id>-2"..).
+ * The header of every fragment names the first and the last fragment by their ids, the offset is the position of the slice
+ * in the packed data, the full data size is the size of the packed data.
+ * The fragmenter points into the packed message, it has to outlive the fragmenter.
+ */
+    class MessageFragmenter {
+        GdsMessageHeader m_header;
+        std::size_t m_unit;
+        std::size_t m_count;
+
+        std::string fragment_id(std::size_t index) const;
+
+    public:
+        // throws std::invalid_argument if the unit is 0, invalid_message_error if the message is too large to be fragmented
+        MessageFragmenter(const char* data, std::size_t size, std::size_t unit);
+
+        // the number of fragments, 1 if the DATA fits into a single unit (the message does not need fragmentation then)
+        std::size_t count() const noexcept { return m_count; }
+        const GdsMessageHeader& header() const noexcept { return m_header; }
+
+        // packs the fragment of the given index as a whole message
+        void pack(PackBuffer& buffer, std::size_t index) const;
+
+        template <typename Buffer>
+        void pack_into(Buffer& buffer, std::size_t index) const
+        {
+            if constexpr (std::is_base_of_v<PackBuffer, Buffer>) {
+                pack(buffer, index);
+            } else {
+                PackBufferAdapter<Buffer> adapter(buffer);
+                pack(adapter, index);
+            }
+        }
+    };
+
+    /**
+ * Reassembles the received fragments. The fragments of a message have to arrive in order, but the fragments
+ * of different messages (and not fragmented messages) can be interleaved. The data of a message is appended to a single
+ * buffer sized by its full data size, so the memory is bounded by max_message_size * max_pending.
+ * Not thread safe, the fragments are expected from a single connection (thread).
+ */
+    class FragmentAssembler {
+        struct Pending {
+            std::shared_ptr<std::string> message; // the header of the whole message, followed by the data received so far
+            std::size_t header_size;
+            std::size_t full_size;
+            std::string last_fragment;
+            int32_t dataType;
+            uint64_t started; // the order the messages were started in, the oldest is dropped first
+        };
+
+        std::unordered_map<std::string, Pending> m_pending;
+        std::size_t m_max_message_size;
+        std::size_t m_max_pending;
+        uint64_t m_started = 0;
+        FragmentStats m_stats;
+
+        void drop(const std::string& id);
+
+    public:
+        explicit FragmentAssembler(const FragmentOptions& options = FragmentOptions{});
+
+        // adds a fragment, returns the whole packed message (not fragmented, with the id of the first fragment)
+        // once its last fragment arrived, nullptr before that.
+        // Throws invalid_message_error if the fragment does not continue its message, the partial message is dropped then
+        std::shared_ptr<const std::string> add(const GdsMessageHeader& fragment);
+
+        FragmentStats stats() const noexcept
+        {
+            FragmentStats stats = m_stats;
+            stats.pending = m_pending.size();
+            return stats;
+        }
+        void clear() noexcept { m_pending.clear(); }
+    };
+
+} // namespace gds_types
+} // namespace gds_lib
+
+#endif // GDS_FRAGMENTS_HPP
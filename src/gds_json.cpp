@@ -0,0 +1,629 @@
+#include "gds_json.hpp"
+#include "gds_reader.hpp"
+
+#include <array>
+#include <charconv>
+#include <cmath>
+
+namespace gds_lib {
+namespace gds_types {
+
+  namespace {
+    // the characters that have to be escaped in a JSON string: the control characters, the quote and the backslash
+    constexpr std::array<bool, 256> make_escaped()
+    {
+      std::array<bool, 256> escaped{};
+      for (int ch = 0; ch < 0x20; ++ch)
+      {
+        escaped[ch] = true;
+      }
+      escaped['"'] = true;
+      escaped['\\'] = true;
+      return escaped;
+    }
+
+    constexpr std::array<bool, 256> escaped = make_escaped();
+
+    constexpr char hex_digits[] = "0123456789abcdef";
+    constexpr char base64_digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    void write_cell(JsonWriter& writer, const GdsColumn& column, std::size_t row)
+    {
+      if (column.is_nil(row))
+      {
+        writer.null();
+        return;
+      }
+      switch (column.type)
+      {
+        case GdsColumn::Type::INTEGER:
+        writer.value(column.integer(row));
+        break;
+        case GdsColumn::Type::DOUBLE:
+        writer.value(column.floating(row));
+        break;
+        case GdsColumn::Type::BOOLEAN:
+        writer.value(column.boolean(row));
+        break;
+        case GdsColumn::Type::STRING:
+        writer.value(column.string(row));
+        break;
+        case GdsColumn::Type::BINARY:
+        writer.value(column.binary(row));
+        break;
+        case GdsColumn::Type::VALUE:
+        writer.value(column.values[row]);
+        break;
+      }
+    }
+  }
+
+  void JsonWriter::separate()
+  {
+    if (m_comma)
+    {
+      m_out.push_back(',');
+    }
+    m_comma = true;
+  }
+
+  void JsonWriter::write_string(std::string_view item)
+  {
+    m_out.push_back('"');
+    const char* run = item.data();
+    const char* end = item.data() + item.size();
+    for (const char* position = run; position != end; ++position)
+    {
+      uint8_t ch = static_cast<uint8_t>(*position);
+      if (!escaped[ch])
+      {
+        continue;
+      }
+      // the characters since the previous escape are appended at once
+      m_out.append(run, position);
+      run = position + 1;
+      switch (ch)
+      {
+        case '"':
+        m_out.append("\\\"");
+        break;
+        case '\\':
+        m_out.append("\\\\");
+        break;
+        case '\n':
+        m_out.append("\\n");
+        break;
+        case '\r':
+        m_out.append("\\r");
+        break;
+        case '\t':
+        m_out.append("\\t");
+        break;
+        default:
+        {
+          char code[6] = {'\\', 'u', '0', '0', hex_digits[ch >> 4], hex_digits[ch & 15]};
+          m_out.append(code, sizeof(code));
+        }
+        break;
+      }
+    }
+    m_out.append(run, end);
+    m_out.push_back('"');
+  }
+
+  void JsonWriter::write_int(int64_t item)
+  {
+    char digits[24];
+    std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), item);
+    m_out.append(digits, result.ptr);
+  }
+
+  void JsonWriter::write_uint(uint64_t item)
+  {
+    char digits[24];
+    std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), item);
+    m_out.append(digits, result.ptr);
+  }
+
+  void JsonWriter::write_double(double item)
+  {
+    if (!std::isfinite(item))
+    {
+      m_out.append("null");
+      return;
+    }
+    char digits[32];
+    std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), item);
+    m_out.append(digits, result.ptr);
+  }
+
+  // floats are written in their own shortest form, not in the one of the double they widen to
+  void JsonWriter::write_float(float item)
+  {
+    if (!std::isfinite(item))
+    {
+      m_out.append("null");
+      return;
+    }
+    char digits[32];
+    std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), item);
+    m_out.append(digits, result.ptr);
+  }
+
+  JsonWriter& JsonWriter::begin_object()
+  {
+    separate();
+    m_out.push_back('{');
+    m_comma = false;
+    return *this;
+  }
+
+  JsonWriter& JsonWriter::end_object()
+  {
+    m_out.push_back('}');
+    m_comma = true;
+    return *this;
+  }
+
+  JsonWriter& JsonWriter::begin_array()
+  {
+    separate();
+    m_out.push_back('[');
+    m_comma = false;
+    return *this;
+  }
+
+  JsonWriter& JsonWriter::end_array()
+  {
+    m_out.push_back(']');
+    m_comma = true;
+    return *this;
+  }
+
+  JsonWriter& JsonWriter::key(std::string_view name)
+  {
+    separate();
+    write_string(name);
+    m_out.push_back(':');
+    m_comma = false;
+    return *this;
+  }
+
+  JsonWriter& JsonWriter::key(int64_t name)
+  {
+    separate();
+    m_out.push_back('"');
+    write_int(name);
+    m_out.append("\":");
+    m_comma = false;
+    return *this;
+  }
+
+  JsonWriter& JsonWriter::newline()
+  {
+    m_out.push_back('\n');
+    m_comma = false;
+    return *this;
+  }
+
+  JsonWriter& JsonWriter::null()
+  {
+    separate();
+    m_out.append("null");
+    return *this;
+  }
+
+  JsonWriter& JsonWriter::value(std::string_view item)
+  {
+    separate();
+    write_string(item);
+    return *this;
+  }
+
+  JsonWriter& JsonWriter::value(const uint8_t* data, std::size_t size)
+  {
+    separate();
+    if (m_binaries == BinaryFormat::SIZE)
+    {
+      m_out.push_back('"');
+      m_out.push_back('<');
+      write_uint(size);
+      m_out.append(" bytes>\"");
+      return *this;
+    }
+    // the encoded size is known, the digits are written in place
+    std::size_t start = m_out.size();
+    m_out.resize(start + 2 + (size + 2) / 3 * 4);
+    char* out = &m_out[start];
+    *out++ = '"';
+    std::size_t ii = 0;
+    for (; ii + 3 <= size; ii += 3)
+    {
+      uint32_t group = (uint32_t(data[ii]) << 16) | (uint32_t(data[ii + 1]) << 8) | data[ii + 2];
+      *out++ = base64_digits[(group >> 18) & 63];
+      *out++ = base64_digits[(group >> 12) & 63];
+      *out++ = base64_digits[(group >> 6) & 63];
+      *out++ = base64_digits[group & 63];
+    }
+    if (ii < size)
+    {
+      uint32_t group = uint32_t(data[ii]) << 16;
+      if (ii + 1 < size)
+      {
+        group |= uint32_t(data[ii + 1]) << 8;
+      }
+      *out++ = base64_digits[(group >> 18) & 63];
+      *out++ = base64_digits[(group >> 12) & 63];
+      *out++ = ii + 1 < size ? base64_digits[(group >> 6) & 63] : '=';
+      *out++ = '=';
+    }
+    *out = '"';
+    return *this;
+  }
+
+  std::string to_json(const Stringable& item, BinaryFormat::Enum binaries)
+  {
+    std::string out;
+    JsonWriter writer(out, binaries);
+    writer.value(item);
+    return out;
+  }
+
+  void append_ndjson(std::string& out, const Stringable& item, BinaryFormat::Enum binaries)
+  {
+    JsonWriter writer(out, binaries);
+    writer.value(item).newline();
+  }
+
+
+  void Stringable::to_json(JsonWriter& writer) const
+  {
+    writer.value(to_string());
+  }
+
+  void GdsMessage::to_json(JsonWriter& writer) const
+  {
+    writer.begin_object();
+    writer.field("userName", userName);
+    writer.field("messageId", messageId);
+    writer.field("createTime", createTime);
+    writer.field("requestTime", requestTime);
+    writer.field("isFragmented", isFragmented);
+    writer.field("firstFragment", firstFragment);
+    writer.field("lastFragment", lastFragment);
+    writer.field("offset", offset);
+    writer.field("fds", fds);
+    writer.field("dataType", dataType);
+    writer.key("messageBody");
+    if (messageBody)
+    {
+      messageBody->to_json(writer);
+    }
+    else
+    {
+      writer.null();
+    }
+    writer.end_object();
+  }
+
+  void GdsMessageHeader::to_json(JsonWriter& writer) const
+  {
+    writer.begin_object();
+    writer.field("userName", userName);
+    writer.field("messageId", messageId);
+    writer.field("createTime", createTime);
+    writer.field("requestTime", requestTime);
+    writer.field("isFragmented", isFragmented);
+    writer.field("firstFragment", firstFragment);
+    writer.field("lastFragment", lastFragment);
+    writer.field("offset", offset);
+    writer.field("fds", fds);
+    writer.field("dataType", dataType);
+    // the body is still packed, it is written as binary
+    writer.key("body").value(reinterpret_cast<const uint8_t*>(body.data()), body.size());
+    writer.end_object();
+  }
+
+  void GdsFieldValue::to_json(JsonWriter& writer) const
+  {
+    visit([&writer](const auto& item) {
+      using item_t = std::decay_t<decltype(item)>;
+      if constexpr (std::is_same_v<item_t, nil_t>)
+      {
+        writer.null();
+      }
+      else
+      {
+        writer.value(item);
+      }
+    });
+  }
+
+  void GdsColumn::to_json(JsonWriter& writer) const
+  {
+    writer.begin_array();
+    for (std::size_t row = 0; row < size; ++row)
+    {
+      write_cell(writer, *this, row);
+    }
+    writer.end_array();
+  }
+
+  void EventReplyBody::to_json(JsonWriter& writer) const
+  {
+    writer.begin_object();
+    writer.field("results", results);
+    writer.end_object();
+  }
+
+  void EventReplyBody::EventSubResult::to_json(JsonWriter& writer) const
+  {
+    writer.begin_object();
+    writer.field("status", status);
+    writer.field("id", id);
+    writer.field("tableName", tableName);
+    writer.field("created", created);
+    writer.field("version", version);
+    writer.field("values", values);
+    writer.end_object();
+  }
+
+  void EventReplyBody::GdsEventResult::to_json(JsonWriter& writer) const
+  {
+    writer.begin_object();
+    writer.field("status", status);
+    writer.field("notification", notification);
+    writer.field("fieldDescriptor", fieldDescriptor);
+    writer.field("subResults", subResults);
+    writer.end_object();
+  }
+
+  void AttachmentResult::to_json(JsonWriter& writer) const
+  {
+    writer.begin_object();
+    writer.field("requestIDs", requestIDs);
+    writer.field("ownerTable", ownerTable);
+    writer.field("attachmentID", attachmentID);
+    writer.field("ownerIDs", ownerIDs);
+    writer.field("meta", meta);
+    writer.field("ttl", ttl);
+    writer.field("to_valid", to_valid);
+    writer.field("attachment", attachment);
+    writer.end_object();
+  }
+
+  void AttachmentRequestBody::to_json(JsonWriter& writer) const
+  {
+    writer.begin_object();
+    writer.field("status", status);
+    writer.field("result", result);
+    writer.field("waitTime", waitTime);
+    writer.end_object();
+  }
+
+  void AttachmentResponse::to_json(JsonWriter& writer) const
+  {
+    writer.begin_object();
+    writer.field("requestIDs", requestIDs);
+    writer.field("ownerTable", ownerTable);
+    writer.field("attachmentID", attachmentID);
+    writer.end_object();
+  }
+
+  void AttachmentResponseBody::to_json(JsonWriter& writer) const
+  {
+    writer.begin_object();
+    writer.field("status", status);
+    writer.field("result", result);
+    writer.end_object();
+  }
+
+  void EventDocumentResult::to_json(JsonWriter& writer) const
+  {
+    writer.begin_object();
+    writer.field("status_code", status_code);
+    writer.field("notification", notification);
+    writer.field("returnings", returnings);
+    writer.end_object();
+  }
+
+  void QueryContextDescriptor::to_json(JsonWriter& writer) const
+  {
+    writer.begin_object();
+    writer.field("scroll_id", scroll_id);
+    writer.field("select_query", select_query);
+    writer.field("delivered_hits", delivered_hits);
+    writer.field("query_start_time", query_start_time);
+    writer.field("consistency_type", consistency_type);
+    writer.field("last_bucket_id", last_bucket_id);
+    writer.field("gds_holder", gds_holder);
+    writer.field("field_values", field_values);
+    writer.field("partition_names", partition_names);
+    writer.end_object();
+  }
+
+  // the hits are written as rows in both layouts, the columns are read cell by cell
+  void QueryReplyBody::to_json(JsonWriter& writer) const
+  {
+    writer.begin_object();
+    writer.field("numberOfHits", numberOfHits);
+    writer.field("filteredHits", filteredHits);
+    writer.field("hasMorePages", hasMorePages);
+    writer.field("queryContextDescriptor", queryContextDescriptor);
+    writer.field("fieldDescriptors", descriptors());
+    writer.key("hits");
+    if (columns)
+    {
+      std::size_t rows = columns->empty() ? 0 : columns->front().size;
+      writer.begin_array();
+      for (std::size_t row = 0; row < rows; ++row)
+      {
+        writer.begin_array();
+        for (const GdsColumn& column : *columns)
+        {
+          write_cell(writer, column, row);
+        }
+        writer.end_array();
+      }
+      writer.end_array();
+    }
+    else
+    {
+      writer.value(hits);
+    }
+    writer.field("totalNumberOfHits", totalNumberOfHits);
+    writer.end_object();
+  }
+
+
+  /*0*/
+  void GdsLoginMessage::to_json(JsonWriter& writer) const
+  {
+    writer.begin_object();
+    writer.field("cluster_name", cluster_name);
+    writer.field("serve_on_the_same_connection", serve_on_the_same_connection);
+    writer.field("protocol_version_number", protocol_version_number);
+    writer.field("fragmentation_supported", fragmentation_supported);
+    writer.field("fragment_transmission_unit", fragment_transmission_unit);
+    writer.field("reserved_fields", reserved_fields);
+    writer.end_object();
+  }
+
+  /*1*/
+  void GdsLoginReplyMessage::to_json(JsonWriter& writer) const
+  {
+    writer.begin_object();
+    writer.field("ackStatus", ackStatus);
+    writer.field("loginReply", loginReply);
+    writer.field("errorDetails", errorDetails);
+    writer.field("ackException", ackException);
+    writer.end_object();
+  }
+
+  /*2*/
+  void GdsEventMessage::to_json(JsonWriter& writer) const
+  {
+    writer.begin_object();
+    writer.field("operations", operations);
+    writer.field("binaryContents", binaryContents);
+    writer.field("priorityLevels", priorityLevels);
+    writer.end_object();
+  }
+
+  // the same document as the GdsEventMessage, the attachments are read back from the packed pairs
+  void EventBuilder::to_json(JsonWriter& writer) const
+  {
+    writer.begin_object();
+    writer.field("operations", m_operations);
+    writer.key("binaryContents").begin_object();
+    MessageReader reader(m_attachments.data(), m_attachments.size());
+    for (std::size_t ii = 0; ii < m_attachment_ids.size(); ++ii)
+    {
+      writer.key(reader.read_string_view());
+      writer.value(reader.read_binary_view());
+    }
+    writer.end_object();
+    writer.field("priorityLevels", priorityLevels);
+    writer.end_object();
+  }
+
+  /*3*/
+  void GdsEventReplyMessage::to_json(JsonWriter& writer) const
+  {
+    writer.begin_object();
+    writer.field("ackStatus", ackStatus);
+    writer.field("reply", reply);
+    writer.field("ackException", ackException);
+    writer.end_object();
+  }
+
+  /*4*/
+  void GdsAttachmentRequestMessage::to_json(JsonWriter& writer) const
+  {
+    writer.begin_object();
+    writer.field("request", request);
+    writer.end_object();
+  }
+
+  /*5*/
+  void GdsAttachmentRequestReplyMessage::to_json(JsonWriter& writer) const
+  {
+    writer.begin_object();
+    writer.field("ackStatus", ackStatus);
+    writer.field("request", request);
+    writer.field("ackException", ackException);
+    writer.end_object();
+  }
+
+  /*6*/
+  void GdsAttachmentResponseMessage::to_json(JsonWriter& writer) const
+  {
+    writer.begin_object();
+    writer.field("result", result);
+    writer.end_object();
+  }
+
+  /*7*/
+  void GdsAttachmentResponseResultMessage::to_json(JsonWriter& writer) const
+  {
+    writer.begin_object();
+    writer.field("ackStatus", ackStatus);
+    writer.field("response", response);
+    writer.field("ackException", ackException);
+    writer.end_object();
+  }
+
+  /*8*/
+  void GdsEventDocumentMessage::to_json(JsonWriter& writer) const
+  {
+    writer.begin_object();
+    writer.field("tableName", tableName);
+    writer.field("fieldDescriptors", fieldDescriptors);
+    writer.field("records", records);
+    writer.field("returnings", returnings);
+    writer.end_object();
+  }
+
+  /*9*/
+  void GdsEventDocumentReplyMessage::to_json(JsonWriter& writer) const
+  {
+    writer.begin_object();
+    writer.field("ackStatus", ackStatus);
+    writer.field("results", results);
+    writer.field("ackException", ackException);
+    writer.end_object();
+  }
+
+  /*10*/
+  void GdsQueryRequestMessage::to_json(JsonWriter& writer) const
+  {
+    writer.begin_object();
+    writer.field("selectString", selectString);
+    writer.field("consistency", consistency);
+    writer.field("timeout", timeout);
+    writer.field("queryPageSize", queryPageSize);
+    writer.field("queryType", queryType);
+    writer.end_object();
+  }
+
+  /*11*/
+  void GdsQueryReplyMessage::to_json(JsonWriter& writer) const
+  {
+    writer.begin_object();
+    writer.field("ackStatus", ackStatus);
+    writer.field("response", response);
+    writer.field("ackException", ackException);
+    writer.end_object();
+  }
+
+  /*12*/
+  void GdsNextQueryRequestMessage::to_json(JsonWriter& writer) const
+  {
+    writer.begin_object();
+    writer.field("contextDescriptor", contextDescriptor);
+    writer.field("timeout", timeout);
+    writer.end_object();
+  }
+
+} // namespace gds_types
+} // namespace gds_lib
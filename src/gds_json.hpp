@@ -0,0 +1,161 @@
+#ifndef GDS_JSON_HPP
+#define GDS_JSON_HPP
+
+#include "gds_types.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace gds_lib {
+namespace gds_types {
+
+    /**
+ * How the binary values (attachments, BINARY fields) are written.
+ */
+    struct BinaryFormat {
+        enum Enum {
+            BASE64 = 0, // the content, as a base64 string
+            SIZE = 1 // only the size, as a "<N bytes>" string (for logs)
+        };
+    };
+
+    /**
+ * Streaming JSON writer, appends to a string owned by the caller. Nothing is allocated besides the growth of that string,
+ * so a cleared buffer can be reused for the next message (or written as NDJSON, one message per line).
+ * The strings are escaped, the numbers are written by their types, doubles in the shortest form that reads back the same
+ * (NaN and infinities as null). The writer does not check the structure, the calls have to be balanced by the caller.
+ */
+    class JsonWriter {
+        std::string& m_out;
+        BinaryFormat::Enum m_binaries;
+        bool m_comma = false; // a value was already written at the current level
+
+        void separate();
+        void write_string(std::string_view item);
+        void write_int(int64_t item);
+        void write_uint(uint64_t item);
+        void write_double(double item);
+        void write_float(float item);
+
+    public:
+        explicit JsonWriter(std::string& out, BinaryFormat::Enum binaries = BinaryFormat::BASE64)
+            : m_out(out)
+            , m_binaries(binaries)
+        {
+        }
+
+        std::string& buffer() noexcept { return m_out; }
+        BinaryFormat::Enum binaries() const noexcept { return m_binaries; }
+
+        JsonWriter& begin_object();
+        JsonWriter& end_object();
+        JsonWriter& begin_array();
+        JsonWriter& end_array();
+        JsonWriter& key(std::string_view name);
+        // integer keys (the maps of the messages keyed by numbers) are written as strings
+        JsonWriter& key(int64_t name);
+        // ends the current document, the next value starts a new line of NDJSON
+        JsonWriter& newline();
+
+        JsonWriter& null();
+        JsonWriter& value(std::string_view item);
+        JsonWriter& value(const std::string& item) { return value(std::string_view(item)); }
+        JsonWriter& value(const char* item) { return value(std::string_view(item)); }
+        JsonWriter& value(const uint8_t* data, std::size_t size);
+        JsonWriter& value(const byte_array& item) { return value(item.data(), item.size()); }
+        JsonWriter& value(const byte_view& item) { return value(item.data, item.size); }
+        JsonWriter& value(const Stringable& item)
+        {
+            item.to_json(*this);
+            return *this;
+        }
+
+        template <typename T, std::enable_if_t<std::is_arithmetic_v<T>, int> = 0>
+        JsonWriter& value(T item)
+        {
+            separate();
+            if constexpr (std::is_same_v<T, bool>) {
+                m_out.append(item ? "true" : "false");
+            } else if constexpr (std::is_same_v<T, float>) {
+                write_float(item);
+            } else if constexpr (std::is_floating_point_v<T>) {
+                write_double(static_cast<double>(item));
+            } else if constexpr (std::is_signed_v<T>) {
+                write_int(item);
+            } else {
+                write_uint(item);
+            }
+            return *this;
+        }
+
+        template <typename T>
+        JsonWriter& value(const std::optional<T>& item)
+        {
+            return item ? value(*item) : null();
+        }
+
+        template <typename T, typename A>
+        JsonWriter& value(const std::vector<T, A>& items)
+        {
+            begin_array();
+            for (const T& item : items) {
+                value(item);
+            }
+            return end_array();
+        }
+
+        template <typename T, std::size_t N>
+        JsonWriter& value(const std::array<T, N>& items)
+        {
+            begin_array();
+            for (const T& item : items) {
+                value(item);
+            }
+            return end_array();
+        }
+
+        template <typename K, typename V>
+        JsonWriter& value(const std::map<K, V>& items) { return object_of<K>(items); }
+        template <typename K, typename V>
+        JsonWriter& value(const flat_map<K, V>& items) { return object_of<K>(items); }
+
+        // the entries of a map as the members of an object
+        template <typename K, typename Map>
+        JsonWriter& object_of(const Map& items)
+        {
+            begin_object();
+            for (const auto& item : items) {
+                if constexpr (std::is_integral_v<K>) {
+                    key(static_cast<int64_t>(item.first));
+                } else {
+                    key(item.first);
+                }
+                value(item.second);
+            }
+            return end_object();
+        }
+
+        template <typename T>
+        JsonWriter& field(std::string_view name, const T& item)
+        {
+            key(name);
+            return value(item);
+        }
+    };
+
+    // the item as a single JSON document
+    std::string to_json(const Stringable& item, BinaryFormat::Enum binaries = BinaryFormat::BASE64);
+    // appends the item to the buffer as a line of NDJSON
+    void append_ndjson(std::string& out, const Stringable& item, BinaryFormat::Enum binaries = BinaryFormat::BASE64);
+
+} // namespace gds_types
+} // namespace gds_lib
+
+#endif // GDS_JSON_HPP
@@ -0,0 +1,89 @@
+#ifndef GDS_POOL_HPP
+#define GDS_POOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace gds_lib {
+namespace gds_types {
+
+    /**
+ * Counters of an object pool
+ */
+    struct PoolStats {
+        std::size_t acquired = 0; // the objects handed out
+        std::size_t reused = 0; // the objects handed out again, from the pool
+        std::size_t created = 0; // the objects created for the pool
+        std::size_t overflow = 0; // the objects created outside of the pool, because it was full and all of its objects were in use
+        std::size_t pooled = 0; // the objects owned by the pool
+    };
+
+    /**
+ * Pool of shared objects. An object is handed out again once the pool holds the only reference to it,
+ * so the objects are passed on (to the listeners, to other threads) as plain shared pointers, no custom deleter is involved.
+ * The recycled objects keep their state (and the capacity of their strings and arrays), the user of the pool overwrites it.
+ */
+    template <typename T>
+    class SharedPool {
+        mutable std::mutex m_mutex;
+        std::vector<std::shared_ptr<T> > m_objects;
+        std::size_t m_capacity;
+        std::size_t m_next = 0; // where the search for a free object starts
+        PoolStats m_stats;
+
+    public:
+        // a pool with zero capacity creates a new object every time
+        explicit SharedPool(std::size_t capacity)
+            : m_capacity(capacity)
+        {
+            m_objects.reserve(capacity);
+        }
+
+        SharedPool(const SharedPool&) = delete;
+        SharedPool& operator=(const SharedPool&) = delete;
+
+        // a free object of the pool, or a new one created from the arguments
+        template <typename... Args>
+        std::shared_ptr<T> acquire(Args&&... args)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_stats.acquired;
+            for (std::size_t ii = 0; ii < m_objects.size(); ++ii) {
+                std::size_t index = (m_next + ii) % m_objects.size();
+                if (m_objects[index].use_count() == 1) {
+                    // the last owner released the object with a release operation, its writes have to be visible here
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    m_next = index + 1;
+                    ++m_stats.reused;
+                    return m_objects[index];
+                }
+            }
+            std::shared_ptr<T> object = std::make_shared<T>(std::forward<Args>(args)...);
+            if (m_objects.size() < m_capacity) {
+                m_objects.push_back(object);
+                ++m_stats.created;
+            } else {
+                ++m_stats.overflow;
+            }
+            return object;
+        }
+
+        PoolStats stats() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            PoolStats stats = m_stats;
+            stats.pooled = m_objects.size();
+            return stats;
+        }
+
+        std::size_t capacity() const noexcept { return m_capacity; }
+    };
+
+} // namespace gds_types
+} // namespace gds_lib
+
+#endif // GDS_POOL_HPP
@@ -0,0 +1,549 @@
+#include "gds_reader.hpp"
+
+#include <array>
+#include <cstring>
+#include <limits>
+
+namespace gds_lib {
+namespace gds_types {
+
+  namespace {
+    // marks the format byte 0xc1, which is never used
+    constexpr uint8_t invalid_format = 0xff;
+
+    // the object type of every format byte, so the type of the next value is a single lookup
+    constexpr std::array<uint8_t, 256> make_format_types()
+    {
+      std::array<uint8_t, 256> types{};
+      for (int format = 0; format < 256; ++format)
+      {
+        msgpack::type::object_type type = msgpack::type::EXT;
+        if (format <= 0x7f || (format >= 0xcc && format <= 0xcf))
+        {
+          type = msgpack::type::POSITIVE_INTEGER;
+        }
+        else if (format >= 0xe0 || (format >= 0xd0 && format <= 0xd3))
+        {
+          type = msgpack::type::NEGATIVE_INTEGER;
+        }
+        else if (format <= 0x8f || format == 0xde || format == 0xdf)
+        {
+          type = msgpack::type::MAP;
+        }
+        else if (format <= 0x9f || format == 0xdc || format == 0xdd)
+        {
+          type = msgpack::type::ARRAY;
+        }
+        else if (format <= 0xbf || (format >= 0xd9 && format <= 0xdb))
+        {
+          type = msgpack::type::STR;
+        }
+        else if (format == 0xc0)
+        {
+          type = msgpack::type::NIL;
+        }
+        else if (format == 0xc2 || format == 0xc3)
+        {
+          type = msgpack::type::BOOLEAN;
+        }
+        else if (format >= 0xc4 && format <= 0xc6)
+        {
+          type = msgpack::type::BIN;
+        }
+        else if (format == 0xca)
+        {
+          type = msgpack::type::FLOAT32;
+        }
+        else if (format == 0xcb)
+        {
+          type = msgpack::type::FLOAT64;
+        }
+        types[format] = format == 0xc1 ? invalid_format : static_cast<uint8_t>(type);
+      }
+      return types;
+    }
+
+    constexpr std::array<uint8_t, 256> format_types = make_format_types();
+
+    // a big-endian 64 bit value, a single load and byte swap on little-endian hosts
+    inline uint64_t load_big_endian64(const uint8_t* data)
+    {
+      uint64_t value;
+      std::memcpy(&value, data, sizeof(value));
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+      return __builtin_bswap64(value);
+#elif defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+      return value;
+#else
+      value = 0;
+      for (std::size_t ii = 0; ii < 8; ++ii)
+      {
+        value = (value << 8) | data[ii];
+      }
+      return value;
+#endif
+    }
+
+    template <typename T>
+    T load_big_endian(const uint8_t* data)
+    {
+      uint64_t value = 0;
+      for (std::size_t ii = 0; ii < sizeof(T); ++ii)
+      {
+        value = (value << 8) | data[ii];
+      }
+      using bits_t = std::conditional_t<sizeof(T) == 1, uint8_t,
+        std::conditional_t<sizeof(T) == 2, uint16_t, std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>>;
+      const bits_t bits = static_cast<bits_t>(value);
+      T result;
+      std::memcpy(&result, &bits, sizeof(T));
+      return result;
+    }
+  }
+
+  uint8_t MessageReader::next_byte() const
+  {
+    if (m_position == m_end)
+    {
+      throw msgpack::insufficient_bytes("insufficient bytes");
+    }
+    return static_cast<uint8_t>(*m_position);
+  }
+
+  const char* MessageReader::take(std::size_t size)
+  {
+    if (size > remaining())
+    {
+      throw msgpack::insufficient_bytes("insufficient bytes");
+    }
+    const char* data = m_position;
+    m_position += size;
+    return data;
+  }
+
+  // MessagePack is big-endian
+  template <typename T>
+  T MessageReader::load()
+  {
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(take(sizeof(T)));
+    uint64_t value = 0;
+    for (std::size_t ii = 0; ii < sizeof(T); ++ii)
+    {
+      value = (value << 8) | data[ii];
+    }
+    T result;
+    if constexpr (sizeof(T) == 1)
+    {
+      result = static_cast<T>(value);
+    }
+    else
+    {
+      using bits_t = std::conditional_t<sizeof(T) == 2, uint16_t, std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>;
+      bits_t bits = static_cast<bits_t>(value);
+      std::memcpy(&result, &bits, sizeof(T));
+    }
+    return result;
+  }
+
+  std::size_t MessageReader::read_length(uint8_t format)
+  {
+    switch (format)
+    {
+      case 0xc4: // bin 8
+      case 0xd9: // str 8
+      return load<uint8_t>();
+      case 0xc5: // bin 16
+      case 0xda: // str 16
+      return load<uint16_t>();
+      case 0xc6: // bin 32
+      case 0xdb: // str 32
+      return load<uint32_t>();
+      case 0xc7: // ext 8
+      return std::size_t(load<uint8_t>()) + 1;
+      case 0xc8: // ext 16
+      return std::size_t(load<uint16_t>()) + 1;
+      case 0xc9: // ext 32
+      return std::size_t(load<uint32_t>()) + 1;
+      case 0xd4: // fixext 1
+      return 2;
+      case 0xd5: // fixext 2
+      return 3;
+      case 0xd6: // fixext 4
+      return 5;
+      case 0xd7: // fixext 8
+      return 9;
+      case 0xd8: // fixext 16
+      return 17;
+      default:
+      if ((format & 0xe0) == 0xa0) // fixstr
+      {
+        return format & 0x1f;
+      }
+      throw msgpack::type_error();
+    }
+  }
+
+  msgpack::type::object_type MessageReader::next_type() const
+  {
+    uint8_t format = next_byte();
+    uint8_t type = format_types[format];
+    if (type == invalid_format)
+    {
+      throw msgpack::parse_error("parse error");
+    }
+    // a signed format can still hold a non-negative value, msgpack::object reports those as positive
+    if (format >= 0xd0 && format <= 0xd3 && remaining() > 1 && (static_cast<uint8_t>(m_position[1]) & 0x80) == 0)
+    {
+      return msgpack::type::POSITIVE_INTEGER;
+    }
+    return static_cast<msgpack::type::object_type>(type);
+  }
+
+  void MessageReader::read_nil()
+  {
+    if (next_byte() != 0xc0)
+    {
+      throw msgpack::type_error();
+    }
+    ++m_position;
+  }
+
+  bool MessageReader::try_read_nil()
+  {
+    if (next_byte() != 0xc0)
+    {
+      return false;
+    }
+    ++m_position;
+    return true;
+  }
+
+  bool MessageReader::read_bool()
+  {
+    uint8_t format = next_byte();
+    if (format != 0xc2 && format != 0xc3)
+    {
+      throw msgpack::type_error();
+    }
+    ++m_position;
+    return format == 0xc3;
+  }
+
+  int64_t MessageReader::read_int64()
+  {
+    uint8_t format = next_byte();
+    if (format <= 0x7f || format >= 0xe0)
+    {
+      ++m_position;
+      return static_cast<int8_t>(format);
+    }
+    switch (format)
+    {
+      case 0xcc:
+      case 0xcd:
+      case 0xce:
+      case 0xcf:
+      {
+        uint64_t value = read_uint64();
+        if (value > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()))
+        {
+          throw msgpack::type_error();
+        }
+        return static_cast<int64_t>(value);
+      }
+      case 0xd0:
+      ++m_position;
+      return load<int8_t>();
+      case 0xd1:
+      ++m_position;
+      return load<int16_t>();
+      case 0xd2:
+      ++m_position;
+      return load<int32_t>();
+      case 0xd3:
+      ++m_position;
+      return load<int64_t>();
+      default:
+      throw msgpack::type_error();
+    }
+  }
+
+  uint64_t MessageReader::read_uint64()
+  {
+    uint8_t format = next_byte();
+    if (format <= 0x7f)
+    {
+      ++m_position;
+      return format;
+    }
+    switch (format)
+    {
+      case 0xcc:
+      ++m_position;
+      return load<uint8_t>();
+      case 0xcd:
+      ++m_position;
+      return load<uint16_t>();
+      case 0xce:
+      ++m_position;
+      return load<uint32_t>();
+      case 0xcf:
+      ++m_position;
+      return load<uint64_t>();
+      default:
+      {
+        int64_t value = read_int64();
+        if (value < 0)
+        {
+          throw msgpack::type_error();
+        }
+        return static_cast<uint64_t>(value);
+      }
+    }
+  }
+
+  int32_t MessageReader::read_int32()
+  {
+    int64_t value = read_int64();
+    if (value < std::numeric_limits<int32_t>::min() || value > std::numeric_limits<int32_t>::max())
+    {
+      throw msgpack::type_error();
+    }
+    return static_cast<int32_t>(value);
+  }
+
+  double MessageReader::read_double()
+  {
+    switch (next_byte())
+    {
+      case 0xca:
+      ++m_position;
+      return load<float>();
+      case 0xcb:
+      ++m_position;
+      return load<double>();
+      default:
+      return next_type() == msgpack::type::POSITIVE_INTEGER ? static_cast<double>(read_uint64()) : static_cast<double>(read_int64());
+    }
+  }
+
+  // STR and BIN are interchangeable, just like with msgpack::object::as<std::string>()
+  std::string_view MessageReader::read_string_view()
+  {
+    uint8_t format = next_byte();
+    if ((format & 0xe0) != 0xa0 && !(format >= 0xd9 && format <= 0xdb) && !(format >= 0xc4 && format <= 0xc6))
+    {
+      throw msgpack::type_error();
+    }
+    ++m_position;
+    std::size_t size = read_length(format);
+    return std::string_view(take(size), size);
+  }
+
+  byte_view MessageReader::read_binary_view()
+  {
+    std::string_view data = read_string_view();
+    return byte_view{reinterpret_cast<const uint8_t*>(data.data()), data.size()};
+  }
+
+  uint32_t MessageReader::read_array_header()
+  {
+    uint8_t format = next_byte();
+    if ((format & 0xf0) == 0x90)
+    {
+      ++m_position;
+      return format & 0x0f;
+    }
+    if (format == 0xdc)
+    {
+      ++m_position;
+      return load<uint16_t>();
+    }
+    if (format == 0xdd)
+    {
+      ++m_position;
+      return load<uint32_t>();
+    }
+    throw msgpack::type_error();
+  }
+
+  bool MessageReader::read_doubles(uint32_t count, std::vector<double>& out)
+  {
+    // every float64 is the format byte 0xcb and 8 bytes, the formats are checked before anything is converted
+    constexpr std::size_t stride = 9;
+    const std::size_t size = std::size_t(count) * stride;
+    if (size > remaining())
+    {
+      return false;
+    }
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(m_position);
+    for (std::size_t ii = 0; ii < size; ii += stride)
+    {
+      if (data[ii] != 0xcb)
+      {
+        return false;
+      }
+    }
+    out.resize(count);
+    double* values = out.data();
+    for (uint32_t ii = 0; ii < count; ++ii)
+    {
+      const uint64_t bits = load_big_endian64(data + std::size_t(ii) * stride + 1);
+      std::memcpy(values + ii, &bits, sizeof(double));
+    }
+    m_position += size;
+    return true;
+  }
+
+  bool MessageReader::read_integers(uint32_t count, std::vector<int64_t>& out)
+  {
+    // every element takes a byte at least, a longer array can not be in the buffer
+    if (count > remaining())
+    {
+      return false;
+    }
+    const uint8_t* begin = reinterpret_cast<const uint8_t*>(m_position);
+    const uint8_t* end = reinterpret_cast<const uint8_t*>(m_end);
+    // the formats and the lengths are checked before out is touched
+    const uint8_t* position = begin;
+    for (uint32_t ii = 0; ii < count; ++ii)
+    {
+      if (position == end)
+      {
+        return false;
+      }
+      const uint8_t format = *position++;
+      if (format <= 0x7f || format >= 0xe0)
+      {
+        continue;
+      }
+      // the integer formats 0xcc-0xcf (unsigned) and 0xd0-0xd3 (signed) hold 1, 2, 4 or 8 bytes
+      if (format < 0xcc || format > 0xd3)
+      {
+        return false;
+      }
+      const std::size_t width = std::size_t(1) << (format & 0x03);
+      if (static_cast<std::size_t>(end - position) < width)
+      {
+        return false;
+      }
+      if (format == 0xcf && load_big_endian64(position) > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()))
+      {
+        return false;
+      }
+      position += width;
+    }
+
+    out.resize(count);
+    position = begin;
+    for (int64_t& value : out)
+    {
+      const uint8_t format = *position++;
+      if (format <= 0x7f || format >= 0xe0)
+      {
+        value = static_cast<int8_t>(format);
+        continue;
+      }
+      switch (format)
+      {
+        case 0xcc: value = load_big_endian<uint8_t>(position); break;
+        case 0xcd: value = load_big_endian<uint16_t>(position); break;
+        case 0xce: value = load_big_endian<uint32_t>(position); break;
+        case 0xcf: value = static_cast<int64_t>(load_big_endian64(position)); break;
+        case 0xd0: value = load_big_endian<int8_t>(position); break;
+        case 0xd1: value = load_big_endian<int16_t>(position); break;
+        case 0xd2: value = load_big_endian<int32_t>(position); break;
+        default: value = static_cast<int64_t>(load_big_endian64(position)); break;
+      }
+      position += std::size_t(1) << (format & 0x03);
+    }
+    m_position = reinterpret_cast<const char*>(position);
+    return true;
+  }
+
+  uint32_t MessageReader::read_map_header()
+  {
+    uint8_t format = next_byte();
+    if ((format & 0xf0) == 0x80)
+    {
+      ++m_position;
+      return format & 0x0f;
+    }
+    if (format == 0xde)
+    {
+      ++m_position;
+      return load<uint16_t>();
+    }
+    if (format == 0xdf)
+    {
+      ++m_position;
+      return load<uint32_t>();
+    }
+    throw msgpack::type_error();
+  }
+
+  void MessageReader::skip()
+  {
+    // the number of values still to be skipped, the elements of arrays and maps are added to it
+    uint64_t pending = 1;
+    while (pending > 0)
+    {
+      --pending;
+      switch (next_type())
+      {
+        case msgpack::type::NIL:
+        case msgpack::type::BOOLEAN:
+        ++m_position;
+        break;
+        case msgpack::type::POSITIVE_INTEGER:
+        case msgpack::type::NEGATIVE_INTEGER:
+        {
+          uint8_t format = next_byte();
+          if (format >= 0xcc && format <= 0xcf)
+          {
+            read_uint64();
+          }
+          else
+          {
+            read_int64();
+          }
+        }
+        break;
+        case msgpack::type::FLOAT32:
+        case msgpack::type::FLOAT64:
+        read_double();
+        break;
+        case msgpack::type::ARRAY:
+        pending += read_array_header();
+        break;
+        case msgpack::type::MAP:
+        pending += uint64_t(read_map_header()) * 2;
+        break;
+        default:
+        {
+          // STR, BIN and EXT
+          uint8_t format = static_cast<uint8_t>(*m_position++);
+          take(read_length(format));
+        }
+        break;
+      }
+    }
+  }
+
+  std::string_view MessageReader::read_raw()
+  {
+    const char* begin = m_position;
+    skip();
+    return std::string_view(begin, static_cast<std::size_t>(m_position - begin));
+  }
+
+  msgpack::object_handle MessageReader::read_object()
+  {
+    std::size_t offset = 0;
+    msgpack::object_handle handle = msgpack::unpack(m_position, remaining(), offset);
+    m_position += offset;
+    return handle;
+  }
+
+} // namespace gds_types
+} // namespace gds_lib
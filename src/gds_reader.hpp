@@ -0,0 +1,82 @@
+#ifndef GDS_READER_HPP
+#define GDS_READER_HPP
+
+#include "gds_types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <msgpack.hpp>
+
+namespace gds_lib {
+namespace gds_types {
+
+    /**
+ * Pull decoder over packed MessagePack bytes. The values are read in order, straight from the buffer,
+ * without unpacking them into a msgpack::object tree first.
+ * Reading a value of a different type throws msgpack::type_error, running out of bytes throws msgpack::insufficient_bytes.
+ */
+    class MessageReader {
+        const char* m_begin;
+        const char* m_position;
+        const char* m_end;
+
+        uint8_t next_byte() const;
+        const char* take(std::size_t size);
+        template <typename T>
+        T load();
+        // the length of a STR, BIN or EXT (EXT with the type byte) value, the header is consumed
+        std::size_t read_length(uint8_t format);
+
+    public:
+        MessageReader(const char* data, std::size_t size) noexcept
+            : m_begin(data),
+              m_position(data),
+              m_end(data + size)
+        {
+        }
+
+        std::size_t position() const noexcept { return static_cast<std::size_t>(m_position - m_begin); }
+        std::size_t remaining() const noexcept { return static_cast<std::size_t>(m_end - m_position); }
+        bool at_end() const noexcept { return m_position == m_end; }
+
+        // the type of the next value, without reading it
+        msgpack::type::object_type next_type() const;
+        bool next_is_nil() const { return next_type() == msgpack::type::NIL; }
+
+        void read_nil();
+        // reads the next value if it is nil
+        bool try_read_nil();
+        bool read_bool();
+        int64_t read_int64();
+        uint64_t read_uint64();
+        int32_t read_int32();
+        // integers are converted, just like msgpack::object::as<double>()
+        double read_double();
+        // the strings and binaries point into the buffer, they are valid as long as the buffer is
+        std::string_view read_string_view();
+        std::string read_string() { return std::string(read_string_view()); }
+        byte_view read_binary_view();
+        // the number of elements of the array (or pairs of the map), the elements have to be read after this
+        uint32_t read_array_header();
+        uint32_t read_map_header();
+        // reads the next count values into out if all of them are float64 (or integers that fit into int64_t),
+        // returns false and reads nothing otherwise. The elements of the numeric arrays are converted in a single loop
+        bool read_doubles(uint32_t count, std::vector<double>& out);
+        bool read_integers(uint32_t count, std::vector<int64_t>& out);
+
+        // skips the next value, including its elements
+        void skip();
+        // skips the next value and returns its packed bytes (that point into the buffer)
+        std::string_view read_raw();
+        // unpacks the next value into an object (strings and binaries are copied to its zone)
+        msgpack::object_handle read_object();
+    };
+
+} // namespace gds_types
+} // namespace gds_lib
+
+#endif // GDS_READER_HPP
@@ -0,0 +1,183 @@
+#ifndef GDS_RECORDS_HPP
+#define GDS_RECORDS_HPP
+
+#include "gds_views.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <msgpack.hpp>
+
+namespace gds_lib {
+namespace gds_types {
+
+    /**
+ * A member of a record type bound to the name of a GDS field.
+ */
+    template <typename Record, typename Member>
+    struct record_field {
+        std::string_view name;
+        Member Record::*member;
+    };
+
+    template <typename Record, typename Member>
+    constexpr record_field<Record, Member> bind_field(std::string_view name, Member Record::*member)
+    {
+        return record_field<Record, Member>{ name, member };
+    }
+
+    /**
+ * The compile-time field list of a record type, specialized for the records of the application:
+ *
+ *   template <>
+ *   struct record_binding<MyRow> {
+ *       static constexpr auto fields = std::make_tuple(bind_field("id", &MyRow::id), bind_field("speed", &MyRow::speed));
+ *   };
+ */
+    template <typename Record>
+    struct record_binding;
+
+    // a nil cell leaves the member as it is, std::optional members are reset by it
+    template <typename T>
+    void read_cell(const msgpack::object& cell, T& value)
+    {
+        if (!cell.is_nil()) {
+            cell.convert(value);
+        }
+    }
+
+    template <typename T>
+    void read_cell(const msgpack::object& cell, std::optional<T>& value)
+    {
+        if (cell.is_nil()) {
+            value.reset();
+        } else {
+            read_cell(cell, value.emplace());
+        }
+    }
+
+    inline void read_cell(const msgpack::object& cell, byte_view& value)
+    {
+        if (cell.is_nil()) {
+            return;
+        }
+        if (cell.type != msgpack::type::BIN && cell.type != msgpack::type::STR) {
+            throw msgpack::type_error();
+        }
+        value = byte_view{ reinterpret_cast<const uint8_t*>(cell.via.bin.ptr), cell.via.bin.size };
+    }
+
+    inline void read_cell(const msgpack::object& cell, GdsFieldValue& value)
+    {
+        value.unpack(cell);
+    }
+
+    /**
+ * Decodes rows into a record type. The columns of the bound fields are looked up by their names once,
+ * when the binder is created for a page, the rows are then converted without any lookup or boxing.
+ * std::string_view and byte_view members point into the received buffer, just like the views do.
+ */
+    template <typename Record>
+    class RecordBinder {
+        using fields_t = std::decay_t<decltype(record_binding<Record>::fields)>;
+        using setter_t = void (*)(Record&, const msgpack::object&);
+        static constexpr std::size_t FIELD_COUNT = std::tuple_size_v<fields_t>;
+
+        struct column {
+            std::size_t index;
+            setter_t set;
+        };
+        std::array<column, FIELD_COUNT> m_columns;
+        std::size_t m_width = 0; // the rows have to have at least this many values
+
+        template <std::size_t I>
+        static void set_field(Record& record, const msgpack::object& cell)
+        {
+            constexpr auto field = std::get<I>(record_binding<Record>::fields);
+            read_cell(cell, record.*(field.member));
+        }
+
+        template <typename NameAt, std::size_t... I>
+        void resolve(std::size_t count, NameAt name_at, GdsMsgType::Enum type, std::index_sequence<I...>)
+        {
+            constexpr std::array<std::string_view, FIELD_COUNT> names{ std::get<I>(record_binding<Record>::fields).name... };
+            constexpr std::array<setter_t, FIELD_COUNT> setters{ &set_field<I>... };
+            for (std::size_t ff = 0; ff < FIELD_COUNT; ++ff) {
+                std::size_t index = 0;
+                while (index < count && name_at(index) != names[ff]) {
+                    ++index;
+                }
+                if (index == count) {
+                    throw invalid_message_error(type, "the message has no field named " + std::string(names[ff]));
+                }
+                m_columns[ff] = column{ index, setters[ff] };
+                m_width = std::max(m_width, index + 1);
+            }
+        }
+
+        template <typename View>
+        void resolve(const View& view)
+        {
+            resolve(
+                view.fieldCount(), [&view](std::size_t index) { return view.fieldDescriptor(index)[0]; }, View::TYPE,
+                std::make_index_sequence<FIELD_COUNT>{});
+        }
+
+    public:
+        explicit RecordBinder(const QueryReplyView& reply) { resolve(reply); }
+        explicit RecordBinder(const EventDocumentView& document) { resolve(document); }
+
+        // the columns that are not bound are skipped, throws invalid_message_error if the row is too short
+        void bind(const RowView& row, Record& record) const
+        {
+            if (row.size() < m_width) {
+                throw invalid_message_error(GdsMsgType::UNKNOWN, "the row has fewer values than the field descriptors");
+            }
+            for (const column& item : m_columns) {
+                item.set(record, row[item.index].object());
+            }
+        }
+
+        Record bind(const RowView& row) const
+        {
+            Record record{};
+            bind(row, record);
+            return record;
+        }
+    };
+
+    // all hits of the page as records
+    template <typename Record>
+    std::vector<Record> bind_records(const QueryReplyView& reply)
+    {
+        RecordBinder<Record> binder(reply);
+        std::vector<Record> records(reply.hitCount());
+        for (std::size_t ii = 0; ii < records.size(); ++ii) {
+            binder.bind(reply.hit(ii), records[ii]);
+        }
+        return records;
+    }
+
+    // all records of the event document
+    template <typename Record>
+    std::vector<Record> bind_records(const EventDocumentView& document)
+    {
+        RecordBinder<Record> binder(document);
+        std::vector<Record> records(document.recordCount());
+        for (std::size_t ii = 0; ii < records.size(); ++ii) {
+            binder.bind(document.record(ii), records[ii]);
+        }
+        return records;
+    }
+
+} // namespace gds_types
+} // namespace gds_lib
+
+#endif // GDS_RECORDS_HPP
@@ -0,0 +1,584 @@
+#ifndef GDS_SCHEMA_HPP
+#define GDS_SCHEMA_HPP
+
+#include "gds_reader.hpp"
+#include "gds_types.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <msgpack.hpp>
+
+namespace gds_lib {
+namespace gds_types {
+
+    /**
+ * How the fields of a message are packed
+ */
+    struct SchemaLayout {
+        enum Enum {
+            ARRAY, // the fields in their order, an absent optional field is nil
+            MAP // the fields by their names, an absent optional field is left out
+        };
+    };
+
+    /**
+ * A member of a message type declared in its schema.
+ */
+    template <typename Message, typename Member>
+    struct message_field {
+        std::string_view name;
+        Member Message::*member;
+    };
+
+    template <typename Message, typename Member>
+    constexpr message_field<Message, Member> declare_field(std::string_view name, Member Message::*member)
+    {
+        return message_field<Message, Member>{ name, member };
+    }
+
+    /**
+ * The declarative schema of a message type, the list of its fields in the order they are packed:
+ *
+ *   template <>
+ *   struct message_schema<MyBody> {
+ *       static constexpr SchemaLayout::Enum layout = SchemaLayout::ARRAY;
+ *       static constexpr GdsMsgType::Enum type = GdsMsgType::EVENT; // reported by the decoding errors
+ *       static constexpr auto fields = std::make_tuple(declare_field("status", &MyBody::status), declare_field("result", &MyBody::result));
+ *   };
+ *
+ * The SchemaCodec generates the pack, unpack and read code of the type from this table at compile time, so the fields
+ * cannot differ between the directions. The members are packed by their static types (int32_t as int32, int64_t as int64,
+ * std::optional as nil or the value), the nested types with a schema of their own are packed by their codec,
+ * the other Packable types by their (non-virtual) pack and unpack methods.
+ * The message types with a plain layout have their schemas at the end of this header.
+ */
+    template <typename Message>
+    struct message_schema;
+
+    template <typename Message, typename = void>
+    struct has_message_schema : std::false_type {
+    };
+    template <typename Message>
+    struct has_message_schema<Message, std::void_t<decltype(message_schema<Message>::fields)> > : std::true_type {
+    };
+    template <typename Message>
+    inline constexpr bool has_message_schema_v = has_message_schema<Message>::value;
+
+    template <typename Message>
+    class SchemaCodec;
+
+    namespace schema_detail {
+        template <typename T>
+        struct optional_traits {
+            static constexpr bool is_optional = false;
+        };
+        template <typename T>
+        struct optional_traits<std::optional<T> > {
+            static constexpr bool is_optional = true;
+        };
+
+        template <typename T>
+        struct container_traits {
+            static constexpr bool is_vector = false;
+            static constexpr bool is_flat_map = false;
+        };
+        template <typename T, typename A>
+        struct container_traits<std::vector<T, A> > {
+            static constexpr bool is_vector = !std::is_same_v<T, uint8_t>;
+            static constexpr bool is_flat_map = false;
+        };
+        template <typename K, typename V>
+        struct container_traits<flat_map<K, V> > {
+            static constexpr bool is_vector = false;
+            static constexpr bool is_flat_map = true;
+        };
+
+        template <typename Stream, typename T>
+        void pack_value(BasicPacker<Stream>& packer, const T& value)
+        {
+            if constexpr (has_message_schema_v<T>) {
+                SchemaCodec<T>::pack(value, packer);
+            } else if constexpr (std::is_base_of_v<Packable, T>) {
+                if constexpr (std::is_same_v<Stream, PackBuffer>) {
+                    value.T::pack(packer);
+                } else {
+                    // a nested Packable packs into a PackBuffer, that writes into the stream of the packer
+                    PackBufferAdapter<Stream> buffer(packer.stream());
+                    Packer nested(buffer, packer.options());
+                    value.T::pack(nested);
+                }
+            } else if constexpr (std::is_same_v<T, bool>) {
+                value ? packer.pack_true() : packer.pack_false();
+            } else if constexpr (std::is_same_v<T, int32_t>) {
+                packer.pack_int32(value);
+            } else if constexpr (std::is_same_v<T, int64_t>) {
+                packer.pack_int64(value);
+            } else {
+                packer.pack(value);
+            }
+        }
+
+        // the number of bytes pack_value() writes
+        template <typename T>
+        std::size_t value_size(const T& value)
+        {
+            if constexpr (has_message_schema_v<T>) {
+                return SchemaCodec<T>::encoded_size(value);
+            } else if constexpr (std::is_base_of_v<Packable, T>) {
+                return value.T::encoded_size();
+            } else if constexpr (std::is_same_v<T, bool>) {
+                return packed_size::boolean();
+            } else if constexpr (std::is_same_v<T, int32_t> || std::is_same_v<T, int64_t>) {
+                return packed_size::int64(value);
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                return packed_size::str(value.size());
+            } else if constexpr (std::is_same_v<T, byte_array>) {
+                return packed_size::bin(value.size());
+            } else if constexpr (container_traits<T>::is_vector) {
+                std::size_t size = packed_size::array_header(value.size());
+                for (const auto& item : value) {
+                    size += value_size(item);
+                }
+                return size;
+            } else if constexpr (container_traits<T>::is_flat_map) {
+                std::size_t size = packed_size::map_header(value.size());
+                for (const auto& item : value) {
+                    size += value_size(item.first) + value_size(item.second);
+                }
+                return size;
+            } else {
+                // the other values are packed into a counter
+                CountingPackBuffer counter;
+                msgpack::packer<CountingPackBuffer>(counter).pack(value);
+                return counter.size();
+            }
+        }
+
+        template <typename T>
+        void unpack_value(const msgpack::object& object, const DecodeOptions& options, T& value)
+        {
+            if constexpr (has_message_schema_v<T>) {
+                SchemaCodec<T>::unpack(value, object, options);
+            } else if constexpr (std::is_base_of_v<Packable, T>) {
+                // through the Packable, the types that ignore the options do not declare this overload
+                static_cast<Packable&>(value).unpack(object, options);
+            } else {
+                object.convert(value);
+            }
+        }
+
+        template <typename T>
+        void read_value(MessageReader& reader, const DecodeOptions& options, T& value)
+        {
+            if constexpr (has_message_schema_v<T>) {
+                SchemaCodec<T>::read(value, reader, options);
+            } else if constexpr (std::is_base_of_v<Packable, T>) {
+                value.T::read(reader, options);
+            } else if constexpr (std::is_same_v<T, bool>) {
+                value = reader.read_bool();
+            } else if constexpr (std::is_same_v<T, int32_t>) {
+                value = reader.read_int32();
+            } else if constexpr (std::is_same_v<T, int64_t>) {
+                value = reader.read_int64();
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                value.assign(reader.read_string_view());
+            } else if constexpr (std::is_same_v<T, byte_array>) {
+                const byte_view bytes = reader.read_binary_view();
+                value.assign(bytes.begin(), bytes.end());
+            } else if constexpr (container_traits<T>::is_vector) {
+                // every item takes a byte at least, a corrupt count does not allocate more than the message
+                const uint32_t count = reader.read_array_header();
+                value.clear();
+                value.reserve(std::min<std::size_t>(count, reader.remaining()));
+                for (uint32_t ii = 0; ii < count; ++ii) {
+                    read_value(reader, options, value.emplace_back());
+                }
+            } else if constexpr (container_traits<T>::is_flat_map) {
+                // the entries are appended in the order they are read, the map is sorted once at the end
+                const uint32_t count = reader.read_map_header();
+                value.clear();
+                value.reserve(std::min<std::size_t>(count, reader.remaining() / 2));
+                for (uint32_t ii = 0; ii < count; ++ii) {
+                    auto& item = value.append();
+                    read_value(reader, options, item.first);
+                    read_value(reader, options, item.second);
+                }
+                value.sort();
+            } else {
+                // the other values are converted through an object
+                msgpack::object_handle handle = reader.read_object();
+                handle.get().convert(value);
+            }
+        }
+    } // namespace schema_detail
+
+    /**
+ * The codec of a message type generated from its message_schema. The methods are not virtual and can be inlined,
+ * the packing can write into any buffer (a msgpack::sbuffer without the PackBuffer indirection for example).
+ * The Packable methods of the types with a schema forward to this.
+ */
+    template <typename Message>
+    class SchemaCodec {
+        using schema = message_schema<Message>;
+        using fields_t = std::decay_t<decltype(schema::fields)>;
+        static constexpr std::size_t FIELD_COUNT = std::tuple_size_v<fields_t>;
+        static constexpr bool IS_MAP = schema::layout == SchemaLayout::MAP;
+
+        template <std::size_t I>
+        using member_t = std::decay_t<decltype(std::declval<Message&>().*(std::get<I>(schema::fields).member))>;
+
+        template <std::size_t I>
+        static constexpr bool is_optional() { return schema_detail::optional_traits<member_t<I> >::is_optional; }
+
+        template <std::size_t I>
+        static auto& member(Message& message) { return message.*(std::get<I>(schema::fields).member); }
+        template <std::size_t I>
+        static const auto& member(const Message& message) { return message.*(std::get<I>(schema::fields).member); }
+
+        // 1 if the field is packed, an absent optional field is left out of a MAP
+        template <std::size_t I>
+        static std::size_t packed_count(const Message& message)
+        {
+            if constexpr (is_optional<I>()) {
+                return member<I>(message).has_value() ? 1 : 0;
+            } else {
+                return 1;
+            }
+        }
+
+        template <typename Stream>
+        static void pack_name(BasicPacker<Stream>& packer, std::string_view name)
+        {
+            packer.pack_str(static_cast<uint32_t>(name.size()));
+            packer.pack_str_body(name.data(), static_cast<uint32_t>(name.size()));
+        }
+
+        template <std::size_t I, typename Stream>
+        static void pack_field(const Message& message, BasicPacker<Stream>& packer)
+        {
+            const auto& value = member<I>(message);
+            if constexpr (is_optional<I>()) {
+                if (value) {
+                    if constexpr (IS_MAP) {
+                        pack_name(packer, std::get<I>(schema::fields).name);
+                    }
+                    schema_detail::pack_value(packer, *value);
+                } else if constexpr (!IS_MAP) {
+                    packer.pack_nil();
+                }
+            } else {
+                if constexpr (IS_MAP) {
+                    pack_name(packer, std::get<I>(schema::fields).name);
+                }
+                schema_detail::pack_value(packer, value);
+            }
+        }
+
+        template <std::size_t I>
+        static std::size_t field_size(const Message& message)
+        {
+            const auto& value = member<I>(message);
+            const std::size_t name_size = IS_MAP ? packed_size::str(std::get<I>(schema::fields).name.size()) : 0;
+            if constexpr (is_optional<I>()) {
+                if (!value) {
+                    return IS_MAP ? 0 : packed_size::nil();
+                }
+                return name_size + schema_detail::value_size(*value);
+            } else {
+                return name_size + schema_detail::value_size(value);
+            }
+        }
+
+        template <std::size_t I>
+        static void unpack_field(Message& message, const msgpack::object* object, const DecodeOptions& options)
+        {
+            auto& value = member<I>(message);
+            if constexpr (is_optional<I>()) {
+                if (!object || object->is_nil()) {
+                    value.reset();
+                    return;
+                }
+                if (!value) {
+                    value.emplace();
+                }
+                schema_detail::unpack_value(*object, options, *value);
+            } else {
+                if (!object) {
+                    throw invalid_message_error(schema::type, "the message has no field named " + std::string(std::get<I>(schema::fields).name));
+                }
+                schema_detail::unpack_value(*object, options, value);
+            }
+        }
+
+        template <std::size_t I>
+        static void read_field(Message& message, MessageReader& reader, const DecodeOptions& options)
+        {
+            auto& value = member<I>(message);
+            if constexpr (is_optional<I>()) {
+                if (reader.try_read_nil()) {
+                    value.reset();
+                    return;
+                }
+                if (!value) {
+                    value.emplace();
+                }
+                schema_detail::read_value(reader, options, *value);
+            } else {
+                schema_detail::read_value(reader, options, value);
+            }
+        }
+
+        template <std::size_t I>
+        static void missing_field(Message& message, bool found)
+        {
+            if (found) {
+                return;
+            }
+            if constexpr (is_optional<I>()) {
+                member<I>(message).reset();
+            } else {
+                throw invalid_message_error(schema::type, "the message has no field named " + std::string(std::get<I>(schema::fields).name));
+            }
+        }
+
+        // the value of the key in a MAP object, nullptr if the key is not in it
+        static const msgpack::object* find(const msgpack::object& object, std::string_view name)
+        {
+            for (uint32_t ii = 0; ii < object.via.map.size; ++ii) {
+                const msgpack::object& key = object.via.map.ptr[ii].key;
+                if (key.type != msgpack::type::STR) {
+                    throw msgpack::type_error();
+                }
+                if (name == std::string_view(key.via.str.ptr, key.via.str.size)) {
+                    return &object.via.map.ptr[ii].val;
+                }
+            }
+            return nullptr;
+        }
+
+        template <typename Stream, std::size_t... I>
+        static void pack_fields(const Message& message, BasicPacker<Stream>& packer, std::index_sequence<I...>)
+        {
+            if constexpr (IS_MAP) {
+                packer.pack_map(static_cast<uint32_t>((packed_count<I>(message) + ... + 0)));
+            } else {
+                packer.pack_array(static_cast<uint32_t>(FIELD_COUNT));
+            }
+            (pack_field<I>(message, packer), ...);
+        }
+
+        template <std::size_t... I>
+        static std::size_t fields_size(const Message& message, std::index_sequence<I...>)
+        {
+            const std::size_t header = IS_MAP ? packed_size::map_header((packed_count<I>(message) + ... + 0)) : packed_size::array_header(FIELD_COUNT);
+            return (header + ... + field_size<I>(message));
+        }
+
+        template <std::size_t... I>
+        static void unpack_fields(Message& message, const msgpack::object& object, const DecodeOptions& options, std::index_sequence<I...>)
+        {
+            if constexpr (IS_MAP) {
+                (unpack_field<I>(message, find(object, std::get<I>(schema::fields).name), options), ...);
+            } else {
+                (unpack_field<I>(message, object.via.array.ptr + I, options), ...);
+            }
+        }
+
+        template <std::size_t... I>
+        static void read_fields(Message& message, MessageReader& reader, const DecodeOptions& options, std::index_sequence<I...>)
+        {
+            if constexpr (IS_MAP) {
+                const uint32_t size = reader.read_map_header();
+                std::array<bool, FIELD_COUNT> found{};
+                for (uint32_t ii = 0; ii < size; ++ii) {
+                    const std::string_view name = reader.read_string_view();
+                    // the field of the name is read, the unknown names are skipped
+                    const bool known = ((name == std::get<I>(schema::fields).name ? (read_field<I>(message, reader, options), found[I] = true) : false) || ...);
+                    if (!known) {
+                        reader.skip();
+                    }
+                }
+                (missing_field<I>(message, found[I]), ...);
+            } else {
+                const uint32_t size = reader.read_array_header();
+                if (size < FIELD_COUNT) {
+                    throw invalid_message_error(schema::type, "the array has only " + std::to_string(size) + " elements");
+                }
+                (read_field<I>(message, reader, options), ...);
+                for (uint32_t ii = FIELD_COUNT; ii < size; ++ii) {
+                    reader.skip();
+                }
+            }
+        }
+
+        // the rules of the protocol are checked at the FULL level only
+        static void validate_rules(const Message& message, ValidationLevel::Enum level)
+        {
+            if (level == ValidationLevel::FULL) {
+                message.Message::validate();
+            }
+        }
+
+    public:
+        template <typename Stream>
+        static void pack(const Message& message, BasicPacker<Stream>& packer)
+        {
+            validate_rules(message, packer.options().validation);
+            pack_fields(message, packer, std::make_index_sequence<FIELD_COUNT>{});
+        }
+
+        // packs into any buffer with a write(const char*, size) member
+        template <typename Buffer>
+        static void pack_into(const Message& message, Buffer& buffer, const EncodeOptions& options = EncodeOptions{})
+        {
+            BasicPacker<Buffer> packer(buffer, options);
+            pack(message, packer);
+        }
+
+        // the number of bytes pack() writes, computed from the fields without packing or validating them
+        static std::size_t encoded_size(const Message& message)
+        {
+            return fields_size(message, std::make_index_sequence<FIELD_COUNT>{});
+        }
+
+        static void unpack(Message& message, const msgpack::object& object, const DecodeOptions& options = DecodeOptions{})
+        {
+            if constexpr (IS_MAP) {
+                if (object.type != msgpack::type::MAP) {
+                    throw msgpack::type_error();
+                }
+            } else {
+                if (object.type != msgpack::type::ARRAY) {
+                    throw msgpack::type_error();
+                }
+                if (object.via.array.size < FIELD_COUNT) {
+                    throw invalid_message_error(schema::type, "the array has only " + std::to_string(object.via.array.size) + " elements");
+                }
+            }
+            unpack_fields(message, object, options, std::make_index_sequence<FIELD_COUNT>{});
+            validate_rules(message, options.validation);
+        }
+
+        static void read(Message& message, MessageReader& reader, const DecodeOptions& options)
+        {
+            read_fields(message, reader, options, std::make_index_sequence<FIELD_COUNT>{});
+            validate_rules(message, options.validation);
+        }
+
+        // invokes the visitor with the name and the value of every field, in their order
+        template <typename Visitor>
+        static void visit(const Message& message, Visitor&& visitor)
+        {
+            std::apply([&message, &visitor](const auto&... field) { (visitor(field.name, message.*(field.member)), ...); }, schema::fields);
+        }
+    };
+
+    template <>
+    struct message_schema<AttachmentResult> {
+        static constexpr SchemaLayout::Enum layout = SchemaLayout::MAP;
+        static constexpr GdsMsgType::Enum type = GdsMsgType::ATTACHMENT;
+        static constexpr auto fields = std::make_tuple(
+            declare_field("requestids", &AttachmentResult::requestIDs),
+            declare_field("ownertable", &AttachmentResult::ownerTable),
+            declare_field("attachmentid", &AttachmentResult::attachmentID),
+            declare_field("ownerids", &AttachmentResult::ownerIDs),
+            declare_field("meta", &AttachmentResult::meta),
+            declare_field("ttl", &AttachmentResult::ttl),
+            declare_field("to_valid", &AttachmentResult::to_valid),
+            declare_field("attachment", &AttachmentResult::attachment));
+    };
+
+    template <>
+    struct message_schema<AttachmentRequestBody> {
+        static constexpr SchemaLayout::Enum layout = SchemaLayout::ARRAY;
+        static constexpr GdsMsgType::Enum type = GdsMsgType::ATTACHMENT_REQUEST_REPLY;
+        static constexpr auto fields = std::make_tuple(
+            declare_field("status", &AttachmentRequestBody::status),
+            declare_field("result", &AttachmentRequestBody::result),
+            declare_field("waitTime", &AttachmentRequestBody::waitTime));
+    };
+
+    template <>
+    struct message_schema<AttachmentResponse> {
+        static constexpr SchemaLayout::Enum layout = SchemaLayout::MAP;
+        static constexpr GdsMsgType::Enum type = GdsMsgType::ATTACHMENT_REPLY;
+        static constexpr auto fields = std::make_tuple(
+            declare_field("requestids", &AttachmentResponse::requestIDs),
+            declare_field("ownertable", &AttachmentResponse::ownerTable),
+            declare_field("attachmentid", &AttachmentResponse::attachmentID));
+    };
+
+    template <>
+    struct message_schema<AttachmentResponseBody> {
+        static constexpr SchemaLayout::Enum layout = SchemaLayout::ARRAY;
+        static constexpr GdsMsgType::Enum type = GdsMsgType::ATTACHMENT_REPLY;
+        static constexpr auto fields = std::make_tuple(
+            declare_field("status", &AttachmentResponseBody::status),
+            declare_field("result", &AttachmentResponseBody::result));
+    };
+
+    /*2*/
+    template <>
+    struct message_schema<GdsEventMessage> {
+        static constexpr SchemaLayout::Enum layout = SchemaLayout::ARRAY;
+        static constexpr GdsMsgType::Enum type = GdsMsgType::EVENT;
+        static constexpr auto fields = std::make_tuple(
+            declare_field("operations", &GdsEventMessage::operations),
+            declare_field("binaryContents", &GdsEventMessage::binaryContents),
+            declare_field("priorityLevels", &GdsEventMessage::priorityLevels));
+    };
+
+    /*5*/
+    template <>
+    struct message_schema<GdsAttachmentRequestReplyMessage> {
+        static constexpr SchemaLayout::Enum layout = SchemaLayout::ARRAY;
+        static constexpr GdsMsgType::Enum type = GdsMsgType::ATTACHMENT_REQUEST_REPLY;
+        static constexpr auto fields = std::make_tuple(
+            declare_field("ackStatus", &GdsAttachmentRequestReplyMessage::ackStatus),
+            declare_field("request", &GdsAttachmentRequestReplyMessage::request),
+            declare_field("ackException", &GdsAttachmentRequestReplyMessage::ackException));
+    };
+
+    /*6*/
+    template <>
+    struct message_schema<GdsAttachmentResponseMessage> {
+        static constexpr SchemaLayout::Enum layout = SchemaLayout::ARRAY;
+        static constexpr GdsMsgType::Enum type = GdsMsgType::ATTACHMENT;
+        static constexpr auto fields = std::make_tuple(
+            declare_field("result", &GdsAttachmentResponseMessage::result));
+    };
+
+    /*7*/
+    template <>
+    struct message_schema<GdsAttachmentResponseResultMessage> {
+        static constexpr SchemaLayout::Enum layout = SchemaLayout::ARRAY;
+        static constexpr GdsMsgType::Enum type = GdsMsgType::ATTACHMENT_REPLY;
+        static constexpr auto fields = std::make_tuple(
+            declare_field("ackStatus", &GdsAttachmentResponseResultMessage::ackStatus),
+            declare_field("response", &GdsAttachmentResponseResultMessage::response),
+            declare_field("ackException", &GdsAttachmentResponseResultMessage::ackException));
+    };
+
+    /*12*/
+    template <>
+    struct message_schema<GdsNextQueryRequestMessage> {
+        static constexpr SchemaLayout::Enum layout = SchemaLayout::ARRAY;
+        static constexpr GdsMsgType::Enum type = GdsMsgType::GET_NEXT_QUERY;
+        static constexpr auto fields = std::make_tuple(
+            declare_field("contextDescriptor", &GdsNextQueryRequestMessage::contextDescriptor),
+            declare_field("timeout", &GdsNextQueryRequestMessage::timeout));
+    };
+
+} // namespace gds_types
+} // namespace gds_lib
+
+#endif // GDS_SCHEMA_HPP
@@ -1,1660 +1,3436 @@
-#include "gds_types.hpp"
-
-#include <iostream>
-
-
-template <typename OStream>
-static OStream& operator<<(OStream& os, const gds_lib::gds_types::Stringable& str)
-{
-  os << str.to_string();
-  return os;
-}
-
-
-template <typename OStream, typename T>
-static OStream& operator<<(OStream& os, const std::optional<T>& opt)
-{
-  if(opt)
-  {
-    os << opt.value();
-  }
-  else
-  {
-    os << "null";
-  }
-  return os;
-}
-
-
-template <typename OStream, typename T>
-static OStream& operator<<(OStream& os, const std::vector<T>& items)
-{
-  os << '[';
-  auto it = items.begin();
-  if(it != items.end())
-  {
-    os  << '\n' << *it;
-    ++it;
-    while(it != items.end())
-    {
-      os << ", " << '\n' << *it;
-      ++it;
-    }
-  }
-  os << '\n' << ']';
-  return os;
-}
-
-
-
-template <typename OStream>
-static OStream& operator<<(OStream& os, const gds_lib::gds_types::byte_array& items)
-{
-  os << '<' << items.size() << " bytes>";
-  return os;
-}
-
-template <typename OStream, typename T, std::size_t N>
-static OStream& operator<<(OStream& os, const std::array<T, N>& array){
-  os << '[';
-  if(!array.empty())
-  {
-    os  << '\n' << array[0];
-    for(size_t ii = 1;ii<array.size();++ii)
-    {
-      os << ", "  << '\n' << array[ii];
-    }
-  }
-  os << '\n' << ']';
-  return os;
-}
-
-template <typename OStream, typename K, typename V>
-static OStream& operator<<(OStream& os, const std::map<K,V>& items)
-{
-  os << '{';
-  auto it = items.begin();
-  if(it != items.end())
-  {
-    os  << '\n' << it->first << ": " << it->second;
-    ++it;
-    while(it != items.end())
-    {
-      os << ", "  << '\n' << it->first << ": " << it->second;
-      ++it;
-    }
-  }
-  os << '\n' << '}';
-  return os;
-}
-
-
-
-namespace gds_lib {
-  namespace gds_types {
-
-    void GdsMessage::pack(msgpack::packer<msgpack::sbuffer> &packer) const {
-      validate();
-      packer.pack_array(11);
-      packer.pack(userName);
-      packer.pack(messageId);
-      packer.pack_int64(createTime);
-      packer.pack_int64(requestTime);
-      if (isFragmented) {
-        packer.pack_true();
-        packer.pack(firstFragment.value());
-        packer.pack(lastFragment.value());
-        packer.pack(offset.value());
-        packer.pack(fds.value());
-      } else {
-        packer.pack_false();
-    packer.pack_nil(); // first fragmented
-    packer.pack_nil(); // last fragmented
-    packer.pack_nil(); // offset
-    packer.pack_nil(); // full data size
-  }
-  packer.pack_int32(dataType); // datatype
-  if (messageBody) {
-    messageBody->pack(packer);
-  } else {
-    packer.pack_nil();
-  }
-}
-
-void GdsMessage::unpack(const msgpack::object &object) {
-  std::vector<msgpack::object> data = object.as<std::vector<msgpack::object>>();
-  userName = data.at(gds_types::GdsHeader::USER).as<std::string>();
-  messageId = data.at(gds_types::GdsHeader::ID).as<std::string>();
-  createTime = data.at(gds_types::GdsHeader::CREATE_TIME).as<int64_t>();
-  requestTime = data.at(gds_types::GdsHeader::REQUEST_TIME).as<int64_t>();
-  isFragmented = data.at(gds_types::GdsHeader::FRAGMENTED).as<bool>();
-  if (isFragmented) {
-    firstFragment =
-    data.at(gds_types::GdsHeader::FIRST_FRAGMENT).as<std::string>();
-    lastFragment =
-    data.at(gds_types::GdsHeader::LAST_FRAGMENT).as<std::string>();
-    offset = data.at(gds_types::GdsHeader::OFFSET).as<int32_t>();
-    fds = data.at(gds_types::GdsHeader::FULL_DATA_SIZE).as<int32_t>();
-  } else {
-    firstFragment.reset();
-    lastFragment.reset();
-    offset.reset();
-    fds.reset();
-  }
-  dataType = data.at(gds_types::GdsHeader::DATA_TYPE).as<int32_t>();
-
-  switch (dataType) {
-  case gds_types::GdsMsgType::LOGIN: // Type 0
-  messageBody = std::make_shared<GdsLoginMessage>();
-  break;
-  case gds_types::GdsMsgType::LOGIN_REPLY: // Type 1
-  messageBody = std::make_shared<GdsLoginReplyMessage>();
-  break;
-  case gds_types::GdsMsgType::EVENT: // Type 2
-  messageBody = std::make_shared<GdsEventMessage>();
-  break;
-  case gds_types::GdsMsgType::EVENT_REPLY: // Type 3
-  messageBody = std::make_shared<GdsEventReplyMessage>();
-  break;
-  case gds_types::GdsMsgType::ATTACHMENT_REQUEST: // Type 4
-  messageBody = std::make_shared<GdsAttachmentRequestMessage>();
-  break;
-  case gds_types::GdsMsgType::ATTACHMENT_REQUEST_REPLY: // Type 5
-  messageBody = std::make_shared<GdsAttachmentRequestReplyMessage>();
-  break;
-  case gds_types::GdsMsgType::ATTACHMENT: // Type 6
-  messageBody = std::make_shared<GdsAttachmentResponseMessage>();
-  break;
-  case gds_types::GdsMsgType::ATTACHMENT_REPLY: // Type 7
-  messageBody = std::make_shared<GdsAttachmentResponseResultMessage>();
-  break;
-  case gds_types::GdsMsgType::EVENT_DOCUMENT: // Type 8
-  messageBody = std::make_shared<GdsEventDocumentMessage>();
-  break;
-  case gds_types::GdsMsgType::EVENT_DOCUMENT_REPLY: // Type 9
-  messageBody = std::make_shared<GdsEventDocumentReplyMessage>();
-  break;
-  case gds_types::GdsMsgType::QUERY: // Type 10
-  messageBody = std::make_shared<GdsQueryRequestMessage>();
-  break;
-  case gds_types::GdsMsgType::QUERY_REPLY: // Type 11
-  messageBody = std::make_shared<GdsQueryReplyMessage>();
-  break;
-  case gds_types::GdsMsgType::GET_NEXT_QUERY: // Type 12
-  messageBody = std::make_shared<GdsNextQueryRequestMessage>();
-  break;
-  default:
-  messageBody.reset();
-  break;
-}
-if (messageBody) {
-  messageBody->unpack(data.at(gds_types::GdsHeader::DATA));
-}
-
-validate();
-}
-
-void GdsMessage::validate() const {
-  if (createTime < 0) {
-    throw invalid_message_error(GdsMsgType::HEADER_MESSAGE);
-  }
-  if (isFragmented) {
-    if (!(firstFragment.has_value() && lastFragment.has_value() &&
-      offset.has_value() && fds.has_value())) {
-      throw invalid_message_error(GdsMsgType::HEADER_MESSAGE);
-  }
-} else {
-  if ((firstFragment.has_value() || lastFragment.has_value() ||
-   offset.has_value() || fds.has_value())) {
-    throw invalid_message_error(GdsMsgType::HEADER_MESSAGE);
-}
-}
-if (dataType < 0 || dataType > 14) {
-  throw invalid_message_error(GdsMsgType::HEADER_MESSAGE);
-}
-if (messageBody) {
-  messageBody->validate();
-}
-}
-
-std::string GdsMessage::to_string() const
-{
-  std::stringstream ss;
-  ss << std::boolalpha;
-  ss << '[' << '\n';
-  ss << userName;
-  ss << ", "  << '\n' << messageId;
-  ss << ", "  << '\n' << createTime;
-  ss << ", "  << '\n' << requestTime;
-  ss << ", "  << '\n' << isFragmented;
-  ss << ", "  << '\n' << firstFragment;
-  ss << ", "  << '\n' << lastFragment;
-  ss << ", "  << '\n' << offset;
-  ss << ", "  << '\n' << fds;
-  ss << ", "  << '\n' << dataType;
-  if(messageBody)
-  {
-    ss << ", "  << '\n' << messageBody->to_string();
-  }
-  else
-  {
-    ss  << '\n' << ", null";
-  }
-
-  ss  << '\n' << ']';
-  return ss.str();
-}
-
-
-void GdsFieldValue::pack(msgpack::packer<msgpack::sbuffer> &packer) const {
-  switch (type) {
-    case msgpack::type::NIL:
-    packer.pack_nil();
-    break;
-    case msgpack::type::BOOLEAN:
-    as<bool>() ? packer.pack_true() : packer.pack_false();
-    break;
-    case msgpack::type::POSITIVE_INTEGER:
-    packer.pack_uint64(as<uint64_t>());
-    break;
-    case msgpack::type::NEGATIVE_INTEGER:
-    packer.pack_int64(as<int64_t>());
-    break;
-    case msgpack::type::FLOAT32:
-    packer.pack_float(as<float>());
-    break;
-    case msgpack::type::FLOAT64:
-    packer.pack_double(as<double>());
-    break;
-    case msgpack::type::STR:
-    packer.pack(as<std::string>());
-    break;
-    case msgpack::type::BIN:
-    packer.pack(as<byte_array>());
-    break;
-    case msgpack::type::ARRAY: {
-      std::vector<GdsFieldValue> items = as<std::vector<GdsFieldValue>>();
-      packer.pack_array(items.size());
-      for (auto &obj : items) {
-        obj.pack(packer);
-      }
-    } break;
-    case msgpack::type::MAP:
-    packer.pack(as<std::map<std::string, std::string>>());
-    break;
-    default:
-    throw invalid_message_error(GdsMsgType::UNKNOWN);
-  }
-}
-
-void GdsFieldValue::unpack(const msgpack::object &obj) {
-  type = obj.type;
-  switch (obj.type) {
-    case msgpack::type::NIL:
-    value = std::nullopt;
-    break;
-    case msgpack::type::BOOLEAN:
-    value = obj.as<bool>();
-    break;
-    case msgpack::type::POSITIVE_INTEGER:
-    value = obj.as<uint64_t>();
-    break;
-    case msgpack::type::NEGATIVE_INTEGER:
-    value = obj.as<int64_t>();
-    break;
-    case msgpack::type::FLOAT32:
-    value = obj.as<float>();
-    break;
-    case msgpack::type::FLOAT64:
-    value = obj.as<double>();
-    break;
-    case msgpack::type::STR:
-    value = obj.as<std::string>();
-    break;
-    case msgpack::type::BIN:
-    value = obj.as<byte_array>();
-    break;
-    case msgpack::type::ARRAY: {
-      std::vector<msgpack::object> items = obj.as<std::vector<msgpack::object>>();
-      std::vector<GdsFieldValue>   values;
-      values.reserve(items.size());
-      for (auto &object : items) {
-        GdsFieldValue current;
-        current.unpack(object);
-        values.emplace_back(current);
-      }
-      value = values;
-    } break;
-    case msgpack::type::MAP:
-    value = obj.as<std::map<std::string, std::string>>();
-    break;
-    default:
-    throw invalid_message_error(GdsMsgType::UNKNOWN);
-  }
-}
-
-void GdsFieldValue::validate() const {}
-
-
-std::string GdsFieldValue::to_string() const {
-  std::stringstream ss;
-  switch (type) {
-    case msgpack::type::NIL:
-    ss << "null";
-    break;
-    case msgpack::type::BOOLEAN:
-    ss << (as<bool>() ? "true" : "false");
-    break;
-    case msgpack::type::POSITIVE_INTEGER:
-    ss << as<uint64_t>();
-    break;
-    case msgpack::type::NEGATIVE_INTEGER:
-    ss << as<int64_t>();
-    break;
-    case msgpack::type::FLOAT32:
-    ss << as<float>();
-    break;
-    case msgpack::type::FLOAT64:
-    ss << as<double>();
-    break;
-    case msgpack::type::STR:
-    ss << as<std::string>();
-    break;
-    case msgpack::type::BIN:
-    ss << "<" << as<byte_array>().size() << "bytes>";
-    break;
-    case msgpack::type::ARRAY: {
-      std::vector<GdsFieldValue> items = as<std::vector<GdsFieldValue>>();
-      ss << items;
-    } break;
-    case msgpack::type::MAP:
-    {
-      auto items = as<std::map<std::string, std::string>>();
-      ss << items;
-    }
-    break;
-    default:
-    break;
-  }
-  return ss.str();
-}
-
-
-
-void EventReplyBody::pack(msgpack::packer<msgpack::sbuffer> &packer) const {
-  validate();
-  for (auto &eventResult : results) {
-    packer.pack_array(4);
-
-    packer.pack_int32(eventResult.status);
-    packer.pack(eventResult.notification);
-
-    packer.pack_array(eventResult.fieldDescriptor.size());
-    for (auto &descriptor : eventResult.fieldDescriptor) {
-      packer.pack_array(descriptor.size());
-      for (auto &item : descriptor) {
-        packer.pack(item);
-      }
-    }
-
-    packer.pack_array(eventResult.subResults.size());
-    for (auto &subResult : eventResult.subResults) {
-      packer.pack_array(6);
-      packer.pack_int32(subResult.status);
-
-      if (subResult.id.has_value()) {
-        packer.pack(subResult.id.value());
-      } else {
-        packer.pack_nil();
-      }
-      if (subResult.tableName.has_value()) {
-        packer.pack(subResult.tableName.value());
-      } else {
-        packer.pack_nil();
-      }
-      if (subResult.created.has_value()) {
-        subResult.created.value() ? packer.pack_true() : packer.pack_false();
-      } else {
-        packer.pack_nil();
-      }
-      if (subResult.version.has_value()) {
-        packer.pack(subResult.version.value());
-      } else {
-        packer.pack_nil();
-      }
-      if (subResult.values.has_value()) {
-        packer.pack_array(subResult.values.value().size());
-        for (auto &fieldValue : subResult.values.value()) {
-          fieldValue.pack(packer);
-        }
-      } else {
-        packer.pack_nil();
-      }
-    }
-  }
-}
-
-void EventReplyBody::unpack(const msgpack::object &packer) {
-  std::vector<msgpack::object> eventResults =
-  packer.as<std::vector<msgpack::object>>();
-
-  results.reserve(eventResults.size());
-  for (auto &object : eventResults) {
-    std::vector<msgpack::object> currentData =
-    object.as<std::vector<msgpack::object>>();
-
-    GdsEventResult currentResult;
-
-    currentResult.status = currentData.at(0).as<int32_t>();
-    if (!currentData.at(1).is_nil()) {
-      currentResult.notification = currentData.at(1).as<std::string>();
-    }
-
-    currentResult.fieldDescriptor =
-    currentData.at(2).as<std::vector<field_descriptor>>();
-
-    std::vector<msgpack::object> subResults =
-    currentData.at(3).as<std::vector<msgpack::object>>();
-    currentResult.subResults.reserve(subResults.size());
-
-
-    for (auto &subResultObj : subResults) {
-      std::vector<msgpack::object> subRes =
-      subResultObj.as<std::vector<msgpack::object>>();
-      EventSubResult currentSubResult;
-
-      currentSubResult.status = subRes.at(0).as<int32_t>();
-      
-      if (subRes.size()>1 && !subRes.at(1).is_nil()) {
-        currentSubResult.id = subRes.at(1).as<std::string>();
-      }
-
-      if (subRes.size()>2 && !subRes.at(2).is_nil()) {
-        currentSubResult.tableName = subRes.at(2).as<std::string>();
-      }
-
-      if (subRes.size()>3 && !subRes.at(3).is_nil()) {
-        currentSubResult.created = subRes.at(3).as<bool>();
-      }
-
-      if (subRes.size()>4 && !subRes.at(4).is_nil()) {
-        currentSubResult.version = subRes.at(4).as<std::string>();
-      }
-
-      if (subRes.size()>5 && !subRes.at(5).is_nil()) {
-        std::vector<msgpack::object> fieldValues =
-        subRes.at(5).as<std::vector<msgpack::object>>();
-
-
-        currentSubResult.values = std::vector<GdsFieldValue>();
-        currentSubResult.values.value().reserve(fieldValues.size());
-        for (auto &fieldValue : fieldValues) {
-          GdsFieldValue currentGDSFv;
-          currentGDSFv.unpack(fieldValue);
-          currentSubResult.values.value().emplace_back(currentGDSFv);
-        }
-
-        currentResult.subResults.emplace_back(currentSubResult);
-      }
-    }
-
-    results.emplace_back(currentResult);
-  }
-
-  validate();
-}
-
-void EventReplyBody::validate() const {
-  // skip
-}
-
-
-
-std::string EventReplyBody::to_string() const
-{
-  std::stringstream ss;
-  ss << results;
-  return ss.str();
-}
-
-
-void AttachmentResult::pack(msgpack::packer<msgpack::sbuffer> &packer) const {
-  validate();
-  size_t map_elements = 4;
-  if (meta.has_value()) {
-    map_elements += 1;
-  }
-  if (ttl.has_value()) {
-    map_elements += 1;
-  }
-  if (to_valid.has_value()) {
-    map_elements += 1;
-  }
-  if (attachment.has_value()) {
-    map_elements += 1;
-  }
-
-  packer.pack_map(map_elements);
-  packer.pack("requestids");
-  packer.pack(requestIDs);
-  packer.pack("ownertable");
-  packer.pack(ownerTable);
-  packer.pack("attachmentid");
-  packer.pack(attachmentID);
-  packer.pack("ownerids");
-  packer.pack(ownerIDs);
-
-  if (meta.has_value()) {
-    packer.pack("meta");
-    packer.pack(meta.value());
-  }
-  if (ttl.has_value()) {
-    packer.pack("ttl");
-    packer.pack_int64(ttl.value());
-  }
-  if (to_valid.has_value()) {
-    packer.pack("to_valid");
-    packer.pack_int64(to_valid.value());
-  }
-  if (attachment.has_value()) {
-    packer.pack("attachment");
-    packer.pack(attachment.value());
-  }
-}
-
-void AttachmentResult::unpack(const msgpack::object &packer) {
-  std::map<std::string, msgpack::object> obj =
-  packer.as<std::map<std::string, msgpack::object>>();
-
-  requestIDs = obj.at("requestids").as<std::vector<std::string>>();
-  ownerTable = obj.at("ownertable").as<std::string>();
-  attachmentID = obj.at("attachmentid").as<std::string>();
-  ownerIDs = obj.at("ownerids").as<std::vector<std::string>>();
-
-  if (obj.find("meta") != obj.end()) {
-    meta = obj.at("meta").as<std::string>();
-  }
-  if (obj.find("ttl") != obj.end()) {
-    ttl = obj.at("ttl").as<int64_t>();
-  }
-  if (obj.find("to_valid") != obj.end()) {
-    to_valid = obj.at("to_valid").as<int64_t>();
-  }
-  if (obj.find("attachment") != obj.end()) {
-    attachment = obj.at("attachment").as<byte_array>();
-  }
-  validate();
-}
-void AttachmentResult::validate() const {}
-
-
-std::string AttachmentResult::to_string() const
-{
-  std::stringstream ss;
-  ss << '[' << '\n';
-  ss << requestIDs;
-  ss << ", "  << '\n' << ownerTable;
-  ss << ", "  << '\n' << attachmentID;
-  ss << ", "  << '\n' << ownerIDs;
-  ss << ", "  << '\n' << meta;
-  ss << ", "  << '\n' << ttl;
-  ss << ", "  << '\n' << to_valid;
-  if(attachment)
-  {
-    ss << ", "  << '\n' << "<" << attachment.value().size() << " bytes>";
-  }
-  else
-  {
-    ss << ", "  << '\n' << attachment;
-  }
-  ss  << '\n' << ']';
-  return ss.str();
-}
-
-
-
-void AttachmentRequestBody::pack(
-  msgpack::packer<msgpack::sbuffer> &packer) const {
-  validate();
-  packer.pack_array(3);
-  packer.pack_int32(status);
-  result.pack(packer);
-  if (waitTime.has_value()) {
-    packer.pack_int64(waitTime.value());
-  } else {
-    packer.pack_nil();
-  }
-}
-
-void AttachmentRequestBody::unpack(const msgpack::object &packer) {
-  std::vector<msgpack::object> obj = packer.as<std::vector<msgpack::object>>();
-  status = obj.at(0).as<int32_t>();
-  result.unpack(obj.at(1));
-  if (obj.at(2).is_nil()) {
-    waitTime.reset();
-  } else {
-    waitTime = obj.at(2).as<int64_t>();
-  }
-  validate();
-}
-void AttachmentRequestBody::validate() const {}
-
-
-std::string AttachmentRequestBody::to_string() const
-{
-  std::stringstream ss;
-  ss << '[' << '\n';
-  ss << status;
-  ss << ", " << '\n' << result;
-  ss << ", " << '\n' << waitTime;
-  ss << '\n' <<  ']';
-  return ss.str();
-}
-
-
-
-void AttachmentResponse::pack(msgpack::packer<msgpack::sbuffer> &packer) const {
-  validate();
-  packer.pack_map(3);
-  packer.pack("requestids");
-  packer.pack(requestIDs);
-  packer.pack("ownertable");
-  packer.pack(ownerTable);
-  packer.pack("attachmentid");
-  packer.pack(attachmentID);
-}
-
-void AttachmentResponse::unpack(const msgpack::object &packer) {
-  std::map<std::string, msgpack::object> obj =
-  packer.as<std::map<std::string, msgpack::object>>();
-
-  requestIDs = obj.at("requestids").as<std::vector<std::string>>();
-  ownerTable = obj.at("ownertable").as<std::string>();
-  attachmentID = obj.at("attachmentid").as<std::string>();
-  validate();
-}
-void AttachmentResponse::validate() const {}
-
-
-std::string AttachmentResponse::to_string() const
-{
-  std::stringstream ss;
-  ss << '[' << '\n';
-  ss << requestIDs;
-  ss << ", "  << '\n' << ownerTable;
-  ss << ", "  << '\n' << attachmentID;
-  ss << '\n' << ']';
-  return ss.str();
-}
-
-
-void AttachmentResponseBody::pack(
-  msgpack::packer<msgpack::sbuffer> &packer) const {
-  validate();
-  packer.pack_array(2);
-  packer.pack_int32(status);
-  result.pack(packer);
-}
-
-void AttachmentResponseBody::unpack(const msgpack::object &packer) {
-  std::vector<msgpack::object> obj = packer.as<std::vector<msgpack::object>>();
-  status = obj.at(0).as<int32_t>();
-  result.unpack(obj.at(1));
-  validate();
-}
-void AttachmentResponseBody::validate() const { result.validate(); }
-
-
-std::string AttachmentResponseBody::to_string() const
-{
-  std::stringstream ss;
-  ss << '[' << '\n';
-  ss << status;
-  ss << ", "  << '\n' << result;
-  ss  << '\n' << ']';
-  return ss.str();
-}
-
-
-void EventDocumentResult::pack(
-  msgpack::packer<msgpack::sbuffer> &packer) const {
-  validate();
-  packer.pack_array(3);
-  packer.pack_int32(status_code);
-  if (notification.has_value()) {
-    packer.pack(notification.value());
-  } else {
-    packer.pack_nil();
-  }
-  packer.pack_map(0);
-}
-
-void EventDocumentResult::unpack(const msgpack::object &object) {
-  std::vector<msgpack::object> data = object.as<std::vector<msgpack::object>>();
-  status_code = data.at(0).as<int32_t>();
-  if (!data.at(1).is_nil()) {
-    notification = data.at(1).as<std::string>();
-  }
-  validate();
-}
-void EventDocumentResult::validate() const {}
-
-
-std::string EventDocumentResult::to_string() const
-{
-  std::stringstream ss;
-  ss << '[' << '\n';
-  ss << status_code;
-  ss << ", " << '\n' << notification;
-  ss << ", " << '\n' << returnings;
-  ss  << '\n' << ']';
-  return ss.str();
-}
-
-
-void QueryContextDescriptor::pack(
-  msgpack::packer<msgpack::sbuffer> &packer) const {
-  packer.pack_array(9);
-
-  packer.pack(scroll_id);
-  packer.pack(select_query);
-  packer.pack_int64(delivered_hits);
-  packer.pack_int64(query_start_time);
-  packer.pack(consistency_type);
-  packer.pack(last_bucket_id);
-  packer.pack_array(2);
-  packer.pack(gds_holder.at(0));
-  packer.pack(gds_holder.at(1));
-
-  packer.pack_array(field_values.size());
-  for (auto &item : field_values) {
-    item.pack(packer);
-  }
-
-  packer.pack_array(partition_names.size());
-  for (auto &item : partition_names) {
-    packer.pack(item);
-  }
-}
-void QueryContextDescriptor::unpack(const msgpack::object &object) {
-  std::vector<msgpack::object> data = object.as<std::vector<msgpack::object>>();
-  scroll_id = data.at(0).as<std::string>();
-  select_query = data.at(1).as<std::string>();
-  delivered_hits = data.at(2).as<int64_t>();
-  query_start_time = data.at(3).as<int64_t>();
-  consistency_type = data.at(4).as<std::string>();
-  last_bucket_id = data.at(5).as<std::string>();
-
-  std::vector<std::string> gdsholders =
-  data.at(6).as<std::vector<std::string>>();
-  gds_holder[0] = gdsholders.at(0);
-  gds_holder[1] = gdsholders.at(1);
-
-  std::vector<msgpack::object> fieldvalues =
-  data.at(7).as<std::vector<msgpack::object>>();
-  fieldvalues.clear();
-  field_values.reserve(fieldvalues.size());
-  for (auto &val : fieldvalues) {
-    GdsFieldValue current;
-    current.unpack(val);
-    field_values.emplace_back(current);
-  }
-  partition_names = data.at(8).as<std::vector<std::string>>();
-}
-
-void QueryContextDescriptor::validate() const {}
-
-
-std::string QueryContextDescriptor::to_string() const
-{
-  std::stringstream ss;
-  ss << '[' << '\n';
-  ss << scroll_id ;
-  ss << ", "  << '\n' << select_query ;
-  ss << ", "  << '\n' << delivered_hits;
-  ss << ", "  << '\n' << query_start_time;
-  ss << ", "  << '\n' << consistency_type;
-  ss << ", "  << '\n' << last_bucket_id;
-  ss << ", "  << '\n' << gds_holder ;
-  ss << ", "  << '\n' << field_values;
-  ss << ", "  << '\n' << partition_names;
-  ss << '\n' << ']';
-  return ss.str();
-}
-
-
-void QueryReplyBody::pack(msgpack::packer<msgpack::sbuffer> &packer) const {
-  validate();
-  packer.pack_array(7);
-  packer.pack_int64(numberOfHits);
-  packer.pack_int64(filteredHits);
-  hasMorePages ? packer.pack_true() : packer.pack_false();
-  queryContextDescriptor.pack(packer);
-  packer.pack_array(fieldDescriptors.size());
-  for (auto &item : fieldDescriptors) {
-    packer.pack_array(3);
-    for (auto &desc : item) {
-      packer.pack(desc);
-    }
-  }
-
-  packer.pack_array(hits.size());
-  for (auto &hit_rows : hits) {
-    packer.pack_array(hit_rows.size());
-    for (auto &hit : hit_rows) {
-      hit.pack(packer);
-    }
-  }
-  packer.pack_int64(totalNumberOfHits);
-}
-
-void QueryReplyBody::unpack(const msgpack::object &obj) {
-  std::vector<msgpack::object> items = obj.as<std::vector<msgpack::object>>();
-  numberOfHits = items.at(0).as<int64_t>();
-  filteredHits = items.at(1).as<int64_t>();
-  hasMorePages = items.at(2).as<bool>();
-  queryContextDescriptor.unpack(items.at(3));
-  std::vector<msgpack::object> fielddescriptors =
-  items.at(4).as<std::vector<msgpack::object>>();
-  fieldDescriptors.reserve(fielddescriptors.size());
-  for (auto &item : fielddescriptors) {
-    std::vector<std::string> data = item.as<std::vector<std::string>>();
-    field_descriptor         desc;
-    desc[0] = data.at(0);
-    desc[1] = data.at(1);
-    desc[2] = data.at(2);
-    fieldDescriptors.emplace_back(desc);
-  }
-
-  std::vector<msgpack::object> values =
-  items.at(5).as<std::vector<msgpack::object>>();
-  hits.reserve(values.size());
-  for (auto &object : values) {
-    std::vector<msgpack::object> row =
-    object.as<std::vector<msgpack::object>>();
-    std::vector<GdsFieldValue> currenthit;
-    currenthit.reserve(row.size());
-    for (auto &val : row) {
-      GdsFieldValue value;
-      value.unpack(val);
-      currenthit.emplace_back(value);
-    }
-
-    hits.emplace_back(currenthit);
-    if(items.size() > 6)
-    {
-      totalNumberOfHits = items.at(6).as<int64_t>();
-    }
-  }
-
-  validate();
-}
-void QueryReplyBody::validate() const {
-  if (hits.size() != numberOfHits) {
-    throw invalid_message_error(GdsMsgType::QUERY_REPLY);
-  }
-}
-
-
-std::string QueryReplyBody::to_string() const
-{
-  std::stringstream ss;
-  ss << std::boolalpha;
-  ss << '[' << '\n';
-  ss << numberOfHits;
-  ss << ", "  << '\n' << filteredHits;
-  ss << ", "  << '\n' << hasMorePages;
-  ss << ", "  << '\n' << queryContextDescriptor;
-  ss << ", "  << '\n' << fieldDescriptors;
-  ss << ", "  << '\n' << hits;
-  ss << '\n' << ']';
-  return ss.str();
-}
-
-
-/*0*/
-void GdsLoginMessage::pack(msgpack::packer<msgpack::sbuffer> &packer) const {
-  validate();
-
-  size_t message_size = 4;
-  if(cluster_name.has_value()){
-    message_size += 1;
-  }
-
-  if(reserved_fields.has_value()){
-    message_size += 1;
-  }
-
-  packer.pack_array(message_size);
-  
-  if(cluster_name.has_value()){
-    packer.pack(cluster_name.value());
-  }
-
-  serve_on_the_same_connection ? packer.pack_true() : packer.pack_false();
-  packer.pack_int32(protocol_version_number);
-  if (fragmentation_supported) {
-    packer.pack_true();
-    packer.pack_int32(fragment_transmission_unit.value());
-  } else {
-    packer.pack_false();
-    packer.pack_nil();
-  }
-
-  if (reserved_fields.has_value()) {
-    packer.pack_array(reserved_fields.value().size());
-    for (auto &field : reserved_fields.value()) {
-      packer.pack(field);
-    }
-  }
-}
-
-void GdsLoginMessage::unpack(const msgpack::object &packer) {
-  std::vector<msgpack::object> data = packer.as<std::vector<msgpack::object>>();
-  size_t idx = 0;
-  if(data.at(0).type == msgpack::type::STR){
-    cluster_name = data.at(idx++).as<std::string>();
-  }
-
-  serve_on_the_same_connection = data.at(idx++).as<bool>();
-  protocol_version_number = data.at(idx++).as<int32_t>();
-  fragmentation_supported = data.at(idx++).as<bool>();
-  if (fragmentation_supported) {
-    fragment_transmission_unit = data.at(idx++).as<int32_t>();
-  } else {
-    fragment_transmission_unit.reset();
-    idx++;
-  }
-
-  if (data.size() > idx) {
-    reserved_fields = data.at(idx).as<std::vector<std::string>>();
-  } else {
-    reserved_fields.reset();
-  }
-
-  validate();
-}
-
-void GdsLoginMessage::validate() const {
-  if (fragmentation_supported != fragment_transmission_unit.has_value()) {
-    throw invalid_message_error(GdsMsgType::LOGIN, "fragmentation_flag");
-  }
-
-  if (reserved_fields.has_value() && reserved_fields.value().size() == 0) {
-    throw invalid_message_error(GdsMsgType::LOGIN, "reserved_fields");
-  }
-}
-
-
-std::string GdsLoginMessage::to_string() const
-{
-  std::stringstream ss;
-  ss << std::boolalpha;
-  ss << '[' << '\n';
-  if(cluster_name){
-    ss << cluster_name << ", " << '\n';
-  }
-  ss << serve_on_the_same_connection;
-  ss << ", "  << '\n' << protocol_version_number;
-  ss << ", "  << '\n' << fragmentation_supported;
-  ss << ", "  << '\n' << fragment_transmission_unit;
-  if(reserved_fields)
-  {
-    ss << ", " << '\n' << reserved_fields;
-  }
-
-  ss  << '\n' << ']';
-  return ss.str();
-}
-
-
-/*1*/
-void GdsLoginReplyMessage::pack(
-  msgpack::packer<msgpack::sbuffer> &packer) const {
-  validate();
-  packer.pack_array(3);
-  packer.pack_int32(ackStatus);
-  if (loginReply) {
-    loginReply.value().pack(packer);
-  } else if (errorDetails) {
-    packer.pack_map(errorDetails.value().size());
-    for (auto &pair : errorDetails.value()) {
-      packer.pack_int32(pair.first);
-      packer.pack(pair.second);
-    }
-  } else {
-    packer.pack_nil();
-  }
-  if (ackException) {
-    packer.pack(ackException);
-  } else {
-    packer.pack_nil();
-  }
-}
-
-void GdsLoginReplyMessage::unpack(const msgpack::object &packer) {
-  std::vector<msgpack::object> data = packer.as<std::vector<msgpack::object>>();
-  ackStatus = data.at(0).as<int32_t>();
-  loginReply.reset();
-  errorDetails.reset();
-
-  if (200 == ackStatus && data.at(1).type == msgpack::type::ARRAY) {
-    GdsLoginMessage loginmessage;
-    loginmessage.unpack(data.at(1));
-    loginReply = loginmessage;
-  } else if (401 == ackStatus && data.at(1).type == msgpack::type::MAP) {
-    errorDetails = data.at(1).as<std::map<int32_t, std::string>>();
-  }
-
-  if (!data.at(2).is_nil()) {
-    ackException = data.at(2).as<std::string>();
-  } else {
-    ackException.reset();
-  }
-  validate();
-}
-
-void GdsLoginReplyMessage::validate() const {
-  if (loginReply.has_value() == errorDetails.has_value()) {
-    if (loginReply.has_value()) {
-      throw invalid_message_error(type());
-    }
-  }
-}
-
-
-std::string GdsLoginReplyMessage::to_string() const
-{
-  std::stringstream ss;
-  ss << '[' << '\n';
-  ss << ackStatus;
-  if(loginReply){
-    ss << ", "  << '\n' << loginReply;
-  }else{
-    ss << ", "  << '\n' << errorDetails;
-  }
-  ss << '\n' << ", " << ackException;
-  ss << '\n' << ']';
-  return ss.str();
-}
-
-
-/*2*/
-void GdsEventMessage::pack(msgpack::packer<msgpack::sbuffer> &packer) const {
-  validate();
-  packer.pack_array(3);
-  packer.pack(operations);
-  packer.pack(binaryContents);
-  packer.pack(priorityLevels);
-}
-
-void GdsEventMessage::unpack(const msgpack::object &packer) {
-  std::vector<msgpack::object> data = packer.as<std::vector<msgpack::object>>();
-  operations = data.at(0).as<std::string>();
-  binaryContents = data.at(1).as<std::map<std::string, byte_array>>();
-  priorityLevels =
-  data.at(2).as<std::vector<std::vector<std::map<int32_t, bool>>>>();
-  validate();
-}
-
-void GdsEventMessage::validate() const {
-  // skip, nothing specific here
-}
-
-
-std::string GdsEventMessage::to_string() const
-{
-  std::stringstream ss;
-  ss << '[' << '\n';
-  ss << operations;
-  ss << ", "  << '\n' << binaryContents;
-  ss << ", "  << '\n' << priorityLevels;
-  ss  << '\n' << ']';
-  return ss.str();
-}
-
-
-/*3*/
-void GdsEventReplyMessage::pack(
-  msgpack::packer<msgpack::sbuffer> &packer) const {
-  validate();
-
-  packer.pack_array(3);
-  packer.pack_int32(ackStatus);
-  if (reply) {
-    reply->pack(packer);
-  } else {
-    packer.pack_nil();
-  }
-  if (ackException) {
-    packer.pack(ackException);
-  } else {
-    packer.pack_nil();
-  }
-}
-
-void GdsEventReplyMessage::unpack(const msgpack::object &packer) {
-
-  std::vector<msgpack::object> data = packer.as<std::vector<msgpack::object>>();
-  ackStatus = data.at(0).as<int32_t>();
-  if (!data.at(1).is_nil()) {
-    EventReplyBody body;
-    body.unpack(data.at(1));
-    reply = body;
-  } else {
-    reply.reset();
-  }
-  if (!data.at(2).is_nil()) {
-    ackException = data.at(2).as<std::string>();
-  } else {
-    ackException.reset();
-  }
-  validate();
-}
-
-void GdsEventReplyMessage::validate() const {
-  if(reply){
-    reply.value().validate();
-  }
-}
-
-std::string GdsEventReplyMessage::to_string() const
-{
-  std::stringstream ss;
-  ss << '[' << '\n';
-  ss << ackStatus;
-  ss << ", "  << '\n' << reply;
-  ss << ", "  << '\n' << ackException;
-  ss  << '\n' << ']';
-  return ss.str();
-}
-
-
-
-std::string EventReplyBody::EventSubResult::to_string() const
-{
-  std::stringstream ss;
-  ss << std::boolalpha;
-  ss << '[' << '\n';
-  ss << status;
-  ss << ", "  << '\n' << id;
-  ss << ", "  << '\n' << tableName;
-  ss << ", "  << '\n' << created;
-  ss << ", "  << '\n' << version;
-  ss << ", "  << '\n' << values;
-  ss  << '\n' << ']';
-  return ss.str();
-}
-
-
-std::string EventReplyBody::GdsEventResult::to_string() const
-{
-  std::stringstream ss;
-  ss << '[' << '\n';
-  ss << status;
-  ss << ", "  << '\n' << notification;
-  ss << ", "  << '\n' << fieldDescriptor;
-  ss << ", "  << '\n' << subResults;
-  ss << '\n'  << ']';
-  return ss.str();
-}
-
-
-
-
-/*4*/
-void GdsAttachmentRequestMessage::pack(
-  msgpack::packer<msgpack::sbuffer> &packer) const {
-  validate();
-  packer.pack(request);
-}
-void GdsAttachmentRequestMessage::unpack(const msgpack::object &obj) {
-  request = obj.as<std::string>();
-  validate();
-}
-void GdsAttachmentRequestMessage::validate() const {
-  // skip
-}
-
-std::string GdsAttachmentRequestMessage::to_string() const
-{
-  std::stringstream ss;
-  ss << '[' << '\n';
-  ss << request << '\n';
-  ss << ']';
-  return ss.str();
-}
-
-
-/*5*/
-void GdsAttachmentRequestReplyMessage::pack(
-  msgpack::packer<msgpack::sbuffer> &packer) const {
-  validate();
-  packer.pack_array(3);
-  packer.pack_int32(ackStatus);
-  if (ackStatus == GDSStatusCodes::OK) {
-    request->pack(packer);
-  } else {
-    packer.pack_nil();
-  }
-  if (ackException) {
-    packer.pack(ackException);
-  } else {
-    packer.pack_nil();
-  }
-}
-
-void GdsAttachmentRequestReplyMessage::unpack(const msgpack::object &packer) {
-  std::vector<msgpack::object> data = packer.as<std::vector<msgpack::object>>();
-  ackStatus = data.at(0).as<int32_t>();
-  if (!data.at(1).is_nil()) {
-    request = AttachmentRequestBody();
-    request->unpack(data.at(1));
-  } else {
-    request.reset();
-  }
-  if (!data.at(2).is_nil()) {
-    ackException = data.at(2).as<std::string>();
-  } else {
-    ackException.reset();
-  }
-
-  validate();
-}
-void GdsAttachmentRequestReplyMessage::validate() const {
-  if ((ackStatus == GDSStatusCodes::OK) != (request.has_value())) {
-    throw invalid_message_error(type());
-  }
-}
-
-
-std::string GdsAttachmentRequestReplyMessage::to_string() const
-{
-  std::stringstream ss;
-  ss << '[' << '\n';
-  ss << ackStatus;
-  ss << ", "  << '\n' << request;
-  ss << ", "  << '\n' << ackException;
-  ss  << '\n' << ']';
-  return ss.str();
-}
-
-
-/*6*/
-void GdsAttachmentResponseMessage::pack(
-  msgpack::packer<msgpack::sbuffer> &packer) const {
-  validate();
-  packer.pack_array(1);
-  result.pack(packer);
-}
-
-void GdsAttachmentResponseMessage::unpack(const msgpack::object &packer) {
-  std::vector<msgpack::object> obj = packer.as<std::vector<msgpack::object>>();
-  result.unpack(obj.at(0));
-  validate();
-}
-void GdsAttachmentResponseMessage::validate() const { result.validate(); }
-
-
-std::string GdsAttachmentResponseMessage::to_string() const
-{
-  std::stringstream ss;
-  ss << '[' << '\n';
-  ss << result << '\n';
-  ss << ']' << '\n';
-  return ss.str();
-}
-
-
-/*7*/
-void GdsAttachmentResponseResultMessage::pack(
-  msgpack::packer<msgpack::sbuffer> &packer) const {
-  validate();
-  packer.pack_array(3);
-  packer.pack_int32(ackStatus);
-
-  if (response) {
-    response->pack(packer);
-  } else {
-    packer.pack_nil();
-  }
-
-  if (ackException) {
-    packer.pack(ackException);
-  } else {
-    packer.pack_nil();
-  }
-}
-
-void GdsAttachmentResponseResultMessage::unpack(const msgpack::object &packer) {
-
-  std::vector<msgpack::object> data = packer.as<std::vector<msgpack::object>>();
-  ackStatus = data.at(0).as<int32_t>();
-  if (!data.at(1).is_nil()) {
-    AttachmentResponseBody body;
-    body.unpack(data.at(1));
-    response = body;
-  } else {
-    response.reset();
-  }
-
-  if (!data.at(2).is_nil()) {
-    ackException = data.at(2).as<std::string>();
-  } else {
-    ackException.reset();
-  }
-  validate();
-}
-void GdsAttachmentResponseResultMessage::validate() const {
-  if (response) {
-    response->validate();
-  }
-}
-
-
-std::string GdsAttachmentResponseResultMessage::to_string() const
-{
-  std::stringstream ss;
-  ss << '[' << '\n';
-  ss << ackStatus;
-  ss << ", "  << '\n' << response;
-  ss << ", "  << '\n' << ackException;
-  ss  << '\n' << ']';
-  return ss.str();
-}
-
-
-
-/*8*/
-void GdsEventDocumentMessage::pack(
-  msgpack::packer<msgpack::sbuffer> &packer) const {
-  validate();
-  packer.pack_array(4);
-  packer.pack(tableName);
-  packer.pack_array(fieldDescriptors.size());
-  for (auto &item : fieldDescriptors) {
-    packer.pack_array(3);
-    for (auto &desc : item) {
-      packer.pack(desc);
-    }
-  }
-
-  packer.pack_array(records.size());
-  for (auto &hit_rows : records) {
-    packer.pack_array(hit_rows.size());
-    for (auto &hit : hit_rows) {
-      hit.pack(packer);
-    }
-  }
-
-  packer.pack_map(0);
-}
-
-void GdsEventDocumentMessage::unpack(const msgpack::object &packer) {
-  std::vector<msgpack::object> obj = packer.as<std::vector<msgpack::object>>();
-  tableName = obj.at(0).as<std::string>();
-
-  std::vector<msgpack::object> fielddescriptors =
-  obj.at(1).as<std::vector<msgpack::object>>();
-  fieldDescriptors.reserve(fielddescriptors.size());
-  for (auto &item : fielddescriptors) {
-    std::vector<std::string> data = item.as<std::vector<std::string>>();
-    field_descriptor         desc;
-    desc[0] = data.at(0);
-    desc[1] = data.at(1);
-    desc[2] = data.at(2);
-    fieldDescriptors.emplace_back(desc);
-  }
-
-  std::vector<msgpack::object> values =
-  obj.at(2).as<std::vector<msgpack::object>>();
-  records.reserve(values.size());
-  for (auto &object : values) {
-    std::vector<msgpack::object> row =
-    object.as<std::vector<msgpack::object>>();
-    std::vector<GdsFieldValue> currenthit;
-    currenthit.reserve(row.size());
-    for (auto &val : row) {
-      GdsFieldValue value;
-      value.unpack(val);
-      currenthit.emplace_back(value);
-    }
-
-    records.emplace_back(currenthit);
-  }
-
-  // returnings = obj.at(3).as<std::map<int32_t, std::vector<std::string>>>();
-  validate();
-}
-void GdsEventDocumentMessage::validate() const {
-  size_t headerCount = fieldDescriptors.size();
-  for (auto &row : records) {
-    if (headerCount != row.size()) {
-      throw invalid_message_error(type());
-    }
-  }
-}
-
-
-std::string GdsEventDocumentMessage::to_string() const
-{
-  std::stringstream ss;
-  ss << '[' << '\n';
-  ss << tableName;
-  ss << ", "  << '\n' << fieldDescriptors;
-  ss << ", "  << '\n' << records;
-  ss << ", "  << '\n' << returnings;
-  ss  << '\n' << ']';
-  return ss.str();
-}
-
-
-
-/*9*/
-void GdsEventDocumentReplyMessage::pack(
-  msgpack::packer<msgpack::sbuffer> &packer) const {
-  validate();
-
-  packer.pack_array(3);
-  packer.pack_int32(ackStatus);
-  if (results) {
-    packer.pack_array(results->size());
-    for (auto &event : results.value()) {
-      event.pack(packer);
-    }
-  } else {
-    packer.pack_nil();
-  }
-
-  if (ackException) {
-    packer.pack(ackException);
-  } else {
-    packer.pack_nil();
-  }
-}
-
-void GdsEventDocumentReplyMessage::unpack(const msgpack::object &packer) {
-
-  std::vector<msgpack::object> data = packer.as<std::vector<msgpack::object>>();
-  ackStatus = data.at(0).as<int32_t>();
-  if (!data.at(1).is_nil()) {
-    std::vector<msgpack::object> items =
-    data.at(1).as<std::vector<msgpack::object>>();
-    std::vector<EventDocumentResult> _results;
-    _results.reserve(items.size());
-    for (auto &object : items) {
-      EventDocumentResult result;
-      result.unpack(object);
-      _results.emplace_back(result);
-    }
-    results = _results;
-  } else {
-    results.reset();
-  }
-
-  if (!data.at(2).is_nil()) {
-    ackException = data.at(2).as<std::string>();
-  } else {
-    ackException.reset();
-  }
-  validate();
-}
-void GdsEventDocumentReplyMessage::validate() const {
-  // skip
-}
-
-std::string GdsEventDocumentReplyMessage::to_string() const
-{
-  std::stringstream ss;
-  ss << '[' << '\n';
-  ss << ackStatus;
-  ss << ", "  << '\n'<< results;
-  ss << ", "  << '\n'<< ackException;
-  ss  << '\n' << ']';
-  return ss.str();
-}
-
-
-/*10*/
-void GdsQueryRequestMessage::pack(
-  msgpack::packer<msgpack::sbuffer> &packer) const {
-  validate();
-  if (queryPageSize.has_value() && queryType.has_value()) {
-    packer.pack_array(5);
-  } else {
-    packer.pack_array(3);
-  }
-  packer.pack(selectString);
-  packer.pack(consistency);
-  packer.pack_int64(timeout);
-
-  if (queryPageSize.has_value() && queryType.has_value()) {
-    packer.pack_int32(queryPageSize.value());
-    packer.pack_int32(queryType.value());
-  }
-}
-
-void GdsQueryRequestMessage::unpack(const msgpack::object &obj) {
-  std::vector<msgpack::object> items = obj.as<std::vector<msgpack::object>>();
-  selectString = items.at(0).as<std::string>();
-  consistency = items.at(1).as<std::string>();
-  timeout = items.at(2).as<int64_t>();
-  if (items.size() == 5) {
-    queryPageSize = items.at(3).as<int32_t>();
-    queryType = items.at(4).as<int32_t>();
-  }
-  validate();
-}
-
-void GdsQueryRequestMessage::validate() const {
-  if (queryPageSize.has_value() != queryType.has_value()) {
-    throw invalid_message_error(type());
-  }
-}
-
-
-std::string GdsQueryRequestMessage::to_string() const
-{
-  std::stringstream ss;
-  ss << '[' << '\n';
-  ss << selectString;
-  ss << ", "  << '\n'<< consistency;
-  ss << ", "  << '\n'<< timeout;
-  if(queryPageSize && queryType){
-    ss << ", "  << '\n'<< queryPageSize.value();
-    ss << ", "  << '\n'<< queryType.value();
-  }
-  ss  << '\n' << ']';
-  return ss.str();
-}
-
-
-/*11*/
-void GdsQueryReplyMessage::pack(
-  msgpack::packer<msgpack::sbuffer> &packer) const {
-  validate();
-  packer.pack_array(3);
-  packer.pack_int32(ackStatus);
-  if (response) {
-    response->pack(packer);
-  } else {
-    packer.pack_nil();
-  }
-
-  if (ackException) {
-    packer.pack(ackException);
-  } else {
-    packer.pack_nil();
-  }
-}
-
-void GdsQueryReplyMessage::unpack(const msgpack::object &packer) {
-  std::vector<msgpack::object> data = packer.as<std::vector<msgpack::object>>();
-  ackStatus = data.at(0).as<int32_t>();
-
-  if (!data.at(1).is_nil()) {
-    QueryReplyBody body;
-    body.unpack(data.at(1));
-    response = body;
-  } else {
-    response.reset();
-  }
-
-  if (!data.at(2).is_nil()) {
-    ackException = data.at(2).as<std::string>();
-  } else {
-    ackException.reset();
-  }
-  validate();
-}
-void GdsQueryReplyMessage::validate() const {
-  if (response) {
-    response->validate();
-  }
-}
-
-
-std::string GdsQueryReplyMessage::to_string() const
-{
-  std::stringstream ss;
-  ss << '[' << '\n';
-  ss << ackStatus;
-  ss << ", "  << '\n'<< response;
-  ss << ", "  << '\n'<< ackException;
-  ss << '\n' << ']';
-  return ss.str();
-}
-
-
-/*12*/
-void GdsNextQueryRequestMessage::pack(
-  msgpack::packer<msgpack::sbuffer> &packer) const {
-  validate();
-  packer.pack_array(2);
-  contextDescriptor.pack(packer);
-  packer.pack_int64(timeout);
-}
-
-void GdsNextQueryRequestMessage::unpack(const msgpack::object &obj) {
-  std::vector<msgpack::object> items = obj.as<std::vector<msgpack::object>>();
-  contextDescriptor.unpack(items.at(0));
-  timeout = items.at(1).as<int64_t>();
-  validate();
-}
-void GdsNextQueryRequestMessage::validate() const {
-  // skip
-}
-
-std::string GdsNextQueryRequestMessage::to_string() const
-{
-  std::stringstream ss;
-  ss << '[' << '\n';
-  ss << contextDescriptor;
-  ss << ", "  << '\n' << timeout;
-  ss  << '\n' << ']';
-  return ss.str();
-}
-
-
-} // namespace gds_types
-} // namespace gds_lib
+#include "gds_types.hpp"
+#include "gds_reader.hpp"
+#include "gds_schema.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <limits>
+#include <system_error>
+#include <thread>
+
+template <typename OStream>
+static OStream& operator<<(OStream& os, const gds_lib::gds_types::Stringable& str);
+template <typename OStream, typename T>
+static OStream& operator<<(OStream& os, const std::optional<T>& opt);
+template <typename OStream, typename T, typename A>
+static OStream& operator<<(OStream& os, const std::vector<T, A>& items);
+template <typename OStream>
+static OStream& operator<<(OStream& os, const gds_lib::gds_types::byte_array& items);
+template <typename OStream, typename T, std::size_t N>
+static OStream& operator<<(OStream& os, const std::array<T, N>& array);
+template <typename OStream, typename K, typename V>
+static OStream& operator<<(OStream& os, const gds_lib::gds_types::flat_map<K,V>& items);
+
+
+template <typename OStream>
+static OStream& operator<<(OStream& os, const gds_lib::gds_types::Stringable& str)
+{
+  os << str.to_string();
+  return os;
+}
+
+
+template <typename OStream, typename T>
+static OStream& operator<<(OStream& os, const std::optional<T>& opt)
+{
+  if(opt)
+  {
+    os << opt.value();
+  }
+  else
+  {
+    os << "null";
+  }
+  return os;
+}
+
+
+template <typename OStream, typename T, typename A>
+static OStream& operator<<(OStream& os, const std::vector<T, A>& items)
+{
+  os << '[';
+  auto it = items.begin();
+  if(it != items.end())
+  {
+    os  << '\n' << *it;
+    ++it;
+    while(it != items.end())
+    {
+      os << ", " << '\n' << *it;
+      ++it;
+    }
+  }
+  os << '\n' << ']';
+  return os;
+}
+
+
+
+template <typename OStream>
+static OStream& operator<<(OStream& os, const gds_lib::gds_types::byte_array& items)
+{
+  os << '<' << items.size() << " bytes>";
+  return os;
+}
+
+template <typename OStream, typename T, std::size_t N>
+static OStream& operator<<(OStream& os, const std::array<T, N>& array){
+  os << '[';
+  if(!array.empty())
+  {
+    os  << '\n' << array[0];
+    for(size_t ii = 1;ii<array.size();++ii)
+    {
+      os << ", "  << '\n' << array[ii];
+    }
+  }
+  os << '\n' << ']';
+  return os;
+}
+
+template <typename OStream, typename K, typename V>
+static OStream& operator<<(OStream& os, const gds_lib::gds_types::flat_map<K,V>& items)
+{
+  os << '{';
+  auto it = items.begin();
+  if(it != items.end())
+  {
+    os  << '\n' << it->first << ": " << it->second;
+    ++it;
+    while(it != items.end())
+    {
+      os << ", "  << '\n' << it->first << ": " << it->second;
+      ++it;
+    }
+  }
+  os << '\n' << '}';
+  return os;
+}
+
+
+
+namespace gds_lib {
+  namespace gds_types {
+
+  namespace {
+    // the elements of an ARRAY object, without copying them into a std::vector first
+    class object_array {
+      const msgpack::object *m_begin;
+      std::size_t m_size;
+
+    public:
+      explicit object_array(const msgpack::object &object) {
+        if (object.type != msgpack::type::ARRAY) {
+          throw msgpack::type_error();
+        }
+        m_begin = object.via.array.ptr;
+        m_size = object.via.array.size;
+      }
+
+      std::size_t size() const noexcept { return m_size; }
+      const msgpack::object *begin() const noexcept { return m_begin; }
+      const msgpack::object *end() const noexcept { return m_begin + m_size; }
+      const msgpack::object &at(std::size_t index) const {
+        if (index >= m_size) {
+          throw std::out_of_range("object_array::at");
+        }
+        return m_begin[index];
+      }
+    };
+
+    // the values of a MAP object with string keys, without copying them into a std::map first
+    class object_map {
+      const msgpack::object_kv *m_begin;
+      std::size_t m_size;
+
+    public:
+      explicit object_map(const msgpack::object &object) {
+        if (object.type != msgpack::type::MAP) {
+          throw msgpack::type_error();
+        }
+        m_begin = object.via.map.ptr;
+        m_size = object.via.map.size;
+      }
+
+      const msgpack::object *find(std::string_view key) const {
+        for (std::size_t ii = 0; ii < m_size; ++ii) {
+          const msgpack::object &item = m_begin[ii].key;
+          if (item.type != msgpack::type::STR) {
+            throw msgpack::type_error();
+          }
+          if (key == std::string_view(item.via.str.ptr, item.via.str.size)) {
+            return &m_begin[ii].val;
+          }
+        }
+        return nullptr;
+      }
+      const msgpack::object &at(std::string_view key) const {
+        if (const msgpack::object *value = find(key)) {
+          return *value;
+        }
+        throw std::out_of_range("object_map::at");
+      }
+    };
+
+    field_descriptor descriptor_of(const msgpack::object &object) {
+      object_array data(object);
+      field_descriptor desc;
+      for (std::size_t ii = 0; ii < desc.size(); ++ii) {
+        data.at(ii).convert(desc[ii]);
+      }
+      return desc;
+    }
+
+    // lets a msgpack::packer append to a std::string
+    struct string_writer {
+      std::string &out;
+      void write(const char *data, std::size_t size) { out.append(data, size); }
+    };
+
+    // the header of an array that has to have at least `minimum` elements
+    uint32_t read_array_of(MessageReader &reader, uint32_t minimum, GdsMsgType::Enum type) {
+      uint32_t size = reader.read_array_header();
+      if (size < minimum) {
+        throw invalid_message_error(type, "the array has only " + std::to_string(size) + " elements");
+      }
+      return size;
+    }
+
+    // the fields of a message with a schema, in the layout of the other to_string() methods
+    template <typename Message>
+    std::string schema_to_string(const Message &message) {
+      std::stringstream ss;
+      ss << '[' << '\n';
+      bool first = true;
+      SchemaCodec<Message>::visit(message, [&ss, &first](std::string_view, const auto &value) {
+        if (!first) {
+          ss << ", " << '\n';
+        }
+        first = false;
+        ss << value;
+      });
+      ss << '\n' << ']';
+      return ss.str();
+    }
+
+    void skip_values(MessageReader &reader, uint32_t count) {
+      for (uint32_t ii = 0; ii < count; ++ii) {
+        reader.skip();
+      }
+    }
+
+    field_descriptor read_descriptor(MessageReader &reader, GdsMsgType::Enum type) {
+      uint32_t size = read_array_of(reader, 3, type);
+      field_descriptor desc;
+      for (auto &item : desc) {
+        item = reader.read_string();
+      }
+      skip_values(reader, size - 3);
+      return desc;
+    }
+
+    std::optional<std::string> read_optional_string(MessageReader &reader) {
+      if (reader.try_read_nil()) {
+        return std::nullopt;
+      }
+      return reader.read_string();
+    }
+
+    // hands out the memory of a MessageArena, and keeps the arena alive as long as anything allocated by it is
+    template <typename T>
+    class arena_allocator {
+      template <typename U>
+      friend class arena_allocator;
+      std::shared_ptr<MessageArena> m_arena;
+
+    public:
+      using value_type = T;
+
+      explicit arena_allocator(std::shared_ptr<MessageArena> arena) noexcept
+        : m_arena(std::move(arena)) {}
+      template <typename U>
+      arena_allocator(const arena_allocator<U> &other) noexcept
+        : m_arena(other.m_arena) {}
+
+      T *allocate(std::size_t count) {
+        return static_cast<T *>(m_arena->allocate(count * sizeof(T), alignof(T)));
+      }
+      void deallocate(T *item, std::size_t count) noexcept {
+        m_arena->deallocate(item, count * sizeof(T), alignof(T));
+      }
+
+      template <typename U>
+      bool operator==(const arena_allocator<U> &other) const noexcept {
+        return m_arena == other.m_arena;
+      }
+      template <typename U>
+      bool operator!=(const arena_allocator<U> &other) const noexcept {
+        return m_arena != other.m_arena;
+      }
+    };
+
+    std::pmr::memory_resource *resource_of(const DecodeOptions &options) {
+      return options.resource ? options.resource : std::pmr::get_default_resource();
+    }
+
+    // if the options ask for an arena, the body is placed into a new one, and the resource of the options is replaced by it
+    template <typename T>
+    std::shared_ptr<GdsMessageData> allocate_body(DecodeOptions &options) {
+      if (!options.arena) {
+        return std::make_shared<T>();
+      }
+      std::pmr::memory_resource *upstream = resource_of(options);
+      std::shared_ptr<MessageArena> arena = std::allocate_shared<MessageArena>(
+        std::pmr::polymorphic_allocator<MessageArena>(upstream), options.arena_block_size, upstream);
+      options.resource = arena.get();
+      options.arena = false;
+      return std::allocate_shared<T>(arena_allocator<T>(std::move(arena)));
+    }
+
+    std::shared_ptr<GdsMessageData> make_body(int32_t dataType, DecodeOptions &options) {
+      switch (dataType) {
+        case GdsMsgType::LOGIN: // Type 0
+        return allocate_body<GdsLoginMessage>(options);
+        case GdsMsgType::LOGIN_REPLY: // Type 1
+        return allocate_body<GdsLoginReplyMessage>(options);
+        case GdsMsgType::EVENT: // Type 2
+        return allocate_body<GdsEventMessage>(options);
+        case GdsMsgType::EVENT_REPLY: // Type 3
+        return allocate_body<GdsEventReplyMessage>(options);
+        case GdsMsgType::ATTACHMENT_REQUEST: // Type 4
+        return allocate_body<GdsAttachmentRequestMessage>(options);
+        case GdsMsgType::ATTACHMENT_REQUEST_REPLY: // Type 5
+        return allocate_body<GdsAttachmentRequestReplyMessage>(options);
+        case GdsMsgType::ATTACHMENT: // Type 6
+        return allocate_body<GdsAttachmentResponseMessage>(options);
+        case GdsMsgType::ATTACHMENT_REPLY: // Type 7
+        return allocate_body<GdsAttachmentResponseResultMessage>(options);
+        case GdsMsgType::EVENT_DOCUMENT: // Type 8
+        return allocate_body<GdsEventDocumentMessage>(options);
+        case GdsMsgType::EVENT_DOCUMENT_REPLY: // Type 9
+        return allocate_body<GdsEventDocumentReplyMessage>(options);
+        case GdsMsgType::QUERY: // Type 10
+        return allocate_body<GdsQueryRequestMessage>(options);
+        case GdsMsgType::QUERY_REPLY: // Type 11
+        return allocate_body<GdsQueryReplyMessage>(options);
+        case GdsMsgType::GET_NEXT_QUERY: // Type 12
+        return allocate_body<GdsNextQueryRequestMessage>(options);
+        default:
+        return nullptr;
+      }
+    }
+
+    // the body of a recycled message is decoded in place if it is of the same type and nothing else refers to it,
+    // so its strings and arrays keep their capacity. Bodies are never reused with an arena, that is freed with the body
+    bool reusable_body(const std::shared_ptr<Packable> &body, int32_t dataType, const DecodeOptions &options) {
+      if (!body || options.arena || body.use_count() != 1) {
+        return false;
+      }
+      // the previous owner released the body with a release operation, its writes have to be visible here
+      std::atomic_thread_fence(std::memory_order_acquire);
+      const GdsMessageData *data = dynamic_cast<const GdsMessageData *>(body.get());
+      return data && data->type() == dataType;
+    }
+
+    // the columns of the previous page are emptied and reused if they were allocated from the same resource.
+    // The string columns are dictionary encoded if the options ask for it, with the dictionaries of the scroll if there is a cache
+    void prepare_columns(std::optional<std::pmr::vector<GdsColumn>> &columns, const std::vector<field_descriptor> &descriptors,
+                         const std::string &scroll_id, const DecodeOptions &options) {
+      std::pmr::memory_resource *resource = resource_of(options);
+      if (columns && columns->size() == descriptors.size() && columns->get_allocator().resource() == resource) {
+        for (std::size_t ii = 0; ii < descriptors.size(); ++ii) {
+          (*columns)[ii].reset(descriptors[ii]);
+        }
+      } else {
+        columns.emplace(resource);
+        columns->reserve(descriptors.size());
+        for (auto &desc : descriptors) {
+          columns->emplace_back(desc, resource);
+        }
+      }
+      if (!options.dictionaries && !options.dictionary_strings) {
+        return;
+      }
+      // every field has a dictionary of its own, so a column of many distinct values does not fill the dictionary of the others
+      for (std::size_t ii = 0; ii < columns->size(); ++ii) {
+        GdsColumn &column = (*columns)[ii];
+        if (column.type == GdsColumn::Type::STRING) {
+          column.dictionary = options.dictionaries ? options.dictionaries->dictionary(scroll_id, ii) : std::make_shared<StringDictionary>();
+        }
+      }
+    }
+  }
+
+  namespace {
+    // reads the fields before the DATA element into a GdsMessage or a GdsMessageHeader, returns the number of elements of the message
+    template <typename Header>
+    uint32_t read_header(MessageReader &reader, Header &header) {
+      uint32_t size = read_array_of(reader, GdsHeader::DATA + 1, GdsMsgType::HEADER_MESSAGE);
+      header.userName = reader.read_string();
+      header.messageId = reader.read_string();
+      header.createTime = reader.read_int64();
+      header.requestTime = reader.read_int64();
+      header.isFragmented = reader.read_bool();
+      if (header.isFragmented) {
+        header.firstFragment = reader.read_string();
+        header.lastFragment = reader.read_string();
+        header.offset = reader.read_int32();
+        header.fds = reader.read_int32();
+      } else {
+        header.firstFragment.reset();
+        header.lastFragment.reset();
+        header.offset.reset();
+        header.fds.reset();
+        skip_values(reader, 4);
+      }
+      header.dataType = reader.read_int32();
+      return size;
+    }
+
+    // the structure is checked unless the messages are trusted
+    bool validates_structure(ValidationLevel::Enum level) noexcept {
+      return level != ValidationLevel::TRUSTED;
+    }
+
+    // the rules of the protocol are only checked at the FULL level, once per message
+    template <typename T>
+    void validate_rules(const T &item, ValidationLevel::Enum level) {
+      if (level == ValidationLevel::FULL) {
+        item.T::validate();
+      }
+    }
+
+    // the number of chunks the rows are split into, 1 if they are handled by the calling thread:
+    // there is no pool, the message has too few rows or the process runs on a single core
+    unsigned chunk_count(const ParallelOptions &options, std::size_t rows) {
+      if (!options.pool || options.pool->size() == 0 || rows < options.min_rows || rows < 2) {
+        return 1;
+      }
+      static const unsigned cores = std::thread::hardware_concurrency();
+      if (cores <= 1) {
+        return 1;
+      }
+      return static_cast<unsigned>(std::min<std::size_t>(options.pool->size() + 1, rows));
+    }
+
+    // the first row of a chunk
+    std::size_t chunk_begin(std::size_t rows, unsigned chunks, unsigned chunk) {
+      return rows * chunk / chunks;
+    }
+
+    // the chunks of a for_each_chunk() call, shared with the tasks it submits to the pool.
+    // A task that starts after every chunk was taken returns without touching the chunks
+    struct chunk_run {
+      std::atomic<unsigned> next{0};
+      unsigned chunks = 0;
+      std::function<void(unsigned)> run;
+      std::mutex mutex;
+      std::condition_variable finished;
+      unsigned done = 0;
+
+      // runs the chunks not taken yet
+      void take_chunks() {
+        for (unsigned chunk = next.fetch_add(1); chunk < chunks; chunk = next.fetch_add(1)) {
+          run(chunk);
+          std::lock_guard<std::mutex> lock(mutex);
+          if (++done == chunks) {
+            finished.notify_all();
+          }
+        }
+      }
+    };
+
+    // runs task(chunk, begin, end) for the chunks of the rows, on the threads of the pool and on the calling thread.
+    // The calling thread takes chunks too, so the chunks the busy threads of the pool do not get to are not waited for.
+    // The first exception is rethrown after every chunk finished
+    template <typename Task>
+    void for_each_chunk(const ParallelOptions &options, std::size_t rows, unsigned chunks, Task &&task) {
+      std::vector<std::exception_ptr> errors(chunks);
+      auto state = std::make_shared<chunk_run>();
+      state->chunks = chunks;
+      state->run = [&](unsigned chunk) {
+        try {
+          task(chunk, chunk_begin(rows, chunks, chunk), chunk_begin(rows, chunks, chunk + 1));
+        } catch (...) {
+          errors[chunk] = std::current_exception();
+        }
+      };
+      try {
+        for (unsigned helper = 1; helper < chunks; ++helper) {
+          options.pool->submit([state]() { state->take_chunks(); });
+        }
+      } catch (...) {
+        // the chunks without a helper are taken by the calling thread
+      }
+      state->take_chunks();
+      {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->finished.wait(lock, [&state]() { return state->done == state->chunks; });
+      }
+      for (auto &error : errors) {
+        if (error) {
+          std::rethrow_exception(error);
+        }
+      }
+    }
+
+    // decodes the rows [begin, end) by task(begin, end), split among the threads of the options
+    template <typename Task>
+    void decode_rows(const ParallelOptions &options, std::size_t rows, Task &&task) {
+      const unsigned chunks = chunk_count(options, rows);
+      if (chunks == 1) {
+        task(0, rows);
+        return;
+      }
+      for_each_chunk(options, rows, chunks, [&](unsigned, std::size_t begin, std::size_t end) { task(begin, end); });
+    }
+
+    // packs the rows by pack_row(packer, row), split among the threads of the parallel options of the packer.
+    // The chunks are packed into buffers of their own, that are appended in their order
+    template <typename PackRow>
+    void pack_rows(Packer &packer, std::size_t rows, PackRow &&pack_row) {
+      const ParallelOptions &options = packer.options().parallel;
+      const unsigned chunks = chunk_count(options, rows);
+      if (chunks == 1) {
+        for (std::size_t row = 0; row < rows; ++row) {
+          pack_row(packer, row);
+        }
+        return;
+      }
+      std::vector<std::string> packed(chunks);
+      for_each_chunk(options, rows, chunks, [&](unsigned chunk, std::size_t begin, std::size_t end) {
+        string_writer writer{packed[chunk]};
+        PackBufferAdapter<string_writer> buffer(writer);
+        Packer chunk_packer(buffer, packer.options());
+        for (std::size_t row = begin; row < end; ++row) {
+          pack_row(chunk_packer, row);
+        }
+      });
+      for (auto &chunk : packed) {
+        packer.write_packed(chunk.data(), chunk.size());
+      }
+    }
+
+    // the sizes of the packed parts the messages share, see Packable::encoded_size()
+    std::size_t optional_str_size(const std::optional<std::string> &item) {
+      return item ? packed_size::str(item->size()) : packed_size::nil();
+    }
+
+    std::size_t descriptors_size(const std::vector<field_descriptor> &fields) {
+      std::size_t size = packed_size::array_header(fields.size());
+      for (auto &item : fields) {
+        size += packed_size::array_header(item.size());
+        for (auto &desc : item) {
+          size += packed_size::str(desc.size());
+        }
+      }
+      return size;
+    }
+
+    std::size_t row_size(const std::vector<GdsFieldValue> &row) {
+      std::size_t size = packed_size::array_header(row.size());
+      for (auto &item : row) {
+        size += item.encoded_size();
+      }
+      return size;
+    }
+
+    // the rows of the columns of a query reply are counted by the columns, whatever the level is, so a wrong hit count
+    // never reads past their arrays. Without columns the hits are empty arrays, nothing is read then
+    std::size_t column_rows(const std::pmr::vector<GdsColumn> &columns, int64_t numberOfHits) {
+      const std::size_t rows = columns.empty() ? static_cast<std::size_t>(std::max<int64_t>(numberOfHits, 0)) : columns.front().size;
+      for (auto &column : columns) {
+        if (column.size != rows) {
+          throw invalid_message_error(GdsMsgType::QUERY_REPLY, "the columns differ in size");
+        }
+      }
+      return rows;
+    }
+
+    template <typename Header>
+    void validate_header(const Header &header, ValidationLevel::Enum level) {
+      if (!validates_structure(level)) {
+        return;
+      }
+      if (level == ValidationLevel::FULL && header.createTime < 0) {
+        throw invalid_message_error(GdsMsgType::HEADER_MESSAGE);
+      }
+      if (header.isFragmented) {
+        if (!(header.firstFragment.has_value() && header.lastFragment.has_value() &&
+          header.offset.has_value() && header.fds.has_value())) {
+          throw invalid_message_error(GdsMsgType::HEADER_MESSAGE);
+        }
+      } else {
+        if ((header.firstFragment.has_value() || header.lastFragment.has_value() ||
+          header.offset.has_value() || header.fds.has_value())) {
+          throw invalid_message_error(GdsMsgType::HEADER_MESSAGE);
+        }
+      }
+      if (header.dataType < 0 || header.dataType > 14) {
+        throw invalid_message_error(GdsMsgType::HEADER_MESSAGE);
+      }
+    }
+  }
+
+  void Packable::read(MessageReader &reader, const DecodeOptions &options) {
+    msgpack::object_handle handle = reader.read_object();
+    unpack(handle.get(), options);
+  }
+
+  WorkerPool::WorkerPool(unsigned threads) {
+    m_threads.reserve(threads);
+    try {
+      for (unsigned ii = 0; ii < threads; ++ii) {
+        m_threads.emplace_back([this]() { run(); });
+      }
+    } catch (const std::system_error &) {
+      // no more threads, the pool works with the ones started
+    }
+  }
+
+  WorkerPool::~WorkerPool() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stopped = true;
+    }
+    m_wakeup.notify_all();
+    for (auto &thread : m_threads) {
+      thread.join();
+    }
+  }
+
+  std::shared_ptr<WorkerPool> WorkerPool::create(unsigned threads) {
+    const unsigned cores = std::thread::hardware_concurrency();
+    if (threads == 0) {
+      threads = cores;
+    }
+    if (threads <= 1 || cores <= 1) {
+      return nullptr;
+    }
+    return std::make_shared<WorkerPool>(threads - 1);
+  }
+
+  void WorkerPool::submit(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_tasks.push_back(std::move(task));
+    }
+    m_wakeup.notify_one();
+  }
+
+  void WorkerPool::run() {
+    for (;;) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wakeup.wait(lock, [this]() { return m_stopped || !m_tasks.empty(); });
+        if (m_tasks.empty()) {
+          return;
+        }
+        task = std::move(m_tasks.front());
+        m_tasks.pop_front();
+      }
+      task();
+    }
+  }
+
+  void *MessageArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+    m_allocated += bytes;
+    return m_resource.allocate(bytes, alignment);
+  }
+
+    void GdsMessage::pack(Packer &packer) const {
+      // the body validates itself while it is packed
+      validate_header(*this, packer.options().validation);
+      packer.pack_array(11);
+      packer.pack(userName);
+      packer.pack(messageId);
+      packer.pack_int64(createTime);
+      packer.pack_int64(requestTime);
+      if (isFragmented) {
+        packer.pack_true();
+        packer.pack(firstFragment.value());
+        packer.pack(lastFragment.value());
+        packer.pack(offset.value());
+        packer.pack(fds.value());
+      } else {
+        packer.pack_false();
+    packer.pack_nil(); // first fragmented
+    packer.pack_nil(); // last fragmented
+    packer.pack_nil(); // offset
+    packer.pack_nil(); // full data size
+  }
+  packer.pack_int32(dataType); // datatype
+  if (messageBody) {
+    messageBody->pack(packer);
+  } else {
+    packer.pack_nil();
+  }
+}
+
+std::size_t GdsMessage::encoded_size() const {
+  std::size_t size = packed_size::array_header(11) + packed_size::str(userName.size()) + packed_size::str(messageId.size()) +
+                     packed_size::int64(createTime) + packed_size::int64(requestTime) + packed_size::boolean();
+  // a fragment without its fields is counted as well, pack() reports it
+  if (isFragmented) {
+    size += optional_str_size(firstFragment) + optional_str_size(lastFragment) + (offset ? packed_size::int64(*offset) : packed_size::nil()) +
+            (fds ? packed_size::int64(*fds) : packed_size::nil());
+  } else {
+    size += 4 * packed_size::nil();
+  }
+  size += packed_size::int64(dataType);
+  return size + (messageBody ? messageBody->encoded_size() : packed_size::nil());
+}
+
+void GdsMessage::unpack(const msgpack::object &object) {
+  unpack(object, DecodeOptions{});
+}
+
+void GdsMessage::unpack(const msgpack::object &object, const DecodeOptions &options) {
+  object_array data(object);
+  userName = data.at(gds_types::GdsHeader::USER).as<std::string>();
+  messageId = data.at(gds_types::GdsHeader::ID).as<std::string>();
+  createTime = data.at(gds_types::GdsHeader::CREATE_TIME).as<int64_t>();
+  requestTime = data.at(gds_types::GdsHeader::REQUEST_TIME).as<int64_t>();
+  isFragmented = data.at(gds_types::GdsHeader::FRAGMENTED).as<bool>();
+  if (isFragmented) {
+    firstFragment =
+    data.at(gds_types::GdsHeader::FIRST_FRAGMENT).as<std::string>();
+    lastFragment =
+    data.at(gds_types::GdsHeader::LAST_FRAGMENT).as<std::string>();
+    offset = data.at(gds_types::GdsHeader::OFFSET).as<int32_t>();
+    fds = data.at(gds_types::GdsHeader::FULL_DATA_SIZE).as<int32_t>();
+  } else {
+    firstFragment.reset();
+    lastFragment.reset();
+    offset.reset();
+    fds.reset();
+  }
+  dataType = data.at(gds_types::GdsHeader::DATA_TYPE).as<int32_t>();
+  // the header is checked before the body is decoded, the body checks itself while it is decoded
+  validate_header(*this, options.validation);
+
+  DecodeOptions bodyOptions = options;
+  if (isFragmented) {
+    // the data of a fragment is a slice of the packed body, see FragmentAssembler
+    messageBody.reset();
+  } else if (!reusable_body(messageBody, dataType, options)) {
+    messageBody = make_body(dataType, bodyOptions);
+  }
+if (messageBody) {
+  messageBody->unpack(data.at(gds_types::GdsHeader::DATA), bodyOptions);
+}
+}
+
+void GdsMessage::read(MessageReader &reader, const DecodeOptions &options) {
+  uint32_t size = read_header(reader, *this);
+  validate_header(*this, options.validation);
+
+  DecodeOptions bodyOptions = options;
+  if (isFragmented) {
+    // the data of a fragment is a slice of the packed body, see FragmentAssembler
+    messageBody.reset();
+  } else if (!reusable_body(messageBody, dataType, options)) {
+    messageBody = make_body(dataType, bodyOptions);
+  }
+  if (messageBody) {
+    messageBody->read(reader, bodyOptions);
+  } else {
+    reader.skip();
+  }
+  skip_values(reader, size - (GdsHeader::DATA + 1));
+}
+
+void GdsMessage::unpack(const char *data, std::size_t size, const DecodeOptions &options) {
+  MessageReader reader(data, size);
+  read(reader, options);
+}
+
+void GdsMessage::validate() const {
+  validate_header(*this, ValidationLevel::FULL);
+  if (messageBody) {
+    messageBody->validate();
+  }
+}
+
+std::string GdsMessage::to_string() const
+{
+  std::stringstream ss;
+  ss << std::boolalpha;
+  ss << '[' << '\n';
+  ss << userName;
+  ss << ", "  << '\n' << messageId;
+  ss << ", "  << '\n' << createTime;
+  ss << ", "  << '\n' << requestTime;
+  ss << ", "  << '\n' << isFragmented;
+  ss << ", "  << '\n' << firstFragment;
+  ss << ", "  << '\n' << lastFragment;
+  ss << ", "  << '\n' << offset;
+  ss << ", "  << '\n' << fds;
+  ss << ", "  << '\n' << dataType;
+  if(messageBody)
+  {
+    ss << ", "  << '\n' << messageBody->to_string();
+  }
+  else
+  {
+    ss  << '\n' << ", null";
+  }
+
+  ss  << '\n' << ']';
+  return ss.str();
+}
+
+GdsMessageHeader GdsMessageHeader::peek(const char *data, std::size_t size, ValidationLevel::Enum validation) {
+  MessageReader reader(data, size);
+  GdsMessageHeader header;
+  uint32_t count = read_header(reader, header);
+  const std::size_t begin = reader.position();
+  if (count > GdsHeader::DATA + 1) {
+    // the end of the body is only looked for if it is not the last element
+    reader.skip();
+    header.body = std::string_view(data + begin, reader.position() - begin);
+  } else {
+    header.body = std::string_view(data + begin, reader.remaining());
+  }
+  if (header.body.empty()) {
+    throw msgpack::insufficient_bytes("insufficient bytes");
+  }
+  validate_header(header, validation);
+  return header;
+}
+
+std::shared_ptr<GdsMessageData> GdsMessageHeader::decode_body(const DecodeOptions &options) const {
+  if (isFragmented) {
+    return nullptr;
+  }
+  DecodeOptions bodyOptions = options;
+  std::shared_ptr<GdsMessageData> data = make_body(dataType, bodyOptions);
+  if (data) {
+    MessageReader reader(body.data(), body.size());
+    data->read(reader, bodyOptions);
+  }
+  return data;
+}
+
+void GdsMessageHeader::decode_body_into(GdsMessageData &data, const DecodeOptions &options) const {
+  if (data.type() != dataType) {
+    throw invalid_message_error(data.type(), "the message is of type " + std::to_string(dataType));
+  }
+  if (isFragmented) {
+    throw invalid_message_error(data.type(), "the message is a fragment");
+  }
+  MessageReader reader(body.data(), body.size());
+  data.read(reader, options);
+}
+
+void GdsMessageHeader::decode(GdsMessage &message, const DecodeOptions &options) const {
+  message.userName = userName;
+  message.messageId = messageId;
+  message.createTime = createTime;
+  message.requestTime = requestTime;
+  message.isFragmented = isFragmented;
+  message.firstFragment = firstFragment;
+  message.lastFragment = lastFragment;
+  message.offset = offset;
+  message.fds = fds;
+  message.dataType = dataType;
+  // the header was checked by peek(), the body is checked while it is decoded
+  message.messageBody = decode_body(options);
+}
+
+std::string GdsMessageHeader::to_string() const
+{
+  std::stringstream ss;
+  ss << std::boolalpha;
+  ss << '[' << '\n';
+  ss << userName;
+  ss << ", "  << '\n' << messageId;
+  ss << ", "  << '\n' << createTime;
+  ss << ", "  << '\n' << requestTime;
+  ss << ", "  << '\n' << isFragmented;
+  ss << ", "  << '\n' << firstFragment;
+  ss << ", "  << '\n' << lastFragment;
+  ss << ", "  << '\n' << offset;
+  ss << ", "  << '\n' << fds;
+  ss << ", "  << '\n' << dataType;
+  ss << ", "  << '\n' << '<' << body.size() << " bytes>";
+  ss  << '\n' << ']';
+  return ss.str();
+}
+
+
+GdsHeaderTemplate::GdsHeaderTemplate(const std::string &userName)
+  : m_userName(userName) {
+  msgpack::sbuffer prefix;
+  msgpack::packer<msgpack::sbuffer> packer(prefix);
+  packer.pack_array(11);
+  packer.pack(userName);
+  m_prefix.assign(prefix.data(), prefix.size());
+}
+
+bool GdsHeaderTemplate::matches(const GdsMessage &message) const noexcept {
+  return !message.isFragmented && message.messageBody && message.userName == m_userName;
+}
+
+void GdsHeaderTemplate::pack(PackBuffer &buffer, std::string_view messageId, int64_t createTime, int64_t requestTime,
+  int32_t dataType, const Packable &body, const EncodeOptions &options) const {
+  // the header checks of GdsMessage::validate() for the variable fields, the bodies validate themselves while packing
+  if (validates_structure(options.validation) && (dataType < 0 || dataType > 14)) {
+    throw invalid_message_error(GdsMsgType::HEADER_MESSAGE);
+  }
+  if (options.validation == ValidationLevel::FULL && createTime < 0) {
+    throw invalid_message_error(GdsMsgType::HEADER_MESSAGE);
+  }
+  // not fragmented, then the first, last fragment, offset and full data size are nil
+  static constexpr char not_fragmented[] = {'\xc2', '\xc0', '\xc0', '\xc0', '\xc0'};
+
+  Packer packer(buffer, options);
+  buffer.write(m_prefix.data(), m_prefix.size());
+  packer.pack_str(static_cast<uint32_t>(messageId.size()));
+  packer.pack_str_body(messageId.data(), static_cast<uint32_t>(messageId.size()));
+  packer.pack_int64(createTime);
+  packer.pack_int64(requestTime);
+  buffer.write(not_fragmented, sizeof(not_fragmented));
+  packer.pack_int32(dataType);
+  body.pack(packer);
+}
+
+void GdsHeaderTemplate::pack(PackBuffer &buffer, const GdsMessage &message, const EncodeOptions &options) const {
+  if (!matches(message)) {
+    message.pack_into(buffer, options);
+    return;
+  }
+  pack(buffer, message.messageId, message.createTime, message.requestTime, message.dataType, *message.messageBody, options);
+}
+
+std::size_t GdsHeaderTemplate::encoded_size(const GdsMessage &message) const {
+  if (!matches(message)) {
+    return message.encoded_size();
+  }
+  // the prefix, the message id, the timestamps, the 5 bytes of a not fragmented message, the type and the body
+  return m_prefix.size() + packed_size::str(message.messageId.size()) + packed_size::int64(message.createTime) +
+         packed_size::int64(message.requestTime) + 5 + packed_size::int64(message.dataType) + message.messageBody->encoded_size();
+}
+
+
+namespace {
+  // collects the packed elements of a numeric array, so they reach the PackBuffer in a few large writes instead of one for each element
+  class chunk_writer {
+    PackBuffer &m_buffer;
+    char m_data[4096];
+    std::size_t m_size = 0;
+
+  public:
+    explicit chunk_writer(PackBuffer &buffer) : m_buffer(buffer) {}
+
+    void write(const char *data, std::size_t size) {
+      if (m_size + size > sizeof(m_data)) {
+        flush();
+      }
+      std::memcpy(m_data + m_size, data, size);
+      m_size += size;
+    }
+    void flush() {
+      m_buffer.write(m_data, m_size);
+      m_size = 0;
+    }
+  };
+
+  template <typename T>
+  void pack_numbers(Packer &packer, const std::vector<T> &items) {
+    packer.pack_array(static_cast<uint32_t>(items.size()));
+    chunk_writer chunk(packer.stream());
+    msgpack::packer<chunk_writer> chunk_packer(chunk);
+    for (T item : items) {
+      if constexpr (std::is_same_v<T, double>) {
+        chunk_packer.pack_double(item);
+      } else {
+        chunk_packer.pack_int64(item);
+      }
+    }
+    chunk.flush();
+  }
+}
+
+void GdsFieldValue::pack(Packer &packer) const {
+  visit([&packer](const auto &item) {
+    using item_t = std::decay_t<decltype(item)>;
+    if constexpr (std::is_same_v<item_t, nil_t>) {
+      packer.pack_nil();
+    } else if constexpr (std::is_same_v<item_t, bool>) {
+      item ? packer.pack_true() : packer.pack_false();
+    } else if constexpr (std::is_same_v<item_t, uint64_t>) {
+      packer.pack_uint64(item);
+    } else if constexpr (std::is_same_v<item_t, int64_t>) {
+      packer.pack_int64(item);
+    } else if constexpr (std::is_same_v<item_t, float>) {
+      packer.pack_float(item);
+    } else if constexpr (std::is_same_v<item_t, double>) {
+      packer.pack_double(item);
+    } else if constexpr (std::is_same_v<item_t, double_array_t> || std::is_same_v<item_t, integer_array_t>) {
+      pack_numbers(packer, item);
+    } else if constexpr (std::is_same_v<item_t, array_t>) {
+      packer.pack_array(item.size());
+      for (auto &obj : item) {
+        obj.pack(packer);
+      }
+    } else {
+      // string, binary and map
+      packer.pack(item);
+    }
+  });
+}
+
+std::size_t GdsFieldValue::encoded_size() const {
+  return visit([](const auto &item) -> std::size_t {
+    using item_t = std::decay_t<decltype(item)>;
+    if constexpr (std::is_same_v<item_t, nil_t>) {
+      return packed_size::nil();
+    } else if constexpr (std::is_same_v<item_t, bool>) {
+      return packed_size::boolean();
+    } else if constexpr (std::is_same_v<item_t, uint64_t>) {
+      return packed_size::uint64(item);
+    } else if constexpr (std::is_same_v<item_t, int64_t>) {
+      return packed_size::int64(item);
+    } else if constexpr (std::is_same_v<item_t, float>) {
+      return packed_size::float32();
+    } else if constexpr (std::is_same_v<item_t, double>) {
+      return packed_size::float64();
+    } else if constexpr (std::is_same_v<item_t, double_array_t>) {
+      return packed_size::array_header(item.size()) + item.size() * packed_size::float64();
+    } else if constexpr (std::is_same_v<item_t, integer_array_t>) {
+      std::size_t size = packed_size::array_header(item.size());
+      for (int64_t number : item) {
+        size += packed_size::int64(number);
+      }
+      return size;
+    } else if constexpr (std::is_same_v<item_t, array_t>) {
+      return row_size(item);
+    } else if constexpr (std::is_same_v<item_t, std::string>) {
+      return packed_size::str(item.size());
+    } else if constexpr (std::is_same_v<item_t, byte_array>) {
+      return packed_size::bin(item.size());
+    } else {
+      std::size_t size = packed_size::map_header(item.size());
+      for (auto &pair : item) {
+        size += packed_size::str(pair.first.size()) + packed_size::str(pair.second.size());
+      }
+      return size;
+    }
+  });
+}
+
+namespace {
+  // a value that already holds a string (or binary) is overwritten in place, keeping its capacity
+  void assign_string(GdsFieldValue::value_t &value, std::string_view item) {
+    if (std::string *text = std::get_if<std::string>(&value)) {
+      text->assign(item);
+    } else {
+      value.emplace<std::string>(item);
+    }
+  }
+
+  void assign_binary(GdsFieldValue::value_t &value, byte_view item) {
+    if (byte_array *bytes = std::get_if<byte_array>(&value)) {
+      bytes->assign(item.begin(), item.end());
+    } else {
+      value.emplace<byte_array>(item.begin(), item.end());
+    }
+  }
+
+  // the numeric array the value already holds (its capacity is reused), or a new one
+  template <typename T>
+  T &reuse_array(GdsFieldValue::value_t &value) {
+    if (T *items = std::get_if<T>(&value)) {
+      return *items;
+    }
+    return value.emplace<T>();
+  }
+
+  bool is_int64(const msgpack::object &obj) {
+    return obj.type == msgpack::type::NEGATIVE_INTEGER ||
+           (obj.type == msgpack::type::POSITIVE_INTEGER && obj.via.u64 <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max()));
+  }
+}
+
+void GdsFieldValue::unpack(const msgpack::object &obj) {
+  unpack_value(obj, false);
+}
+
+void GdsFieldValue::unpack(const msgpack::object &obj, const DecodeOptions &options) {
+  unpack_value(obj, options.numeric_arrays);
+}
+
+void GdsFieldValue::unpack_value(const msgpack::object &obj, bool numeric_arrays) {
+  type = obj.type;
+  switch (obj.type) {
+    case msgpack::type::NIL:
+    value.emplace<nil_t>();
+    break;
+    case msgpack::type::BOOLEAN:
+    value.emplace<bool>(obj.via.boolean);
+    break;
+    case msgpack::type::POSITIVE_INTEGER:
+    value.emplace<uint64_t>(obj.via.u64);
+    break;
+    case msgpack::type::NEGATIVE_INTEGER:
+    value.emplace<int64_t>(obj.via.i64);
+    break;
+    case msgpack::type::FLOAT32:
+    value.emplace<float>(static_cast<float>(obj.via.f64));
+    break;
+    case msgpack::type::FLOAT64:
+    value.emplace<double>(obj.via.f64);
+    break;
+    case msgpack::type::STR:
+    assign_string(value, std::string_view(obj.via.str.ptr, obj.via.str.size));
+    break;
+    case msgpack::type::BIN:
+    assign_binary(value, byte_view{reinterpret_cast<const uint8_t *>(obj.via.bin.ptr), obj.via.bin.size});
+    break;
+    case msgpack::type::ARRAY: {
+      const msgpack::object *begin = obj.via.array.ptr;
+      const msgpack::object *end = begin + obj.via.array.size;
+      if (numeric_arrays && begin != end &&
+          std::all_of(begin, end, [](const msgpack::object &item) { return item.type == msgpack::type::FLOAT64; })) {
+        double_array_t &values = reuse_array<double_array_t>(value);
+        values.resize(obj.via.array.size);
+        std::transform(begin, end, values.begin(), [](const msgpack::object &item) { return item.via.f64; });
+      } else if (numeric_arrays && begin != end && std::all_of(begin, end, is_int64)) {
+        integer_array_t &values = reuse_array<integer_array_t>(value);
+        values.resize(obj.via.array.size);
+        std::transform(begin, end, values.begin(), [](const msgpack::object &item) { return item.via.i64; });
+      } else {
+        array_t &values = value.emplace<value_box<array_t>>().get();
+        values.resize(obj.via.array.size);
+        for (uint32_t ii = 0; ii < obj.via.array.size; ++ii) {
+          values[ii].unpack_value(obj.via.array.ptr[ii], numeric_arrays);
+        }
+      }
+    } break;
+    case msgpack::type::MAP:
+    obj.convert(value.emplace<value_box<map_t>>().get());
+    break;
+    default:
+    throw invalid_message_error(GdsMsgType::UNKNOWN);
+  }
+}
+
+void GdsFieldValue::read(MessageReader &reader, const DecodeOptions &options) {
+  type = reader.next_type();
+  switch (type) {
+    case msgpack::type::NIL:
+    reader.read_nil();
+    value.emplace<nil_t>();
+    break;
+    case msgpack::type::BOOLEAN:
+    value.emplace<bool>(reader.read_bool());
+    break;
+    case msgpack::type::POSITIVE_INTEGER:
+    value.emplace<uint64_t>(reader.read_uint64());
+    break;
+    case msgpack::type::NEGATIVE_INTEGER:
+    value.emplace<int64_t>(reader.read_int64());
+    break;
+    case msgpack::type::FLOAT32:
+    value.emplace<float>(static_cast<float>(reader.read_double()));
+    break;
+    case msgpack::type::FLOAT64:
+    value.emplace<double>(reader.read_double());
+    break;
+    case msgpack::type::STR:
+    assign_string(value, reader.read_string_view());
+    break;
+    case msgpack::type::BIN:
+    assign_binary(value, reader.read_binary_view());
+    break;
+    case msgpack::type::ARRAY: {
+      const uint32_t count = reader.read_array_header();
+      // the arrays of only float64 or only integer elements are converted in one go if the options ask for it,
+      // the others element by element
+      if (options.numeric_arrays && count > 0) {
+        const msgpack::type::object_type first = reader.next_type();
+        if (first == msgpack::type::FLOAT64 && reader.read_doubles(count, reuse_array<double_array_t>(value))) {
+          break;
+        }
+        if ((first == msgpack::type::POSITIVE_INTEGER || first == msgpack::type::NEGATIVE_INTEGER) &&
+            reader.read_integers(count, reuse_array<integer_array_t>(value))) {
+          break;
+        }
+      }
+      array_t &values = value.emplace<value_box<array_t>>().get();
+      values.resize(count);
+      for (auto &item : values) {
+        item.read(reader, options);
+      }
+    } break;
+    case msgpack::type::MAP: {
+      // the entries are appended in the order they are read, the map is sorted once at the end
+      const uint32_t count = reader.read_map_header();
+      map_t &values = value.emplace<value_box<map_t>>().get();
+      values.reserve(std::min<std::size_t>(count, reader.remaining() / 2));
+      for (uint32_t ii = 0; ii < count; ++ii) {
+        auto &item = values.append();
+        item.first.assign(reader.read_string_view());
+        item.second.assign(reader.read_string_view());
+      }
+      values.sort();
+    } break;
+    default:
+    throw invalid_message_error(GdsMsgType::UNKNOWN);
+  }
+}
+
+void GdsFieldValue::validate() const {}
+
+GdsFieldValue::array_t GdsFieldValue::to_array() const {
+  if (const array_t *items = get_if<array_t>()) {
+    return *items;
+  }
+  array_t items;
+  if (const double_array_t *doubles = get_if<double_array_t>()) {
+    items.reserve(doubles->size());
+    for (double item : *doubles) {
+      items.emplace_back(item);
+    }
+  } else if (const integer_array_t *integers = get_if<integer_array_t>()) {
+    items.reserve(integers->size());
+    for (int64_t item : *integers) {
+      items.emplace_back(item);
+    }
+  } else {
+    throw std::bad_variant_access();
+  }
+  return items;
+}
+
+
+std::string GdsFieldValue::to_string() const {
+  std::stringstream ss;
+  visit([&ss](const auto &item) {
+    using item_t = std::decay_t<decltype(item)>;
+    if constexpr (std::is_same_v<item_t, nil_t>) {
+      ss << "null";
+    } else if constexpr (std::is_same_v<item_t, bool>) {
+      ss << (item ? "true" : "false");
+    } else if constexpr (std::is_same_v<item_t, byte_array>) {
+      ss << "<" << item.size() << "bytes>";
+    } else {
+      ss << item;
+    }
+  });
+  return ss.str();
+}
+
+
+StringDictionary::StringDictionary(std::size_t max_size)
+  : m_blocks((std::max<std::size_t>(max_size, 1) + BLOCK_SIZE - 1) / BLOCK_SIZE),
+    m_max_size(std::min<std::size_t>(std::max<std::size_t>(max_size, 1), npos)) {
+  // the nil cells refer to the empty string, so it is always there
+  intern(std::string_view());
+}
+
+uint32_t StringDictionary::intern(std::string_view word) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_codes.find(word);
+  if (it != m_codes.end()) {
+    return it->second;
+  }
+  if (m_size == m_max_size) {
+    return npos;
+  }
+  std::unique_ptr<std::string_view[]> &block = m_blocks[m_size / BLOCK_SIZE];
+  if (!block) {
+    // the readers never look at a block before a code in it was handed out, so it needs no atomic publication
+    block.reset(new std::string_view[BLOCK_SIZE]);
+  }
+  char *stored = static_cast<char *>(m_bytes.allocate(std::max<std::size_t>(word.size(), 1), 1));
+  std::memcpy(stored, word.data(), word.size());
+  const uint32_t code = static_cast<uint32_t>(m_size);
+  block[code % BLOCK_SIZE] = std::string_view(stored, word.size());
+  m_codes.emplace(block[code % BLOCK_SIZE], code);
+  ++m_size;
+  m_byte_count += word.size();
+  return code;
+}
+
+std::size_t StringDictionary::size() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_size;
+}
+
+std::size_t StringDictionary::byte_count() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_byte_count;
+}
+
+DictionaryCache::DictionaryCache(std::size_t capacity, std::size_t dictionary_size)
+  : m_capacity(capacity), m_dictionary_size(dictionary_size) {
+  m_scrolls.reserve(capacity);
+  m_order.reserve(capacity);
+}
+
+std::shared_ptr<StringDictionary> DictionaryCache::dictionary(const std::string &scroll_id, std::size_t field) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (scroll_id.empty() || m_capacity == 0) {
+    return std::make_shared<StringDictionary>(m_dictionary_size);
+  }
+  auto it = m_scrolls.find(scroll_id);
+  if (it == m_scrolls.end()) {
+    if (m_order.size() < m_capacity) {
+      m_order.push_back(scroll_id);
+    } else {
+      m_scrolls.erase(m_order[m_next]);
+      m_order[m_next] = scroll_id;
+      m_next = (m_next + 1) % m_capacity;
+    }
+    it = m_scrolls.emplace(scroll_id, dictionaries_t()).first;
+  }
+  dictionaries_t &dictionaries = it->second;
+  if (dictionaries.size() <= field) {
+    dictionaries.resize(field + 1);
+  }
+  if (!dictionaries[field]) {
+    dictionaries[field] = std::make_shared<StringDictionary>(m_dictionary_size);
+  }
+  return dictionaries[field];
+}
+
+std::size_t DictionaryCache::size() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_scrolls.size();
+}
+
+void DictionaryCache::clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_scrolls.clear();
+  m_order.clear();
+  m_next = 0;
+}
+
+namespace {
+  // the cells decoded so far are moved to offsets + bytes, the column is not encoded from here on
+  void decode_dictionary(GdsColumn &column) {
+    column.offsets.assign(1, 0);
+    column.offsets.reserve(column.codes.capacity() + 1);
+    for (uint32_t code : column.codes) {
+      column.bytes.append(column.dictionary->word(code));
+      column.offsets.push_back(static_cast<uint32_t>(column.bytes.size()));
+    }
+    column.codes.clear();
+    column.codes.shrink_to_fit();
+    column.dictionary.reset();
+  }
+
+  // appends a string or binary cell (empty for a nil one), a dictionary encoded column falls back to the bytes once its dictionary is full
+  void append_bytes(GdsColumn &column, std::string_view cell) {
+    if (column.dictionary) {
+      const uint32_t code = cell.empty() ? 0 : column.dictionary->intern(cell);
+      if (code != StringDictionary::npos) {
+        column.codes.push_back(code);
+        return;
+      }
+      decode_dictionary(column);
+    }
+    if (column.bytes.size() + cell.size() > std::numeric_limits<uint32_t>::max()) {
+      throw invalid_message_error(GdsMsgType::QUERY_REPLY, "the column is too large");
+    }
+    column.bytes.append(cell);
+    column.offsets.push_back(static_cast<uint32_t>(column.bytes.size()));
+  }
+}
+
+GdsColumn::GdsColumn(const field_descriptor &descriptor, std::pmr::memory_resource *resource)
+  : type(type_of(descriptor[1])), validity(resource), integers(resource), doubles(resource), booleans(resource),
+    offsets(resource), bytes(resource), values(resource), codes(resource) {
+  offsets.push_back(0);
+}
+
+void GdsColumn::reset(const field_descriptor &descriptor) {
+  type = type_of(descriptor[1]);
+  size = 0;
+  nil_count = 0;
+  validity.clear();
+  integers.clear();
+  doubles.clear();
+  booleans.clear();
+  offsets.assign(1, 0);
+  bytes.clear();
+  values.clear();
+  dictionary.reset();
+  codes.clear();
+}
+
+GdsColumn::Type::Enum GdsColumn::type_of(const std::string &field_type) {
+  if (field_type == "INTEGER" || field_type == "LONG" || field_type == "DATETIME") {
+    return Type::INTEGER;
+  }
+  if (field_type == "DOUBLE") {
+    return Type::DOUBLE;
+  }
+  if (field_type == "BOOLEAN") {
+    return Type::BOOLEAN;
+  }
+  if (field_type == "KEYWORD" || field_type == "TEXT") {
+    return Type::STRING;
+  }
+  if (field_type == "BINARY") {
+    return Type::BINARY;
+  }
+  return Type::VALUE;
+}
+
+void GdsColumn::reserve(std::size_t rows, std::size_t byte_count) {
+  validity.reserve((rows + 63) / 64);
+  switch (type) {
+    case Type::INTEGER:
+    integers.reserve(rows);
+    break;
+    case Type::DOUBLE:
+    doubles.reserve(rows);
+    break;
+    case Type::BOOLEAN:
+    booleans.reserve(rows);
+    break;
+    case Type::STRING:
+    case Type::BINARY:
+    if (dictionary) {
+      codes.reserve(rows);
+      break;
+    }
+    offsets.reserve(rows + 1);
+    bytes.reserve(byte_count);
+    break;
+    case Type::VALUE:
+    values.reserve(rows);
+    break;
+  }
+}
+
+void GdsColumn::push_back(const msgpack::object &cell) {
+  if ((size & 63) == 0) {
+    validity.push_back(0);
+  }
+  const bool nil = cell.is_nil();
+  if (nil) {
+    ++nil_count;
+  } else {
+    validity.back() |= uint64_t(1) << (size & 63);
+  }
+
+  switch (type) {
+    case Type::INTEGER:
+    integers.push_back(nil ? 0 : cell.as<int64_t>());
+    break;
+    case Type::DOUBLE:
+    doubles.push_back(nil ? 0.0 : cell.as<double>());
+    break;
+    case Type::BOOLEAN:
+    booleans.push_back(nil ? 0 : cell.as<bool>());
+    break;
+    case Type::STRING:
+    case Type::BINARY:
+    if (!nil && cell.type != (type == Type::STRING ? msgpack::type::STR : msgpack::type::BIN)) {
+      throw msgpack::type_error();
+    }
+    append_bytes(*this, nil ? std::string_view() : std::string_view(cell.via.str.ptr, cell.via.str.size));
+    break;
+    case Type::VALUE:
+    values.emplace_back();
+    values.back().unpack(cell);
+    break;
+  }
+  ++size;
+}
+
+void GdsColumn::push_back(MessageReader &reader) {
+  if ((size & 63) == 0) {
+    validity.push_back(0);
+  }
+  const bool nil = reader.next_is_nil();
+  if (nil) {
+    ++nil_count;
+    if (type != Type::VALUE) {
+      reader.read_nil();
+    }
+  } else {
+    validity.back() |= uint64_t(1) << (size & 63);
+  }
+
+  switch (type) {
+    case Type::INTEGER:
+    integers.push_back(nil ? 0 : reader.read_int64());
+    break;
+    case Type::DOUBLE:
+    doubles.push_back(nil ? 0.0 : reader.read_double());
+    break;
+    case Type::BOOLEAN:
+    booleans.push_back(nil ? 0 : reader.read_bool());
+    break;
+    case Type::STRING:
+    case Type::BINARY:
+    if (!nil && reader.next_type() != (type == Type::STRING ? msgpack::type::STR : msgpack::type::BIN)) {
+      throw msgpack::type_error();
+    }
+    append_bytes(*this, nil ? std::string_view() : reader.read_string_view());
+    break;
+    case Type::VALUE:
+    values.emplace_back().read(reader, DecodeOptions{});
+    break;
+  }
+  ++size;
+}
+
+GdsFieldValue GdsColumn::value(std::size_t row) const {
+  if (type == Type::VALUE) {
+    return values[row];
+  }
+  GdsFieldValue item;
+  if (is_nil(row)) {
+    return item;
+  }
+  switch (type) {
+    case Type::INTEGER:
+    // the same alternative as the value decoded from the rows
+    if (integers[row] >= 0) {
+      item.set(static_cast<uint64_t>(integers[row]));
+    } else {
+      item.set(integers[row]);
+    }
+    break;
+    case Type::DOUBLE:
+    item.set(doubles[row]);
+    break;
+    case Type::BOOLEAN:
+    item.set(boolean(row));
+    break;
+    case Type::STRING:
+    item.set(std::string(string(row)));
+    break;
+    case Type::BINARY:
+    item.set(binary(row).to_array());
+    break;
+    case Type::VALUE:
+    break;
+  }
+  return item;
+}
+
+void GdsColumn::pack(Packer &packer, std::size_t row) const {
+  if (type == Type::VALUE) {
+    values[row].pack(packer);
+    return;
+  }
+  if (is_nil(row)) {
+    packer.pack_nil();
+    return;
+  }
+  switch (type) {
+    case Type::INTEGER:
+    packer.pack_int64(integers[row]);
+    break;
+    case Type::DOUBLE:
+    packer.pack_double(doubles[row]);
+    break;
+    case Type::BOOLEAN:
+    booleans[row] ? packer.pack_true() : packer.pack_false();
+    break;
+    case Type::STRING: {
+      std::string_view item = string(row);
+      packer.pack_str(item.size());
+      packer.pack_str_body(item.data(), item.size());
+    } break;
+    case Type::BINARY: {
+      byte_view item = binary(row);
+      packer.pack_bin(item.size);
+      packer.pack_bin_body(reinterpret_cast<const char *>(item.data), item.size);
+    } break;
+    case Type::VALUE:
+    break;
+  }
+}
+
+std::size_t GdsColumn::encoded_size(std::size_t row) const {
+  if (type == Type::VALUE) {
+    return values[row].encoded_size();
+  }
+  if (is_nil(row)) {
+    return packed_size::nil();
+  }
+  switch (type) {
+    case Type::INTEGER:
+    return packed_size::int64(integers[row]);
+    case Type::DOUBLE:
+    return packed_size::float64();
+    case Type::BOOLEAN:
+    return packed_size::boolean();
+    case Type::STRING:
+    return packed_size::str(string(row).size());
+    case Type::BINARY:
+    return packed_size::bin(binary(row).size);
+    case Type::VALUE:
+    break;
+  }
+  return 0;
+}
+
+std::string GdsColumn::to_string() const {
+  std::stringstream ss;
+  ss << '[';
+  for (std::size_t row = 0; row < size; ++row) {
+    ss << (row ? ", " : "") << '\n' << value(row);
+  }
+  ss << '\n' << ']';
+  return ss.str();
+}
+
+
+
+void EventReplyBody::pack(Packer &packer) const {
+  validate_rules(*this, packer.options().validation);
+  for (auto &eventResult : results) {
+    packer.pack_array(4);
+
+    packer.pack_int32(eventResult.status);
+    packer.pack(eventResult.notification);
+
+    packer.pack_array(eventResult.fieldDescriptor.size());
+    for (auto &descriptor : eventResult.fieldDescriptor) {
+      packer.pack_array(descriptor.size());
+      for (auto &item : descriptor) {
+        packer.pack(item);
+      }
+    }
+
+    packer.pack_array(eventResult.subResults.size());
+    for (auto &subResult : eventResult.subResults) {
+      packer.pack_array(6);
+      packer.pack_int32(subResult.status);
+
+      if (subResult.id.has_value()) {
+        packer.pack(subResult.id.value());
+      } else {
+        packer.pack_nil();
+      }
+      if (subResult.tableName.has_value()) {
+        packer.pack(subResult.tableName.value());
+      } else {
+        packer.pack_nil();
+      }
+      if (subResult.created.has_value()) {
+        subResult.created.value() ? packer.pack_true() : packer.pack_false();
+      } else {
+        packer.pack_nil();
+      }
+      if (subResult.version.has_value()) {
+        packer.pack(subResult.version.value());
+      } else {
+        packer.pack_nil();
+      }
+      if (subResult.values.has_value()) {
+        packer.pack_array(subResult.values.value().size());
+        for (auto &fieldValue : subResult.values.value()) {
+          fieldValue.pack(packer);
+        }
+      } else {
+        packer.pack_nil();
+      }
+    }
+  }
+}
+
+std::size_t EventReplyBody::encoded_size() const {
+  std::size_t size = 0;
+  for (auto &eventResult : results) {
+    size += packed_size::array_header(4) + packed_size::int64(eventResult.status) + packed_size::str(eventResult.notification.size());
+
+    size += packed_size::array_header(eventResult.fieldDescriptor.size());
+    for (auto &descriptor : eventResult.fieldDescriptor) {
+      size += packed_size::array_header(descriptor.size());
+      for (auto &item : descriptor) {
+        size += packed_size::str(item.size());
+      }
+    }
+
+    size += packed_size::array_header(eventResult.subResults.size());
+    for (auto &subResult : eventResult.subResults) {
+      size += packed_size::array_header(6) + packed_size::int64(subResult.status);
+      size += optional_str_size(subResult.id);
+      size += optional_str_size(subResult.tableName);
+      size += subResult.created.has_value() ? packed_size::boolean() : packed_size::nil();
+      size += optional_str_size(subResult.version);
+      size += subResult.values.has_value() ? row_size(subResult.values.value()) : packed_size::nil();
+    }
+  }
+  return size;
+}
+
+void EventReplyBody::unpack(const msgpack::object &packer) {
+  unpack(packer, DecodeOptions{});
+}
+
+void EventReplyBody::unpack(const msgpack::object &packer, const DecodeOptions &options) {
+  object_array eventResults(packer);
+
+  results.clear();
+  results.reserve(eventResults.size());
+  for (auto &object : eventResults) {
+    object_array currentData(object);
+
+    GdsEventResult &currentResult = results.emplace_back();
+
+    currentResult.status = currentData.at(0).as<int32_t>();
+    if (!currentData.at(1).is_nil()) {
+      currentResult.notification = currentData.at(1).as<std::string>();
+    }
+
+    object_array descriptors(currentData.at(2));
+    currentResult.fieldDescriptor.reserve(descriptors.size());
+    for (auto &item : descriptors) {
+      currentResult.fieldDescriptor.emplace_back(descriptor_of(item));
+    }
+
+    object_array subResults(currentData.at(3));
+    currentResult.subResults.reserve(subResults.size());
+
+
+    for (auto &subResultObj : subResults) {
+      object_array subRes(subResultObj);
+      EventSubResult &currentSubResult = currentResult.subResults.emplace_back();
+
+      currentSubResult.status = subRes.at(0).as<int32_t>();
+      
+      if (subRes.size()>1 && !subRes.at(1).is_nil()) {
+        currentSubResult.id = subRes.at(1).as<std::string>();
+      }
+
+      if (subRes.size()>2 && !subRes.at(2).is_nil()) {
+        currentSubResult.tableName = subRes.at(2).as<std::string>();
+      }
+
+      if (subRes.size()>3 && !subRes.at(3).is_nil()) {
+        currentSubResult.created = subRes.at(3).as<bool>();
+      }
+
+      if (subRes.size()>4 && !subRes.at(4).is_nil()) {
+        currentSubResult.version = subRes.at(4).as<std::string>();
+      }
+
+      if (subRes.size()>5 && !subRes.at(5).is_nil()) {
+        object_array fieldValues(subRes.at(5));
+
+        std::vector<GdsFieldValue> &values = currentSubResult.values.emplace(fieldValues.size());
+        for (std::size_t ii = 0; ii < fieldValues.size(); ++ii) {
+          values[ii].unpack(fieldValues.at(ii), options);
+        }
+      }
+    }
+  }
+
+  validate_rules(*this, options.validation);
+}
+
+void EventReplyBody::read(MessageReader &reader, const DecodeOptions &options) {
+  uint32_t resultCount = reader.read_array_header();
+
+  results.clear();
+  results.reserve(resultCount);
+  for (uint32_t rr = 0; rr < resultCount; ++rr) {
+    uint32_t resultSize = read_array_of(reader, 4, GdsMsgType::EVENT_REPLY);
+    GdsEventResult &currentResult = results.emplace_back();
+
+    currentResult.status = reader.read_int32();
+    if (!reader.try_read_nil()) {
+      currentResult.notification = reader.read_string();
+    }
+
+    uint32_t descriptorCount = reader.read_array_header();
+    currentResult.fieldDescriptor.reserve(descriptorCount);
+    for (uint32_t ii = 0; ii < descriptorCount; ++ii) {
+      currentResult.fieldDescriptor.emplace_back(read_descriptor(reader, GdsMsgType::EVENT_REPLY));
+    }
+
+    uint32_t subResultCount = reader.read_array_header();
+    currentResult.subResults.reserve(subResultCount);
+    for (uint32_t ss = 0; ss < subResultCount; ++ss) {
+      uint32_t subSize = read_array_of(reader, 1, GdsMsgType::EVENT_REPLY);
+      EventSubResult &currentSubResult = currentResult.subResults.emplace_back();
+
+      currentSubResult.status = reader.read_int32();
+      if (subSize > 1) {
+        currentSubResult.id = read_optional_string(reader);
+      }
+      if (subSize > 2) {
+        currentSubResult.tableName = read_optional_string(reader);
+      }
+      if (subSize > 3 && !reader.try_read_nil()) {
+        currentSubResult.created = reader.read_bool();
+      }
+      if (subSize > 4) {
+        currentSubResult.version = read_optional_string(reader);
+      }
+      if (subSize > 5 && !reader.try_read_nil()) {
+        std::vector<GdsFieldValue> &values = currentSubResult.values.emplace(reader.read_array_header());
+        for (auto &value : values) {
+          value.read(reader, options);
+        }
+      }
+      if (subSize > 6) {
+        skip_values(reader, subSize - 6);
+      }
+    }
+    skip_values(reader, resultSize - 4);
+  }
+
+  validate_rules(*this, options.validation);
+}
+
+void EventReplyBody::validate() const {
+  // skip
+}
+
+
+
+std::string EventReplyBody::to_string() const
+{
+  std::stringstream ss;
+  ss << results;
+  return ss.str();
+}
+
+
+void AttachmentResult::pack(Packer &packer) const {
+  SchemaCodec<AttachmentResult>::pack(*this, packer);
+}
+
+std::size_t AttachmentResult::encoded_size() const {
+  return SchemaCodec<AttachmentResult>::encoded_size(*this);
+}
+
+void AttachmentResult::unpack(const msgpack::object &object) {
+  SchemaCodec<AttachmentResult>::unpack(*this, object);
+}
+
+void AttachmentResult::unpack(const msgpack::object &object, const DecodeOptions &options) {
+  SchemaCodec<AttachmentResult>::unpack(*this, object, options);
+}
+
+void AttachmentResult::read(MessageReader &reader, const DecodeOptions &options) {
+  SchemaCodec<AttachmentResult>::read(*this, reader, options);
+}
+void AttachmentResult::validate() const {}
+
+
+std::string AttachmentResult::to_string() const
+{
+  std::stringstream ss;
+  ss << '[' << '\n';
+  ss << requestIDs;
+  ss << ", "  << '\n' << ownerTable;
+  ss << ", "  << '\n' << attachmentID;
+  ss << ", "  << '\n' << ownerIDs;
+  ss << ", "  << '\n' << meta;
+  ss << ", "  << '\n' << ttl;
+  ss << ", "  << '\n' << to_valid;
+  if(attachment)
+  {
+    ss << ", "  << '\n' << "<" << attachment.value().size() << " bytes>";
+  }
+  else
+  {
+    ss << ", "  << '\n' << attachment;
+  }
+  ss  << '\n' << ']';
+  return ss.str();
+}
+
+
+
+void AttachmentRequestBody::pack(Packer &packer) const {
+  SchemaCodec<AttachmentRequestBody>::pack(*this, packer);
+}
+
+std::size_t AttachmentRequestBody::encoded_size() const {
+  return SchemaCodec<AttachmentRequestBody>::encoded_size(*this);
+}
+
+void AttachmentRequestBody::unpack(const msgpack::object &object) {
+  SchemaCodec<AttachmentRequestBody>::unpack(*this, object);
+}
+
+void AttachmentRequestBody::unpack(const msgpack::object &object, const DecodeOptions &options) {
+  SchemaCodec<AttachmentRequestBody>::unpack(*this, object, options);
+}
+
+void AttachmentRequestBody::read(MessageReader &reader, const DecodeOptions &options) {
+  SchemaCodec<AttachmentRequestBody>::read(*this, reader, options);
+}
+void AttachmentRequestBody::validate() const {}
+
+
+std::string AttachmentRequestBody::to_string() const
+{
+  return schema_to_string(*this);
+}
+
+
+
+void AttachmentResponse::pack(Packer &packer) const {
+  SchemaCodec<AttachmentResponse>::pack(*this, packer);
+}
+
+std::size_t AttachmentResponse::encoded_size() const {
+  return SchemaCodec<AttachmentResponse>::encoded_size(*this);
+}
+
+void AttachmentResponse::unpack(const msgpack::object &object) {
+  SchemaCodec<AttachmentResponse>::unpack(*this, object);
+}
+
+void AttachmentResponse::unpack(const msgpack::object &object, const DecodeOptions &options) {
+  SchemaCodec<AttachmentResponse>::unpack(*this, object, options);
+}
+
+void AttachmentResponse::read(MessageReader &reader, const DecodeOptions &options) {
+  SchemaCodec<AttachmentResponse>::read(*this, reader, options);
+}
+void AttachmentResponse::validate() const {}
+
+
+std::string AttachmentResponse::to_string() const
+{
+  return schema_to_string(*this);
+}
+
+
+void AttachmentResponseBody::pack(Packer &packer) const {
+  SchemaCodec<AttachmentResponseBody>::pack(*this, packer);
+}
+
+std::size_t AttachmentResponseBody::encoded_size() const {
+  return SchemaCodec<AttachmentResponseBody>::encoded_size(*this);
+}
+
+void AttachmentResponseBody::unpack(const msgpack::object &object) {
+  SchemaCodec<AttachmentResponseBody>::unpack(*this, object);
+}
+
+void AttachmentResponseBody::unpack(const msgpack::object &object, const DecodeOptions &options) {
+  SchemaCodec<AttachmentResponseBody>::unpack(*this, object, options);
+}
+
+void AttachmentResponseBody::read(MessageReader &reader, const DecodeOptions &options) {
+  SchemaCodec<AttachmentResponseBody>::read(*this, reader, options);
+}
+void AttachmentResponseBody::validate() const { result.validate(); }
+
+
+std::string AttachmentResponseBody::to_string() const
+{
+  return schema_to_string(*this);
+}
+
+
+void EventDocumentResult::pack(
+  Packer &packer) const {
+  validate_rules(*this, packer.options().validation);
+  packer.pack_array(3);
+  packer.pack_int32(status_code);
+  if (notification.has_value()) {
+    packer.pack(notification.value());
+  } else {
+    packer.pack_nil();
+  }
+  packer.pack_map(0);
+}
+
+std::size_t EventDocumentResult::encoded_size() const {
+  return packed_size::array_header(3) + packed_size::int64(status_code) + optional_str_size(notification) + packed_size::map_header(0);
+}
+
+void EventDocumentResult::unpack(const msgpack::object &object) {
+  unpack(object, DecodeOptions{});
+}
+
+void EventDocumentResult::unpack(const msgpack::object &object, const DecodeOptions &options) {
+  object_array data(object);
+  status_code = data.at(0).as<int32_t>();
+  if (!data.at(1).is_nil()) {
+    notification = data.at(1).as<std::string>();
+  } else {
+    notification.reset();
+  }
+  validate_rules(*this, options.validation);
+}
+void EventDocumentResult::validate() const {}
+
+
+std::string EventDocumentResult::to_string() const
+{
+  std::stringstream ss;
+  ss << '[' << '\n';
+  ss << status_code;
+  ss << ", " << '\n' << notification;
+  ss << ", " << '\n' << returnings;
+  ss  << '\n' << ']';
+  return ss.str();
+}
+
+
+void QueryContextDescriptor::pack(
+  Packer &packer) const {
+  packer.pack_array(9);
+
+  packer.pack(scroll_id);
+  packer.pack(select_query);
+  packer.pack_int64(delivered_hits);
+  packer.pack_int64(query_start_time);
+  packer.pack(consistency_type);
+  packer.pack(last_bucket_id);
+  packer.pack_array(2);
+  packer.pack(gds_holder.at(0));
+  packer.pack(gds_holder.at(1));
+
+  packer.pack_array(field_values.size());
+  for (auto &item : field_values) {
+    item.pack(packer);
+  }
+
+  packer.pack_array(partition_names.size());
+  for (auto &item : partition_names) {
+    packer.pack(item);
+  }
+}
+
+std::size_t QueryContextDescriptor::encoded_size() const {
+  std::size_t size = packed_size::array_header(9) + packed_size::str(scroll_id.size()) + packed_size::str(select_query.size()) +
+                     packed_size::int64(delivered_hits) + packed_size::int64(query_start_time) +
+                     packed_size::str(consistency_type.size()) + packed_size::str(last_bucket_id.size());
+  size += packed_size::array_header(2) + packed_size::str(gds_holder.at(0).size()) + packed_size::str(gds_holder.at(1).size());
+  size += row_size(field_values);
+  size += packed_size::array_header(partition_names.size());
+  for (auto &item : partition_names) {
+    size += packed_size::str(item.size());
+  }
+  return size;
+}
+void QueryContextDescriptor::unpack(const msgpack::object &object) {
+  object_array data(object);
+  scroll_id = data.at(0).as<std::string>();
+  select_query = data.at(1).as<std::string>();
+  delivered_hits = data.at(2).as<int64_t>();
+  query_start_time = data.at(3).as<int64_t>();
+  consistency_type = data.at(4).as<std::string>();
+  last_bucket_id = data.at(5).as<std::string>();
+
+  std::vector<std::string> gdsholders =
+  data.at(6).as<std::vector<std::string>>();
+  gds_holder[0] = gdsholders.at(0);
+  gds_holder[1] = gdsholders.at(1);
+
+  // the field values are not decoded, the element only has to be an array
+  if (data.at(7).type != msgpack::type::ARRAY) {
+    throw msgpack::type_error();
+  }
+  partition_names = data.at(8).as<std::vector<std::string>>();
+}
+
+void QueryContextDescriptor::read(MessageReader &reader, const DecodeOptions &options) {
+  uint32_t size = read_array_of(reader, 9, GdsMsgType::QUERY_REPLY);
+  // the strings are assigned in place, the descriptor of a reused body (the same query, the next page) keeps their capacity
+  scroll_id.assign(reader.read_string_view());
+  select_query.assign(reader.read_string_view());
+  delivered_hits = reader.read_int64();
+  query_start_time = reader.read_int64();
+  consistency_type.assign(reader.read_string_view());
+  last_bucket_id.assign(reader.read_string_view());
+
+  uint32_t holders = read_array_of(reader, 2, GdsMsgType::QUERY_REPLY);
+  gds_holder[0].assign(reader.read_string_view());
+  gds_holder[1].assign(reader.read_string_view());
+  skip_values(reader, holders - 2);
+
+  // the field values are not decoded, the element only has to be an array
+  if (reader.next_type() != msgpack::type::ARRAY) {
+    throw msgpack::type_error();
+  }
+  reader.skip();
+
+  partition_names.resize(reader.read_array_header());
+  for (auto &name : partition_names) {
+    name.assign(reader.read_string_view());
+  }
+  skip_values(reader, size - 9);
+}
+
+void QueryContextDescriptor::validate() const {}
+
+
+std::string QueryContextDescriptor::to_string() const
+{
+  std::stringstream ss;
+  ss << '[' << '\n';
+  ss << scroll_id ;
+  ss << ", "  << '\n' << select_query ;
+  ss << ", "  << '\n' << delivered_hits;
+  ss << ", "  << '\n' << query_start_time;
+  ss << ", "  << '\n' << consistency_type;
+  ss << ", "  << '\n' << last_bucket_id;
+  ss << ", "  << '\n' << gds_holder ;
+  ss << ", "  << '\n' << field_values;
+  ss << ", "  << '\n' << partition_names;
+  ss << '\n' << ']';
+  return ss.str();
+}
+
+
+namespace {
+  // FNV-1a, the packed descriptors are short and hashed once per page. The hash of a prefix can be continued
+  uint64_t hash_bytes(std::string_view bytes, uint64_t hash = 14695981039346656037ull) {
+    for (char item : bytes) {
+      hash ^= static_cast<uint8_t>(item);
+      hash *= 1099511628211ull;
+    }
+    return hash;
+  }
+
+  // hashes the bytes written to it, like hash_bytes() does their concatenation
+  class hashing_buffer : public PackBuffer {
+    uint64_t m_hash = hash_bytes(std::string_view());
+
+  public:
+    void write(const char *data, std::size_t size) override { m_hash = hash_bytes(std::string_view(data, size), m_hash); }
+
+    uint64_t hash() const noexcept { return m_hash; }
+  };
+
+  // compares the bytes written to it with the expected ones
+  class comparing_buffer : public PackBuffer {
+    std::string_view m_expected;
+    std::size_t m_position = 0;
+    bool m_equal = true;
+
+  public:
+    explicit comparing_buffer(std::string_view expected) : m_expected(expected) {}
+
+    void write(const char *data, std::size_t size) override {
+      m_equal = m_equal && m_expected.substr(m_position, size) == std::string_view(data, size);
+      m_position += size;
+    }
+
+    bool equal() const noexcept { return m_equal && m_position == m_expected.size(); }
+  };
+}
+
+std::shared_ptr<const GdsSchema> GdsSchema::decode(std::string_view packed, uint64_t hash) {
+  std::shared_ptr<GdsSchema> schema = std::make_shared<GdsSchema>();
+  MessageReader reader(packed.data(), packed.size());
+  uint32_t count = reader.read_array_header();
+  schema->fields.reserve(count);
+  for (uint32_t ii = 0; ii < count; ++ii) {
+    schema->fields.emplace_back(read_descriptor(reader, GdsMsgType::QUERY_REPLY));
+  }
+  schema->packed.assign(packed);
+  schema->hash = hash;
+  return schema;
+}
+
+SchemaCache::SchemaCache(std::size_t capacity) : m_capacity(capacity) {
+  m_schemas.reserve(capacity);
+  m_order.reserve(capacity);
+}
+
+std::shared_ptr<const GdsSchema> SchemaCache::intern(std::string_view packed) {
+  uint64_t hash = hash_bytes(packed);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_schemas.find(hash);
+    if (it != m_schemas.end() && it->second->packed == packed) {
+      ++m_stats.hits;
+      return it->second;
+    }
+  }
+
+  // decoded without the lock, another thread may have added the same schema in the meantime
+  std::shared_ptr<const GdsSchema> schema = GdsSchema::decode(packed, hash);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  ++m_stats.misses;
+  auto it = m_schemas.find(hash);
+  if (it != m_schemas.end()) {
+    // on a collision the new schema is not cached, the one in the cache stays
+    return it->second->packed == packed ? it->second : schema;
+  }
+  if (m_capacity == 0) {
+    return schema;
+  }
+  if (m_order.size() < m_capacity) {
+    m_order.push_back(hash);
+  } else {
+    m_schemas.erase(m_order[m_next]);
+    m_order[m_next] = hash;
+    m_next = (m_next + 1) % m_capacity;
+  }
+  m_schemas.emplace(hash, schema);
+  return schema;
+}
+
+std::shared_ptr<const GdsSchema> SchemaCache::intern(const msgpack::object &descriptors) {
+  // the object is packed into a hash, then compared with the packed bytes of the cached schema, it is stored only if it is not cached
+  hashing_buffer hasher;
+  msgpack::packer<PackBuffer>(hasher).pack(descriptors);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_schemas.find(hasher.hash());
+    if (it != m_schemas.end()) {
+      comparing_buffer comparer(it->second->packed);
+      msgpack::packer<PackBuffer>(comparer).pack(descriptors);
+      if (comparer.equal()) {
+        ++m_stats.hits;
+        return it->second;
+      }
+    }
+  }
+
+  std::string packed;
+  string_writer writer{packed};
+  msgpack::packer<string_writer>(writer).pack(descriptors);
+  return intern(packed);
+}
+
+std::shared_ptr<const GdsSchema> SchemaCache::intern(const std::vector<field_descriptor> &descriptors) {
+  std::string packed;
+  string_writer writer{packed};
+  msgpack::packer<string_writer> packer(writer);
+  packer.pack_array(descriptors.size());
+  for (auto &item : descriptors) {
+    packer.pack_array(3);
+    for (auto &desc : item) {
+      packer.pack(desc);
+    }
+  }
+  return intern(packed);
+}
+
+SchemaCacheStats SchemaCache::stats() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  SchemaCacheStats stats = m_stats;
+  stats.schemas = m_schemas.size();
+  return stats;
+}
+
+void SchemaCache::clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_schemas.clear();
+  m_order.clear();
+  m_next = 0;
+}
+
+void QueryReplyBody::pack(Packer &packer) const {
+  // the hit count is structural, it is checked at the STRUCTURAL level as well
+  if (validates_structure(packer.options().validation)) {
+    validate();
+  }
+  packer.pack_array(7);
+  packer.pack_int64(numberOfHits);
+  packer.pack_int64(filteredHits);
+  hasMorePages ? packer.pack_true() : packer.pack_false();
+  queryContextDescriptor.pack(packer);
+  const std::vector<field_descriptor> &fields = descriptors();
+  packer.pack_array(fields.size());
+  for (auto &item : fields) {
+    packer.pack_array(3);
+    for (auto &desc : item) {
+      packer.pack(desc);
+    }
+  }
+
+  if (columns) {
+    const std::size_t rows = column_rows(*columns, numberOfHits);
+    packer.pack_array(rows);
+    for (std::size_t row = 0; row < rows; ++row) {
+      packer.pack_array(columns->size());
+      for (auto &column : *columns) {
+        column.pack(packer, row);
+      }
+    }
+  } else {
+    packer.pack_array(hits.size());
+    pack_rows(packer, hits.size(), [this](Packer &row_packer, std::size_t row) {
+      row_packer.pack_array(hits[row].size());
+      for (auto &hit : hits[row]) {
+        hit.pack(row_packer);
+      }
+    });
+  }
+  packer.pack_int64(totalNumberOfHits);
+}
+
+std::size_t QueryReplyBody::encoded_size() const {
+  std::size_t size = packed_size::array_header(7) + packed_size::int64(numberOfHits) + packed_size::int64(filteredHits) +
+                     packed_size::boolean() + queryContextDescriptor.encoded_size() + descriptors_size(descriptors());
+  if (columns) {
+    const std::size_t rows = column_rows(*columns, numberOfHits);
+    size += packed_size::array_header(rows) + rows * packed_size::array_header(columns->size());
+    for (auto &column : *columns) {
+      for (std::size_t row = 0; row < rows; ++row) {
+        size += column.encoded_size(row);
+      }
+    }
+  } else {
+    size += packed_size::array_header(hits.size());
+    for (auto &row : hits) {
+      size += row_size(row);
+    }
+  }
+  return size + packed_size::int64(totalNumberOfHits);
+}
+
+void QueryReplyBody::unpack(const msgpack::object &obj) {
+  unpack(obj, DecodeOptions{});
+}
+
+void QueryReplyBody::unpack(const msgpack::object &obj, const DecodeOptions &options) {
+  object_array items(obj);
+  numberOfHits = items.at(0).as<int64_t>();
+  filteredHits = items.at(1).as<int64_t>();
+  hasMorePages = items.at(2).as<bool>();
+  queryContextDescriptor.unpack(items.at(3));
+  if (options.schemas) {
+    // the descriptors are hashed by packing them without storing the bytes, they are converted only if the cache does not have them.
+    // The public member gets a copy of the descriptors of the schema, its capacity is reused on a recycled body
+    schema = options.schemas->intern(items.at(4));
+    fieldDescriptors = schema->fields;
+  } else {
+    schema.reset();
+    object_array fielddescriptors(items.at(4));
+    fieldDescriptors.clear();
+    fieldDescriptors.reserve(fielddescriptors.size());
+    for (auto &item : fielddescriptors) {
+      fieldDescriptors.emplace_back(descriptor_of(item));
+    }
+  }
+
+  const msgpack::object &values = items.at(5);
+  if (values.type != msgpack::type::ARRAY) {
+    throw msgpack::type_error();
+  }
+  if (validates_structure(options.validation) && static_cast<int64_t>(values.via.array.size) != numberOfHits) {
+    throw invalid_message_error(GdsMsgType::QUERY_REPLY);
+  }
+  if (options.hits == HitsLayout::COLUMNS) {
+    hits.clear();
+    prepare_columns(columns, descriptors(), queryContextDescriptor.scroll_id, options);
+
+    // the string and binary columns are sized up front, so the bytes are copied only once
+    std::vector<std::size_t> byte_counts(columns->size(), 0);
+    for (uint32_t row = 0; row < values.via.array.size; ++row) {
+      const msgpack::object &hit = values.via.array.ptr[row];
+      if (hit.type != msgpack::type::ARRAY || hit.via.array.size != columns->size()) {
+        throw invalid_message_error(GdsMsgType::QUERY_REPLY, "the number of values in a hit differs from the number of fields");
+      }
+      for (uint32_t ii = 0; ii < hit.via.array.size; ++ii) {
+        const msgpack::object &cell = hit.via.array.ptr[ii];
+        if (cell.type == msgpack::type::STR || cell.type == msgpack::type::BIN) {
+          byte_counts[ii] += cell.via.str.size;
+        }
+      }
+    }
+    for (std::size_t ii = 0; ii < columns->size(); ++ii) {
+      (*columns)[ii].reserve(values.via.array.size, byte_counts[ii]);
+    }
+
+    for (uint32_t row = 0; row < values.via.array.size; ++row) {
+      const msgpack::object &hit = values.via.array.ptr[row];
+      for (uint32_t ii = 0; ii < hit.via.array.size; ++ii) {
+        (*columns)[ii].push_back(hit.via.array.ptr[ii]);
+      }
+    }
+  } else {
+    columns.reset();
+    // the rows of a reused body keep their capacity, and so do the strings of their values
+    hits.resize(values.via.array.size);
+    decode_rows(options.parallel, hits.size(), [&](std::size_t begin, std::size_t end) {
+      for (std::size_t row = begin; row < end; ++row) {
+        object_array hit(values.via.array.ptr[row]);
+        std::vector<GdsFieldValue> &currenthit = hits[row];
+        currenthit.resize(hit.size());
+        for (std::size_t ii = 0; ii < hit.size(); ++ii) {
+          currenthit[ii].unpack(hit.at(ii), options);
+        }
+      }
+    });
+  }
+  if(items.size() > 6)
+  {
+    totalNumberOfHits = items.at(6).as<int64_t>();
+  }
+}
+
+void QueryReplyBody::read(MessageReader &reader, const DecodeOptions &options) {
+  uint32_t size = read_array_of(reader, 6, GdsMsgType::QUERY_REPLY);
+  numberOfHits = reader.read_int64();
+  filteredHits = reader.read_int64();
+  hasMorePages = reader.read_bool();
+  queryContextDescriptor.read(reader, options);
+  if (options.schemas) {
+    // the packed descriptors are only hashed and compared, they are decoded if the cache does not have them yet
+    schema = options.schemas->intern(reader.read_raw());
+    fieldDescriptors = schema->fields;
+  } else {
+    schema.reset();
+    uint32_t descriptorCount = reader.read_array_header();
+    fieldDescriptors.clear();
+    fieldDescriptors.reserve(descriptorCount);
+    for (uint32_t ii = 0; ii < descriptorCount; ++ii) {
+      fieldDescriptors.emplace_back(read_descriptor(reader, GdsMsgType::QUERY_REPLY));
+    }
+  }
+
+  uint32_t rows = reader.read_array_header();
+  if (validates_structure(options.validation) && static_cast<int64_t>(rows) != numberOfHits) {
+    throw invalid_message_error(GdsMsgType::QUERY_REPLY);
+  }
+  if (options.hits == HitsLayout::COLUMNS) {
+    hits.clear();
+    prepare_columns(columns, descriptors(), queryContextDescriptor.scroll_id, options);
+
+    // the hits are read in a single pass, sizing the string columns up front would take a second one
+    for (auto &column : *columns) {
+      column.reserve(rows);
+    }
+    for (uint32_t row = 0; row < rows; ++row) {
+      if (reader.next_type() != msgpack::type::ARRAY || reader.read_array_header() != columns->size()) {
+        throw invalid_message_error(GdsMsgType::QUERY_REPLY, "the number of values in a hit differs from the number of fields");
+      }
+      for (auto &column : *columns) {
+        column.push_back(reader);
+      }
+    }
+  } else {
+    columns.reset();
+    // the rows of a reused body keep their capacity, and so do the strings of their values
+    hits.resize(rows);
+    auto read_rows = [&](MessageReader &rows_reader, std::size_t begin, std::size_t end) {
+      for (std::size_t row = begin; row < end; ++row) {
+        std::vector<GdsFieldValue> &currenthit = hits[row];
+        currenthit.resize(rows_reader.read_array_header());
+        for (auto &value : currenthit) {
+          value.read(rows_reader, options);
+        }
+      }
+    };
+    const unsigned chunks = chunk_count(options.parallel, rows);
+    if (chunks == 1) {
+      read_rows(reader, 0, rows);
+    } else {
+      // the chunks are located by skipping their rows, then every chunk is decoded by a reader of its own
+      std::vector<std::string_view> packed(chunks);
+      for (unsigned chunk = 0; chunk < chunks; ++chunk) {
+        const std::size_t end = chunk_begin(rows, chunks, chunk + 1);
+        const std::string_view first = reader.read_raw();
+        std::string_view last = first;
+        for (std::size_t row = chunk_begin(rows, chunks, chunk) + 1; row < end; ++row) {
+          last = reader.read_raw();
+        }
+        packed[chunk] = std::string_view(first.data(), static_cast<std::size_t>(last.data() + last.size() - first.data()));
+      }
+      for_each_chunk(options.parallel, rows, chunks, [&](unsigned chunk, std::size_t begin, std::size_t end) {
+        MessageReader chunk_reader(packed[chunk].data(), packed[chunk].size());
+        read_rows(chunk_reader, begin, end);
+      });
+    }
+  }
+  if (size > 6) {
+    totalNumberOfHits = reader.read_int64();
+    skip_values(reader, size - 7);
+  }
+}
+
+std::vector<GdsFieldValue> QueryReplyBody::row(std::size_t index) const {
+  if (!columns) {
+    return hits.at(index);
+  }
+  std::vector<GdsFieldValue> values;
+  values.reserve(columns->size());
+  for (auto &column : *columns) {
+    if (index >= column.size) {
+      throw std::out_of_range("QueryReplyBody::row");
+    }
+    values.emplace_back(column.value(index));
+  }
+  return values;
+}
+
+void QueryReplyBody::validate() const {
+  if (columns) {
+    if (columns->size() != descriptors().size()) {
+      throw invalid_message_error(GdsMsgType::QUERY_REPLY);
+    }
+    for (auto &column : *columns) {
+      if (static_cast<int64_t>(column.size) != numberOfHits) {
+        throw invalid_message_error(GdsMsgType::QUERY_REPLY);
+      }
+    }
+  } else if (hits.size() != numberOfHits) {
+    throw invalid_message_error(GdsMsgType::QUERY_REPLY);
+  }
+}
+
+
+std::string QueryReplyBody::to_string() const
+{
+  std::stringstream ss;
+  ss << std::boolalpha;
+  ss << '[' << '\n';
+  ss << numberOfHits;
+  ss << ", "  << '\n' << filteredHits;
+  ss << ", "  << '\n' << hasMorePages;
+  ss << ", "  << '\n' << queryContextDescriptor;
+  ss << ", "  << '\n' << descriptors();
+  if (columns) {
+    ss << ", "  << '\n' << *columns;
+  } else {
+    ss << ", "  << '\n' << hits;
+  }
+  ss << '\n' << ']';
+  return ss.str();
+}
+
+
+/*0*/
+void GdsLoginMessage::pack(Packer &packer) const {
+  validate_rules(*this, packer.options().validation);
+
+  size_t message_size = 4;
+  if(cluster_name.has_value()){
+    message_size += 1;
+  }
+
+  if(reserved_fields.has_value()){
+    message_size += 1;
+  }
+
+  packer.pack_array(message_size);
+  
+  if(cluster_name.has_value()){
+    packer.pack(cluster_name.value());
+  }
+
+  serve_on_the_same_connection ? packer.pack_true() : packer.pack_false();
+  packer.pack_int32(protocol_version_number);
+  if (fragmentation_supported) {
+    packer.pack_true();
+    packer.pack_int32(fragment_transmission_unit.value());
+  } else {
+    packer.pack_false();
+    packer.pack_nil();
+  }
+
+  if (reserved_fields.has_value()) {
+    packer.pack_array(reserved_fields.value().size());
+    for (auto &field : reserved_fields.value()) {
+      packer.pack(field);
+    }
+  }
+}
+
+std::size_t GdsLoginMessage::encoded_size() const {
+  std::size_t size = packed_size::array_header(4 + (cluster_name.has_value() ? 1 : 0) + (reserved_fields.has_value() ? 1 : 0));
+  if (cluster_name.has_value()) {
+    size += packed_size::str(cluster_name.value().size());
+  }
+  size += packed_size::boolean() + packed_size::int64(protocol_version_number) + packed_size::boolean();
+  size += fragmentation_supported && fragment_transmission_unit ? packed_size::int64(*fragment_transmission_unit) : packed_size::nil();
+  if (reserved_fields.has_value()) {
+    size += packed_size::array_header(reserved_fields.value().size());
+    for (auto &field : reserved_fields.value()) {
+      size += packed_size::str(field.size());
+    }
+  }
+  return size;
+}
+
+void GdsLoginMessage::unpack(const msgpack::object &packer) {
+  unpack(packer, DecodeOptions{});
+}
+
+void GdsLoginMessage::unpack(const msgpack::object &packer, const DecodeOptions &options) {
+  object_array data(packer);
+  size_t idx = 0;
+  if(data.at(0).type == msgpack::type::STR){
+    cluster_name = data.at(idx++).as<std::string>();
+  } else {
+    cluster_name.reset();
+  }
+
+  serve_on_the_same_connection = data.at(idx++).as<bool>();
+  protocol_version_number = data.at(idx++).as<int32_t>();
+  fragmentation_supported = data.at(idx++).as<bool>();
+  if (fragmentation_supported) {
+    fragment_transmission_unit = data.at(idx++).as<int32_t>();
+  } else {
+    fragment_transmission_unit.reset();
+    idx++;
+  }
+
+  if (data.size() > idx) {
+    reserved_fields = data.at(idx).as<std::vector<std::string>>();
+  } else {
+    reserved_fields.reset();
+  }
+
+  validate_rules(*this, options.validation);
+}
+
+void GdsLoginMessage::validate() const {
+  if (fragmentation_supported != fragment_transmission_unit.has_value()) {
+    throw invalid_message_error(GdsMsgType::LOGIN, "fragmentation_flag");
+  }
+
+  if (reserved_fields.has_value() && reserved_fields.value().size() == 0) {
+    throw invalid_message_error(GdsMsgType::LOGIN, "reserved_fields");
+  }
+}
+
+
+std::string GdsLoginMessage::to_string() const
+{
+  std::stringstream ss;
+  ss << std::boolalpha;
+  ss << '[' << '\n';
+  if(cluster_name){
+    ss << cluster_name << ", " << '\n';
+  }
+  ss << serve_on_the_same_connection;
+  ss << ", "  << '\n' << protocol_version_number;
+  ss << ", "  << '\n' << fragmentation_supported;
+  ss << ", "  << '\n' << fragment_transmission_unit;
+  if(reserved_fields)
+  {
+    ss << ", " << '\n' << reserved_fields;
+  }
+
+  ss  << '\n' << ']';
+  return ss.str();
+}
+
+
+/*1*/
+void GdsLoginReplyMessage::pack(
+  Packer &packer) const {
+  validate_rules(*this, packer.options().validation);
+  packer.pack_array(3);
+  packer.pack_int32(ackStatus);
+  if (loginReply) {
+    loginReply.value().pack(packer);
+  } else if (errorDetails) {
+    packer.pack_map(errorDetails.value().size());
+    for (auto &pair : errorDetails.value()) {
+      packer.pack_int32(pair.first);
+      packer.pack(pair.second);
+    }
+  } else {
+    packer.pack_nil();
+  }
+  if (ackException) {
+    packer.pack(ackException);
+  } else {
+    packer.pack_nil();
+  }
+}
+
+std::size_t GdsLoginReplyMessage::encoded_size() const {
+  std::size_t size = packed_size::array_header(3) + packed_size::int64(ackStatus);
+  if (loginReply) {
+    size += loginReply.value().encoded_size();
+  } else if (errorDetails) {
+    size += packed_size::map_header(errorDetails.value().size());
+    for (auto &pair : errorDetails.value()) {
+      size += packed_size::int64(pair.first) + packed_size::str(pair.second.size());
+    }
+  } else {
+    size += packed_size::nil();
+  }
+  return size + optional_str_size(ackException);
+}
+
+void GdsLoginReplyMessage::unpack(const msgpack::object &packer) {
+  unpack(packer, DecodeOptions{});
+}
+
+void GdsLoginReplyMessage::unpack(const msgpack::object &packer, const DecodeOptions &options) {
+  object_array data(packer);
+  ackStatus = data.at(0).as<int32_t>();
+  loginReply.reset();
+  errorDetails.reset();
+
+  if (200 == ackStatus && data.at(1).type == msgpack::type::ARRAY) {
+    loginReply.emplace();
+    loginReply->unpack(data.at(1), options);
+  } else if (401 == ackStatus && data.at(1).type == msgpack::type::MAP) {
+    data.at(1).convert(errorDetails.emplace());
+  }
+
+  if (!data.at(2).is_nil()) {
+    ackException = data.at(2).as<std::string>();
+  } else {
+    ackException.reset();
+  }
+  validate_rules(*this, options.validation);
+}
+
+void GdsLoginReplyMessage::validate() const {
+  if (loginReply.has_value() == errorDetails.has_value()) {
+    if (loginReply.has_value()) {
+      throw invalid_message_error(type());
+    }
+  }
+}
+
+
+std::string GdsLoginReplyMessage::to_string() const
+{
+  std::stringstream ss;
+  ss << '[' << '\n';
+  ss << ackStatus;
+  if(loginReply){
+    ss << ", "  << '\n' << loginReply;
+  }else{
+    ss << ", "  << '\n' << errorDetails;
+  }
+  ss << '\n' << ", " << ackException;
+  ss << '\n' << ']';
+  return ss.str();
+}
+
+
+/*2*/
+void GdsEventMessage::pack(Packer &packer) const {
+  SchemaCodec<GdsEventMessage>::pack(*this, packer);
+}
+
+std::size_t GdsEventMessage::encoded_size() const {
+  return SchemaCodec<GdsEventMessage>::encoded_size(*this);
+}
+
+void GdsEventMessage::unpack(const msgpack::object &object) {
+  SchemaCodec<GdsEventMessage>::unpack(*this, object);
+}
+
+void GdsEventMessage::unpack(const msgpack::object &object, const DecodeOptions &options) {
+  SchemaCodec<GdsEventMessage>::unpack(*this, object, options);
+}
+
+void GdsEventMessage::read(MessageReader &reader, const DecodeOptions &options) {
+  SchemaCodec<GdsEventMessage>::read(*this, reader, options);
+}
+
+void GdsEventMessage::validate() const {
+  // skip, nothing specific here
+}
+
+
+std::string GdsEventMessage::to_string() const
+{
+  return schema_to_string(*this);
+}
+
+EventBuilder::EventBuilder(std::size_t operations_capacity, std::size_t attachments_capacity) {
+  m_operations.reserve(operations_capacity);
+  m_attachments.reserve(attachments_capacity);
+}
+
+EventBuilder &EventBuilder::add_statement(std::string_view statement) {
+  if (!m_operations.empty()) {
+    m_operations.push_back(';');
+  }
+  m_operations.append(statement);
+  return *this;
+}
+
+void EventBuilder::begin_attachment(std::string_view id, std::size_t size) {
+  for (auto &item : m_attachment_ids) {
+    if (item.first == id) {
+      throw std::invalid_argument("EventBuilder: the attachment " + std::string(id) + " was already added");
+    }
+  }
+  if (size > std::numeric_limits<uint32_t>::max()) {
+    throw std::length_error("EventBuilder: the attachment is too large");
+  }
+  m_attachment_ids.emplace_back(id, size);
+
+  string_writer writer{m_attachments};
+  msgpack::packer<string_writer> packer(writer);
+  packer.pack_str(static_cast<uint32_t>(id.size()));
+  packer.pack_str_body(id.data(), static_cast<uint32_t>(id.size()));
+  packer.pack_bin(static_cast<uint32_t>(size));
+}
+
+EventBuilder &EventBuilder::add_attachment(std::string_view id, const uint8_t *data, std::size_t size) {
+  begin_attachment(id, size);
+  m_attachments.append(reinterpret_cast<const char *>(data), size);
+  return *this;
+}
+
+uint8_t *EventBuilder::reserve_attachment(std::string_view id, std::size_t size) {
+  begin_attachment(id, size);
+  const std::size_t offset = m_attachments.size();
+  m_attachments.resize(offset + size);
+  return reinterpret_cast<uint8_t *>(&m_attachments[offset]);
+}
+
+void EventBuilder::clear() noexcept {
+  m_operations.clear();
+  m_attachments.clear();
+  m_attachment_ids.clear();
+  priorityLevels.clear();
+}
+
+void EventBuilder::pack(Packer &packer) const {
+  packer.pack_array(3);
+  packer.pack(m_operations);
+  packer.pack_map(static_cast<uint32_t>(m_attachment_ids.size()));
+  // the pairs are already packed, they are appended as they are
+  packer.write_packed(m_attachments.data(), m_attachments.size());
+  packer.pack(priorityLevels);
+}
+
+std::size_t EventBuilder::encoded_size() const {
+  // the attachments are counted by the size of their packed pairs
+  return packed_size::array_header(3) + packed_size::str(m_operations.size()) + packed_size::map_header(m_attachment_ids.size()) +
+         m_attachments.size() + schema_detail::value_size(priorityLevels);
+}
+
+void EventBuilder::unpack(const msgpack::object &object) {
+  GdsEventMessage event;
+  event.unpack(object);
+  clear();
+  m_operations = std::move(event.operations);
+  for (auto &item : event.binaryContents) {
+    add_attachment(item.first, item.second);
+  }
+  priorityLevels = std::move(event.priorityLevels);
+}
+
+std::string EventBuilder::to_string() const
+{
+  std::stringstream ss;
+  ss << '[' << '\n';
+  ss << m_operations;
+  ss << ", "  << '\n' << '{';
+  for (std::size_t ii = 0; ii < m_attachment_ids.size(); ++ii) {
+    ss << (ii ? ", " : "") << '\n' << m_attachment_ids[ii].first << ": " << '<' << m_attachment_ids[ii].second << " bytes>";
+  }
+  ss << '\n' << '}';
+  ss << ", "  << '\n' << priorityLevels;
+  ss  << '\n' << ']';
+  return ss.str();
+}
+
+
+/*3*/
+void GdsEventReplyMessage::pack(
+  Packer &packer) const {
+  validate_rules(*this, packer.options().validation);
+
+  packer.pack_array(3);
+  packer.pack_int32(ackStatus);
+  if (reply) {
+    reply->pack(packer);
+  } else {
+    packer.pack_nil();
+  }
+  if (ackException) {
+    packer.pack(ackException);
+  } else {
+    packer.pack_nil();
+  }
+}
+
+std::size_t GdsEventReplyMessage::encoded_size() const {
+  return packed_size::array_header(3) + packed_size::int64(ackStatus) + (reply ? reply->encoded_size() : packed_size::nil()) +
+         optional_str_size(ackException);
+}
+
+void GdsEventReplyMessage::unpack(const msgpack::object &packer) {
+  unpack(packer, DecodeOptions{});
+}
+
+void GdsEventReplyMessage::unpack(const msgpack::object &packer, const DecodeOptions &options) {
+
+  object_array data(packer);
+  ackStatus = data.at(0).as<int32_t>();
+  if (!data.at(1).is_nil()) {
+    reply.emplace();
+    reply->unpack(data.at(1), options);
+  } else {
+    reply.reset();
+  }
+  if (!data.at(2).is_nil()) {
+    ackException = data.at(2).as<std::string>();
+  } else {
+    ackException.reset();
+  }
+  validate_rules(*this, options.validation);
+}
+
+void GdsEventReplyMessage::read(MessageReader &reader, const DecodeOptions &options) {
+  uint32_t size = read_array_of(reader, 3, GdsMsgType::EVENT_REPLY);
+  ackStatus = reader.read_int32();
+  if (!reader.try_read_nil()) {
+    reply.emplace();
+    reply->read(reader, options);
+  } else {
+    reply.reset();
+  }
+  ackException = read_optional_string(reader);
+  skip_values(reader, size - 3);
+  validate_rules(*this, options.validation);
+}
+
+void GdsEventReplyMessage::validate() const {
+  if(reply){
+    reply.value().validate();
+  }
+}
+
+std::string GdsEventReplyMessage::to_string() const
+{
+  std::stringstream ss;
+  ss << '[' << '\n';
+  ss << ackStatus;
+  ss << ", "  << '\n' << reply;
+  ss << ", "  << '\n' << ackException;
+  ss  << '\n' << ']';
+  return ss.str();
+}
+
+
+
+std::string EventReplyBody::EventSubResult::to_string() const
+{
+  std::stringstream ss;
+  ss << std::boolalpha;
+  ss << '[' << '\n';
+  ss << status;
+  ss << ", "  << '\n' << id;
+  ss << ", "  << '\n' << tableName;
+  ss << ", "  << '\n' << created;
+  ss << ", "  << '\n' << version;
+  ss << ", "  << '\n' << values;
+  ss  << '\n' << ']';
+  return ss.str();
+}
+
+
+std::string EventReplyBody::GdsEventResult::to_string() const
+{
+  std::stringstream ss;
+  ss << '[' << '\n';
+  ss << status;
+  ss << ", "  << '\n' << notification;
+  ss << ", "  << '\n' << fieldDescriptor;
+  ss << ", "  << '\n' << subResults;
+  ss << '\n'  << ']';
+  return ss.str();
+}
+
+
+
+
+/*4*/
+void GdsAttachmentRequestMessage::pack(
+  Packer &packer) const {
+  validate_rules(*this, packer.options().validation);
+  packer.pack(request);
+}
+
+std::size_t GdsAttachmentRequestMessage::encoded_size() const {
+  return packed_size::str(request.size());
+}
+void GdsAttachmentRequestMessage::unpack(const msgpack::object &obj) {
+  unpack(obj, DecodeOptions{});
+}
+
+void GdsAttachmentRequestMessage::unpack(const msgpack::object &obj, const DecodeOptions &options) {
+  request = obj.as<std::string>();
+  validate_rules(*this, options.validation);
+}
+void GdsAttachmentRequestMessage::validate() const {
+  // skip
+}
+
+std::string GdsAttachmentRequestMessage::to_string() const
+{
+  std::stringstream ss;
+  ss << '[' << '\n';
+  ss << request << '\n';
+  ss << ']';
+  return ss.str();
+}
+
+
+/*5*/
+void GdsAttachmentRequestReplyMessage::pack(Packer &packer) const {
+  SchemaCodec<GdsAttachmentRequestReplyMessage>::pack(*this, packer);
+}
+
+std::size_t GdsAttachmentRequestReplyMessage::encoded_size() const {
+  return SchemaCodec<GdsAttachmentRequestReplyMessage>::encoded_size(*this);
+}
+
+void GdsAttachmentRequestReplyMessage::unpack(const msgpack::object &object) {
+  SchemaCodec<GdsAttachmentRequestReplyMessage>::unpack(*this, object);
+}
+
+void GdsAttachmentRequestReplyMessage::unpack(const msgpack::object &object, const DecodeOptions &options) {
+  SchemaCodec<GdsAttachmentRequestReplyMessage>::unpack(*this, object, options);
+}
+
+void GdsAttachmentRequestReplyMessage::read(MessageReader &reader, const DecodeOptions &options) {
+  SchemaCodec<GdsAttachmentRequestReplyMessage>::read(*this, reader, options);
+}
+void GdsAttachmentRequestReplyMessage::validate() const {
+  if ((ackStatus == GDSStatusCodes::OK) != (request.has_value())) {
+    throw invalid_message_error(type());
+  }
+}
+
+
+std::string GdsAttachmentRequestReplyMessage::to_string() const
+{
+  return schema_to_string(*this);
+}
+
+
+/*6*/
+void GdsAttachmentResponseMessage::pack(Packer &packer) const {
+  SchemaCodec<GdsAttachmentResponseMessage>::pack(*this, packer);
+}
+
+std::size_t GdsAttachmentResponseMessage::encoded_size() const {
+  return SchemaCodec<GdsAttachmentResponseMessage>::encoded_size(*this);
+}
+
+void GdsAttachmentResponseMessage::unpack(const msgpack::object &object) {
+  SchemaCodec<GdsAttachmentResponseMessage>::unpack(*this, object);
+}
+
+void GdsAttachmentResponseMessage::unpack(const msgpack::object &object, const DecodeOptions &options) {
+  SchemaCodec<GdsAttachmentResponseMessage>::unpack(*this, object, options);
+}
+
+void GdsAttachmentResponseMessage::read(MessageReader &reader, const DecodeOptions &options) {
+  SchemaCodec<GdsAttachmentResponseMessage>::read(*this, reader, options);
+}
+void GdsAttachmentResponseMessage::validate() const { result.validate(); }
+
+
+std::string GdsAttachmentResponseMessage::to_string() const
+{
+  std::stringstream ss;
+  ss << '[' << '\n';
+  ss << result << '\n';
+  ss << ']' << '\n';
+  return ss.str();
+}
+
+
+/*7*/
+void GdsAttachmentResponseResultMessage::pack(Packer &packer) const {
+  SchemaCodec<GdsAttachmentResponseResultMessage>::pack(*this, packer);
+}
+
+std::size_t GdsAttachmentResponseResultMessage::encoded_size() const {
+  return SchemaCodec<GdsAttachmentResponseResultMessage>::encoded_size(*this);
+}
+
+void GdsAttachmentResponseResultMessage::unpack(const msgpack::object &object) {
+  SchemaCodec<GdsAttachmentResponseResultMessage>::unpack(*this, object);
+}
+
+void GdsAttachmentResponseResultMessage::unpack(const msgpack::object &object, const DecodeOptions &options) {
+  SchemaCodec<GdsAttachmentResponseResultMessage>::unpack(*this, object, options);
+}
+
+void GdsAttachmentResponseResultMessage::read(MessageReader &reader, const DecodeOptions &options) {
+  SchemaCodec<GdsAttachmentResponseResultMessage>::read(*this, reader, options);
+}
+void GdsAttachmentResponseResultMessage::validate() const {
+  if (response) {
+    response->validate();
+  }
+}
+
+
+std::string GdsAttachmentResponseResultMessage::to_string() const
+{
+  return schema_to_string(*this);
+}
+
+
+
+/*8*/
+void GdsEventDocumentMessage::pack(
+  Packer &packer) const {
+  const bool check_rows = validates_structure(packer.options().validation);
+  packer.pack_array(4);
+  packer.pack(tableName);
+  packer.pack_array(fieldDescriptors.size());
+  for (auto &item : fieldDescriptors) {
+    packer.pack_array(3);
+    for (auto &desc : item) {
+      packer.pack(desc);
+    }
+  }
+
+  packer.pack_array(records.size());
+  pack_rows(packer, records.size(), [&](Packer &row_packer, std::size_t row) {
+    const std::vector<GdsFieldValue> &hit_rows = records[row];
+    if (check_rows && hit_rows.size() != fieldDescriptors.size()) {
+      throw invalid_message_error(type());
+    }
+    row_packer.pack_array(hit_rows.size());
+    for (auto &hit : hit_rows) {
+      hit.pack(row_packer);
+    }
+  });
+
+  packer.pack_map(0);
+}
+
+std::size_t GdsEventDocumentMessage::encoded_size() const {
+  std::size_t size = packed_size::array_header(4) + packed_size::str(tableName.size()) + descriptors_size(fieldDescriptors);
+  size += packed_size::array_header(records.size());
+  for (auto &record : records) {
+    size += row_size(record);
+  }
+  return size + packed_size::map_header(0);
+}
+
+void GdsEventDocumentMessage::unpack(const msgpack::object &packer) {
+  unpack(packer, DecodeOptions{});
+}
+
+void GdsEventDocumentMessage::unpack(const msgpack::object &packer, const DecodeOptions &options) {
+  object_array obj(packer);
+  tableName = obj.at(0).as<std::string>();
+
+  object_array fielddescriptors(obj.at(1));
+  fieldDescriptors.clear();
+  fieldDescriptors.reserve(fielddescriptors.size());
+  for (auto &item : fielddescriptors) {
+    fieldDescriptors.emplace_back(descriptor_of(item));
+  }
+
+  object_array values(obj.at(2));
+  records.clear();
+  records.resize(values.size());
+  const bool check_rows = validates_structure(options.validation);
+  decode_rows(options.parallel, values.size(), [&](std::size_t begin, std::size_t end) {
+    for (std::size_t index = begin; index < end; ++index) {
+      object_array row(values.at(index));
+      if (check_rows && row.size() != fieldDescriptors.size()) {
+        throw invalid_message_error(type());
+      }
+      std::vector<GdsFieldValue> &currenthit = records[index];
+      currenthit.resize(row.size());
+      for (std::size_t ii = 0; ii < row.size(); ++ii) {
+        currenthit[ii].unpack(row.at(ii), options);
+      }
+    }
+  });
+
+  // returnings = obj.at(3).as<flat_map<int32_t, std::vector<std::string>>>();
+}
+void GdsEventDocumentMessage::validate() const {
+  size_t headerCount = fieldDescriptors.size();
+  for (auto &row : records) {
+    if (headerCount != row.size()) {
+      throw invalid_message_error(type());
+    }
+  }
+}
+
+
+std::string GdsEventDocumentMessage::to_string() const
+{
+  std::stringstream ss;
+  ss << '[' << '\n';
+  ss << tableName;
+  ss << ", "  << '\n' << fieldDescriptors;
+  ss << ", "  << '\n' << records;
+  ss << ", "  << '\n' << returnings;
+  ss  << '\n' << ']';
+  return ss.str();
+}
+
+
+
+/*9*/
+void GdsEventDocumentReplyMessage::pack(
+  Packer &packer) const {
+  validate_rules(*this, packer.options().validation);
+
+  packer.pack_array(3);
+  packer.pack_int32(ackStatus);
+  if (results) {
+    packer.pack_array(results->size());
+    for (auto &event : results.value()) {
+      event.pack(packer);
+    }
+  } else {
+    packer.pack_nil();
+  }
+
+  if (ackException) {
+    packer.pack(ackException);
+  } else {
+    packer.pack_nil();
+  }
+}
+
+std::size_t GdsEventDocumentReplyMessage::encoded_size() const {
+  std::size_t size = packed_size::array_header(3) + packed_size::int64(ackStatus);
+  if (results) {
+    size += packed_size::array_header(results->size());
+    for (auto &event : results.value()) {
+      size += event.encoded_size();
+    }
+  } else {
+    size += packed_size::nil();
+  }
+  return size + optional_str_size(ackException);
+}
+
+void GdsEventDocumentReplyMessage::unpack(const msgpack::object &packer) {
+  unpack(packer, DecodeOptions{});
+}
+
+void GdsEventDocumentReplyMessage::unpack(const msgpack::object &packer, const DecodeOptions &options) {
+
+  object_array data(packer);
+  ackStatus = data.at(0).as<int32_t>();
+  if (!data.at(1).is_nil()) {
+    object_array items(data.at(1));
+    results.emplace();
+    results->reserve(items.size());
+    for (auto &object : items) {
+      results->emplace_back().unpack(object, options);
+    }
+  } else {
+    results.reset();
+  }
+
+  if (!data.at(2).is_nil()) {
+    ackException = data.at(2).as<std::string>();
+  } else {
+    ackException.reset();
+  }
+  validate_rules(*this, options.validation);
+}
+void GdsEventDocumentReplyMessage::validate() const {
+  // skip
+}
+
+std::string GdsEventDocumentReplyMessage::to_string() const
+{
+  std::stringstream ss;
+  ss << '[' << '\n';
+  ss << ackStatus;
+  ss << ", "  << '\n'<< results;
+  ss << ", "  << '\n'<< ackException;
+  ss  << '\n' << ']';
+  return ss.str();
+}
+
+
+/*10*/
+void GdsQueryRequestMessage::pack(
+  Packer &packer) const {
+  validate_rules(*this, packer.options().validation);
+  if (queryPageSize.has_value() && queryType.has_value()) {
+    packer.pack_array(5);
+  } else {
+    packer.pack_array(3);
+  }
+  packer.pack(selectString);
+  packer.pack(consistency);
+  packer.pack_int64(timeout);
+
+  if (queryPageSize.has_value() && queryType.has_value()) {
+    packer.pack_int32(queryPageSize.value());
+    packer.pack_int32(queryType.value());
+  }
+}
+
+std::size_t GdsQueryRequestMessage::encoded_size() const {
+  const bool paged = queryPageSize.has_value() && queryType.has_value();
+  std::size_t size = packed_size::array_header(paged ? 5 : 3) + packed_size::str(selectString.size()) +
+                     packed_size::str(consistency.size()) + packed_size::int64(timeout);
+  if (paged) {
+    size += packed_size::int64(queryPageSize.value()) + packed_size::int64(queryType.value());
+  }
+  return size;
+}
+
+void GdsQueryRequestMessage::unpack(const msgpack::object &obj) {
+  unpack(obj, DecodeOptions{});
+}
+
+void GdsQueryRequestMessage::unpack(const msgpack::object &obj, const DecodeOptions &options) {
+  object_array items(obj);
+  selectString = items.at(0).as<std::string>();
+  consistency = items.at(1).as<std::string>();
+  timeout = items.at(2).as<int64_t>();
+  if (items.size() == 5) {
+    queryPageSize = items.at(3).as<int32_t>();
+    queryType = items.at(4).as<int32_t>();
+  } else {
+    queryPageSize.reset();
+    queryType.reset();
+  }
+  validate_rules(*this, options.validation);
+}
+
+void GdsQueryRequestMessage::validate() const {
+  if (queryPageSize.has_value() != queryType.has_value()) {
+    throw invalid_message_error(type());
+  }
+}
+
+
+std::string GdsQueryRequestMessage::to_string() const
+{
+  std::stringstream ss;
+  ss << '[' << '\n';
+  ss << selectString;
+  ss << ", "  << '\n'<< consistency;
+  ss << ", "  << '\n'<< timeout;
+  if(queryPageSize && queryType){
+    ss << ", "  << '\n'<< queryPageSize.value();
+    ss << ", "  << '\n'<< queryType.value();
+  }
+  ss  << '\n' << ']';
+  return ss.str();
+}
+
+
+/*11*/
+void GdsQueryReplyMessage::pack(
+  Packer &packer) const {
+  // the reply has no rules of its own, the response checks itself while it is packed
+  packer.pack_array(3);
+  packer.pack_int32(ackStatus);
+  if (response) {
+    response->pack(packer);
+  } else {
+    packer.pack_nil();
+  }
+
+  if (ackException) {
+    packer.pack(ackException);
+  } else {
+    packer.pack_nil();
+  }
+}
+
+std::size_t GdsQueryReplyMessage::encoded_size() const {
+  return packed_size::array_header(3) + packed_size::int64(ackStatus) + (response ? response->encoded_size() : packed_size::nil()) +
+         optional_str_size(ackException);
+}
+
+void GdsQueryReplyMessage::unpack(const msgpack::object &packer) {
+  unpack(packer, DecodeOptions{});
+}
+
+void GdsQueryReplyMessage::unpack(const msgpack::object &packer, const DecodeOptions &options) {
+  object_array data(packer);
+  ackStatus = data.at(0).as<int32_t>();
+
+  if (!data.at(1).is_nil()) {
+    if (!response) {
+      response.emplace();
+    }
+    response->unpack(data.at(1), options);
+  } else {
+    response.reset();
+  }
+
+  if (!data.at(2).is_nil()) {
+    ackException = data.at(2).as<std::string>();
+  } else {
+    ackException.reset();
+  }
+}
+
+void GdsQueryReplyMessage::read(MessageReader &reader, const DecodeOptions &options) {
+  uint32_t size = read_array_of(reader, 3, GdsMsgType::QUERY_REPLY);
+  ackStatus = reader.read_int32();
+  if (!reader.try_read_nil()) {
+    if (!response) {
+      response.emplace();
+    }
+    response->read(reader, options);
+  } else {
+    response.reset();
+  }
+  ackException = read_optional_string(reader);
+  skip_values(reader, size - 3);
+}
+
+void GdsQueryReplyMessage::validate() const {
+  if (response) {
+    response->validate();
+  }
+}
+
+
+std::string GdsQueryReplyMessage::to_string() const
+{
+  std::stringstream ss;
+  ss << '[' << '\n';
+  ss << ackStatus;
+  ss << ", "  << '\n'<< response;
+  ss << ", "  << '\n'<< ackException;
+  ss << '\n' << ']';
+  return ss.str();
+}
+
+
+/*12*/
+void GdsNextQueryRequestMessage::pack(Packer &packer) const {
+  SchemaCodec<GdsNextQueryRequestMessage>::pack(*this, packer);
+}
+
+std::size_t GdsNextQueryRequestMessage::encoded_size() const {
+  return SchemaCodec<GdsNextQueryRequestMessage>::encoded_size(*this);
+}
+
+void GdsNextQueryRequestMessage::unpack(const msgpack::object &object) {
+  SchemaCodec<GdsNextQueryRequestMessage>::unpack(*this, object);
+}
+
+void GdsNextQueryRequestMessage::unpack(const msgpack::object &object, const DecodeOptions &options) {
+  SchemaCodec<GdsNextQueryRequestMessage>::unpack(*this, object, options);
+}
+
+void GdsNextQueryRequestMessage::read(MessageReader &reader, const DecodeOptions &options) {
+  SchemaCodec<GdsNextQueryRequestMessage>::read(*this, reader, options);
+}
+void GdsNextQueryRequestMessage::validate() const {
+  // skip
+}
+
+std::string GdsNextQueryRequestMessage::to_string() const
+{
+  return schema_to_string(*this);
+}
+
+
+} // namespace gds_types
+} // namespace gds_lib
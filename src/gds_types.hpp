@@ -1,15 +1,31 @@
 #ifndef GDS_TYPES_HPP
 #define GDS_TYPES_HPP
 
-#include <any>
+#include "gds_flat_map.hpp"
+
+#include <algorithm>
+#include <condition_variable>
 #include <cstdint>
+#include <cstring>
+#include <deque>
 #include <exception>
+#include <functional>
+#include <limits>
 #include <list>
 #include <map>
 #include <memory>
+#include <memory_resource>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <variant>
 #include <vector>
 
 #include <msgpack.hpp>
@@ -17,15 +33,255 @@
 namespace gds_lib {
 namespace gds_types {
 
+    struct DecodeOptions;
+    class MessageReader;
+    class SchemaCache;
+    class DictionaryCache;
+    class JsonWriter;
+
     struct Stringable {
         virtual std::string to_string() const { return {}; }
+        // writes the value as JSON, the default is the to_string() text as a JSON string
+        virtual void to_json(JsonWriter&) const;
+    };
+
+    /**
+ * Output of the packing. The messages are packed through this interface, so they can be written to any buffer
+ * (see the adapters below) instead of a single contiguous msgpack::sbuffer.
+ */
+    class PackBuffer {
+    public:
+        virtual ~PackBuffer() {}
+        virtual void write(const char* data, std::size_t size) = 0;
+    };
+
+    /**
+ * Forwards to any buffer with a write(const char*, size) member, like the msgpack::sbuffer.
+ * With a msgpack::vrefbuffer the strings and binaries longer than its reference size (attachments for example)
+ * are not copied, only referenced, so the packed object has to outlive the buffer. The buffer can also be
+ * sent as a scatter-gather list, see msgpack::vrefbuffer::vector().
+ */
+    template <typename Buffer>
+    class PackBufferAdapter : public PackBuffer {
+        Buffer& m_buffer;
+
+    public:
+        explicit PackBufferAdapter(Buffer& buffer)
+            : m_buffer(buffer)
+        {
+        }
+        void write(const char* data, std::size_t size) override { m_buffer.write(data, size); }
+    };
+
+    /**
+ * Packs into a caller supplied memory area, throws std::length_error if the message does not fit.
+ */
+    class FixedPackBuffer : public PackBuffer {
+        char* m_data;
+        std::size_t m_capacity;
+        std::size_t m_size = 0;
+
+    public:
+        FixedPackBuffer(char* data, std::size_t capacity)
+            : m_data(data),
+              m_capacity(capacity)
+        {
+        }
+
+        void write(const char* data, std::size_t size) override
+        {
+            if (size > m_capacity - m_size) {
+                throw std::length_error("FixedPackBuffer::write");
+            }
+            std::memcpy(m_data + m_size, data, size);
+            m_size += size;
+        }
+
+        const char* data() const noexcept { return m_data; }
+        std::size_t size() const noexcept { return m_size; }
+        std::size_t capacity() const noexcept { return m_capacity; }
+        void clear() noexcept { m_size = 0; }
+    };
+
+    /**
+ * Counts the bytes written to it without storing them, see Packable::encoded_size()
+ */
+    class CountingPackBuffer : public PackBuffer {
+        std::size_t m_size = 0;
+
+    public:
+        void write(const char*, std::size_t size) override { m_size += size; }
+
+        std::size_t size() const noexcept { return m_size; }
+        void clear() noexcept { m_size = 0; }
+    };
+
+    /**
+ * The number of bytes the msgpack packer writes for a value, it picks the shortest form of the integers and the headers.
+ * The sizes of the strings and the binaries include their bytes, the sizes of the arrays and the maps are their headers only.
+ */
+    namespace packed_size {
+        constexpr std::size_t nil() noexcept { return 1; }
+        constexpr std::size_t boolean() noexcept { return 1; }
+        constexpr std::size_t float32() noexcept { return 5; }
+        constexpr std::size_t float64() noexcept { return 9; }
+
+        constexpr std::size_t uint64(uint64_t value) noexcept
+        {
+            return value < (1ULL << 7) ? 1 : value < (1ULL << 8) ? 2 : value < (1ULL << 16) ? 3 : value < (1ULL << 32) ? 5 : 9;
+        }
+        constexpr std::size_t int64(int64_t value) noexcept
+        {
+            if (value >= 0) {
+                return uint64(static_cast<uint64_t>(value));
+            }
+            return value >= -(1LL << 5) ? 1 : value >= -(1LL << 7) ? 2 : value >= -(1LL << 15) ? 3 : value >= -(1LL << 31) ? 5 : 9;
+        }
+
+        constexpr std::size_t str(std::size_t size) noexcept
+        {
+            return (size < 32 ? 1 : size < 256 ? 2 : size < 65536 ? 3 : 5) + size;
+        }
+        constexpr std::size_t bin(std::size_t size) noexcept
+        {
+            return (size < 256 ? 2 : size < 65536 ? 3 : 5) + size;
+        }
+        constexpr std::size_t array_header(std::size_t count) noexcept
+        {
+            return count < 16 ? 1 : count < 65536 ? 3 : 5;
+        }
+        constexpr std::size_t map_header(std::size_t count) noexcept
+        {
+            return array_header(count);
+        }
+    } // namespace packed_size
+
+    /**
+ * How thoroughly the messages are checked when they are decoded and packed. The checks of the structure are made
+ * while the values are decoded (or packed), the rules of the protocol once per message, after its body.
+ */
+    struct ValidationLevel {
+        enum Enum {
+            FULL = 0, // the structure and the rules of the protocol (the status codes against the present fields, the paired optional fields)
+            STRUCTURAL = 1, // only the structure the SDK relies on: the fragment fields of the header, the row widths and the hit counts
+            TRUSTED = 2 // nothing besides the types of the values, for the messages of a trusted GDS
+        };
+    };
+
+    /**
+ * Threads that pack and decode the chunks of rows of the large messages (the hits of a query reply, the records
+ * of an event document). The threads are started with the pool and wait for chunks as long as it lives, the clients
+ * own one if their rows are split (see GDSBuilder::with_parallel). The messages packed or decoded at the same time
+ * share its threads, the chunks no thread took yet are handled by the calling thread.
+ */
+    class WorkerPool {
+        std::mutex m_mutex;
+        std::condition_variable m_wakeup;
+        std::deque<std::function<void()> > m_tasks;
+        std::vector<std::thread> m_threads;
+        bool m_stopped = false;
+
+        void run();
+
+    public:
+        // starts the given number of threads, fewer if the system has no more
+        explicit WorkerPool(unsigned threads);
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        // the pool splitting the rows among the given number of threads, the calling one included (0 is the number of cores).
+        // nullptr if the rows are handled by the calling thread only: for 1 thread or on a single core
+        static std::shared_ptr<WorkerPool> create(unsigned threads);
+
+        std::size_t size() const noexcept { return m_threads.size(); }
+        // the task is run by one of the threads of the pool
+        void submit(std::function<void()> task);
+    };
+
+    /**
+ * Splitting the rows of the large messages among the threads of a pool. The rows are cut into as many chunks
+ * of consecutive rows as there are threads (the calling one included), the chunks are packed into buffers
+ * of their own (appended in their order) or decoded into their places at the same time.
+ */
+    struct ParallelOptions {
+        // the threads besides the calling one, without a pool the rows are packed and decoded by the calling thread
+        std::shared_ptr<WorkerPool> pool;
+        std::size_t min_rows = 16384; // the messages with fewer rows are packed and decoded on the calling thread
+    };
+
+    /**
+ * Options for packing the messages. The clients pack with the validation and the parallel options of their decode options.
+ */
+    struct EncodeOptions {
+        ValidationLevel::Enum validation = ValidationLevel::FULL;
+        // the threads the rows of the large messages are packed by
+        ParallelOptions parallel;
+    };
+
+    /**
+ * The packer of the messages. Besides the values it writes bytes that are packed already (a chunk of rows,
+ * a cached array) straight to its stream, after what it packed so far. It carries the options of the packing.
+ */
+    template <typename Stream>
+    class BasicPacker : public msgpack::packer<Stream> {
+        Stream& m_stream;
+        EncodeOptions m_options;
+
+    public:
+        explicit BasicPacker(Stream& stream, const EncodeOptions& options = EncodeOptions{})
+            : msgpack::packer<Stream>(stream),
+              m_stream(stream),
+              m_options(options)
+        {
+        }
+
+        Stream& stream() const noexcept { return m_stream; }
+        // how the messages are checked, the nested values are packed with the same options
+        const EncodeOptions& options() const noexcept { return m_options; }
+
+        void write_packed(const char* data, std::size_t size) { m_stream.write(data, size); }
     };
 
+    using Packer = BasicPacker<PackBuffer>;
+
     struct Packable : public Stringable {
         virtual ~Packable() {}
-        virtual void pack(msgpack::packer<msgpack::sbuffer>&) const = 0;
+        virtual void pack(Packer&) const = 0;
         virtual void unpack(const msgpack::object&) = 0;
+        // types that can be decoded in more than one way override this, the rest ignores the options
+        virtual void unpack(const msgpack::object& obj, const DecodeOptions&) { unpack(obj); }
+        // decodes straight from the packed bytes, the default unpacks the next value into an object first
+        virtual void read(MessageReader& reader, const DecodeOptions& options);
         virtual void validate() const {}
+
+        // packs into a PackBuffer or into any buffer that can be wrapped by the PackBufferAdapter
+        template <typename Buffer>
+        void pack_into(Buffer& buffer, const EncodeOptions& options = EncodeOptions{}) const
+        {
+            if constexpr (std::is_base_of_v<PackBuffer, Buffer>) {
+                Packer packer(buffer, options);
+                pack(packer);
+            } else {
+                PackBufferAdapter<Buffer> adapter(buffer);
+                Packer packer(adapter, options);
+                pack(packer);
+            }
+        }
+
+        // the exact number of bytes written by pack(), computed from the structure of the value: the widths of the msgpack
+        // headers and numbers, the lengths of the strings and the binaries and the sizes of the parts packed already.
+        // Nothing is packed or validated. The types of the SDK override this, the default packs the value into a counter
+        // at the TRUSTED level, so the bytes are not stored, but every value is visited
+        virtual std::size_t encoded_size() const
+        {
+            EncodeOptions options;
+            options.validation = ValidationLevel::TRUSTED;
+            CountingPackBuffer counter;
+            pack_into(counter, options);
+            return counter.size();
+        }
     };
 
     /**
@@ -105,6 +361,70 @@ namespace gds_types {
             EXCEPTION = 2 };
     };
 
+    /**
+ * Layout of the hits of a query reply after decoding
+ */
+    struct HitsLayout {
+        enum Enum {
+            ROWS = 0, // QueryReplyBody::hits, one GdsFieldValue per cell
+            COLUMNS = 1 // QueryReplyBody::columns, one typed array per field
+        };
+    };
+
+    /**
+ * Monotonic memory of a single decoded message body. The memory is taken from the upstream resource in growing blocks,
+ * and it is only given back when the arena is destroyed, at once, instead of freeing every array one by one.
+ * It holds the body object and the arrays of the columns of a columnar query reply only. The header, the descriptors,
+ * the rows of the ROWS layout and whatever a GdsFieldValue allocates (in a VALUE column too) use the global heap.
+ */
+    class MessageArena : public std::pmr::memory_resource {
+        std::pmr::monotonic_buffer_resource m_resource;
+        std::size_t m_allocated = 0;
+
+    protected:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void*, std::size_t, std::size_t) override {}
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    public:
+        explicit MessageArena(std::size_t initial_size, std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+            : m_resource(initial_size, upstream)
+        {
+        }
+
+        // the number of bytes handed out by the arena
+        std::size_t allocated() const noexcept { return m_allocated; }
+        std::pmr::memory_resource* upstream() const noexcept { return m_resource.upstream_resource(); }
+    };
+
+    /**
+ * Options for decoding the received messages
+ */
+    struct DecodeOptions {
+        HitsLayout::Enum hits = HitsLayout::ROWS;
+        // the columns of the hits are allocated from this resource (the default resource if it is not set)
+        std::pmr::memory_resource* resource = nullptr;
+        // every body is decoded into a MessageArena of its own, that takes its memory from the resource above.
+        // The body and its columns are freed together, when the last reference to the body is dropped.
+        // Only the body object and the arrays of the COLUMNS layout are in the arena, see MessageArena: the hits of the ROWS layout
+        // and the strings and binaries inside the field values are allocated from the global heap, so turn it on with the COLUMNS layout
+        bool arena = false;
+        std::size_t arena_block_size = 64 * 1024; // the size of the first block of the arena
+        // the field descriptors of the query replies are interned here, the pages of a query share a single schema
+        std::shared_ptr<SchemaCache> schemas;
+        // how the decoded messages are checked, the clients pack their messages with the same level
+        ValidationLevel::Enum validation = ValidationLevel::FULL;
+        // the threads the rows of the large messages are decoded by (in the ROWS layout), the clients pack with the same options
+        ParallelOptions parallel;
+        // the ARRAY values with only float64 (or only integer) elements are decoded into a double_array_t (integer_array_t),
+        // instead of an array_t of GdsFieldValues. Off by default, as<GdsFieldValue::array_t>() throws for those values
+        bool numeric_arrays = false;
+        // the KEYWORD and TEXT columns of the hits (in the COLUMNS layout) are dictionary encoded, every page has dictionaries of its own
+        bool dictionary_strings = false;
+        // the pages of a scroll share the dictionaries of the scroll from this cache (the string columns are encoded if it is set)
+        std::shared_ptr<DictionaryCache> dictionaries;
+    };
+
     struct GdsMessage : public Packable {
         std::string userName;
         std::string messageId;
@@ -116,12 +436,18 @@ namespace gds_types {
         std::optional<int32_t> offset;
         std::optional<int32_t> fds;
         int32_t dataType;
-        std::shared_ptr<Packable> messageBody;
+        std::shared_ptr<Packable> messageBody; // not decoded for a fragment, see FragmentAssembler
 
-        void pack(msgpack::packer<msgpack::sbuffer>&) const override;
+        void pack(Packer&) const override;
+        std::size_t encoded_size() const override;
         void unpack(const msgpack::object&) override;
+        void unpack(const msgpack::object&, const DecodeOptions&) override;
+        void read(MessageReader&, const DecodeOptions&) override;
+        // decodes a whole packed message without building a msgpack::object tree
+        void unpack(const char* data, std::size_t size, const DecodeOptions& options = DecodeOptions{});
         void validate() const override;
         std::string to_string() const override;
+        void to_json(JsonWriter&) const override;
     };
 
     using gds_message_t = std::shared_ptr<GdsMessage>;
@@ -150,16 +476,207 @@ namespace gds_types {
     using byte_array = std::vector<uint8_t>;
     using field_descriptor = std::array<std::string, 3>;
 
+    /**
+ * Read-only view over a binary value, points into the buffer it was decoded from.
+ */
+    struct byte_view {
+        const uint8_t* data = nullptr;
+        std::size_t size = 0;
+
+        const uint8_t* begin() const noexcept { return data; }
+        const uint8_t* end() const noexcept { return data + size; }
+        bool empty() const noexcept { return size == 0; }
+        byte_array to_array() const { return byte_array(begin(), end()); }
+    };
+
+    /**
+ * Value semantic box for the rarely used, large alternatives of a field value,
+ * so they do not inflate the size of every (mostly scalar) cell.
+ */
+    template <typename T>
+    class value_box {
+        std::unique_ptr<T> m_value;
+
+    public:
+        value_box() = default;
+        value_box(T item)
+            : m_value(std::make_unique<T>(std::move(item)))
+        {
+        }
+        value_box(const value_box& other)
+            : m_value(other.m_value ? std::make_unique<T>(*other.m_value) : nullptr)
+        {
+        }
+        value_box(value_box&&) noexcept = default;
+        value_box& operator=(const value_box& other)
+        {
+            if (this != &other) {
+                m_value = other.m_value ? std::make_unique<T>(*other.m_value) : nullptr;
+            }
+            return *this;
+        }
+        value_box& operator=(value_box&&) noexcept = default;
+
+        const T& get() const
+        {
+            static const T empty{};
+            return m_value ? *m_value : empty;
+        }
+        T& get()
+        {
+            if (!m_value) {
+                m_value = std::make_unique<T>();
+            }
+            return *m_value;
+        }
+    };
+
     struct GdsFieldValue : public Packable {
-        std::any value;
-        msgpack::type::object_type type;
+        using nil_t = std::monostate;
+        using array_t = std::vector<GdsFieldValue>;
+        // the ARRAY values with only float64 (or only integer) elements can be stored contiguously, without a cell for every element.
+        // They are decoded into these only with DecodeOptions::numeric_arrays, into an array_t otherwise
+        using double_array_t = std::vector<double>;
+        using integer_array_t = std::vector<int64_t>;
+        using map_t = flat_map<std::string, std::string>;
+        // the alternatives follow the msgpack types, the strings use the inline storage of std::string when they are short.
+        using value_t = std::variant<nil_t, bool, uint64_t, int64_t, float, double, std::string, byte_array,
+            double_array_t, integer_array_t, value_box<array_t>, value_box<map_t> >;
+
+        value_t value;
+        msgpack::type::object_type type = msgpack::type::NIL;
+
+        GdsFieldValue() = default;
+        template <typename T, typename = std::enable_if_t<!std::is_same_v<std::decay_t<T>, GdsFieldValue> > >
+        explicit GdsFieldValue(T&& item) { set(std::forward<T>(item)); }
+
+        // the stored value, throws std::bad_variant_access if the value holds a different type.
+        // as<std::map<std::string, std::string> >() returns a copy of a MAP value in an std::map, the stored map is a map_t
+        template <typename T>
+        decltype(auto) as() const
+        {
+            if constexpr (std::is_same_v<T, std::map<std::string, std::string> >) {
+                const map_t& items = as<map_t>();
+                return T(items.begin(), items.end());
+            } else {
+                if (const T* item = get_if<T>()) {
+                    return *item;
+                }
+                throw std::bad_variant_access();
+            }
+        }
+        template <typename T>
+        decltype(auto) as()
+        {
+            if constexpr (std::is_same_v<T, std::map<std::string, std::string> >) {
+                return std::as_const(*this).template as<T>();
+            } else {
+                if (T* item = get_if<T>()) {
+                    return *item;
+                }
+                throw std::bad_variant_access();
+            }
+        }
+
+        template <typename T>
+        const T* get_if() const noexcept
+        {
+            if constexpr (std::is_same_v<T, array_t> || std::is_same_v<T, map_t>) {
+                const value_box<T>* box = std::get_if<value_box<T> >(&value);
+                return box ? &box->get() : nullptr;
+            } else {
+                return std::get_if<T>(&value);
+            }
+        }
         template <typename T>
-        T as() const { return std::any_cast<T>(value); }
+        T* get_if() noexcept
+        {
+            if constexpr (std::is_same_v<T, array_t> || std::is_same_v<T, map_t>) {
+                value_box<T>* box = std::get_if<value_box<T> >(&value);
+                return box ? &box->get() : nullptr;
+            } else {
+                return std::get_if<T>(&value);
+            }
+        }
+
+        // the elements of an ARRAY value, whichever way it is stored. Throws std::bad_variant_access if the value is not an array
+        array_t to_array() const;
+
+        // invokes the visitor with the stored value (nil_t, bool, uint64_t, .., double_array_t, integer_array_t, array_t or map_t)
+        template <typename Visitor>
+        decltype(auto) visit(Visitor&& visitor) const
+        {
+            return std::visit([&visitor](const auto& item) -> decltype(auto) {
+                using item_t = std::decay_t<decltype(item)>;
+                if constexpr (std::is_same_v<item_t, value_box<array_t> > || std::is_same_v<item_t, value_box<map_t> >) {
+                    return visitor(item.get());
+                } else {
+                    return visitor(item);
+                }
+            },
+                value);
+        }
+
+        bool is_nil() const noexcept { return std::holds_alternative<nil_t>(value); }
+
+        // stores the value as the alternative of its type (the integers widened to 64 bits) and sets the matching msgpack type
+        template <typename T>
+        void set(T&& item)
+        {
+            using item_t = std::decay_t<T>;
+            if constexpr (std::is_same_v<item_t, nil_t> || std::is_same_v<item_t, std::nullopt_t>) {
+                value.emplace<nil_t>();
+                type = msgpack::type::NIL;
+            } else if constexpr (std::is_same_v<item_t, bool>) {
+                value.emplace<bool>(item);
+                type = msgpack::type::BOOLEAN;
+            } else if constexpr (std::is_integral_v<item_t> && std::is_unsigned_v<item_t>) {
+                value.emplace<uint64_t>(item);
+                type = msgpack::type::POSITIVE_INTEGER;
+            } else if constexpr (std::is_integral_v<item_t>) {
+                // a signed integer stays signed, only the type follows its sign (as it is packed)
+                value.emplace<int64_t>(item);
+                type = item >= 0 ? msgpack::type::POSITIVE_INTEGER : msgpack::type::NEGATIVE_INTEGER;
+            } else if constexpr (std::is_same_v<item_t, float>) {
+                value.emplace<float>(item);
+                type = msgpack::type::FLOAT32;
+            } else if constexpr (std::is_same_v<item_t, double>) {
+                value.emplace<double>(item);
+                type = msgpack::type::FLOAT64;
+            } else if constexpr (std::is_same_v<item_t, byte_array>) {
+                value.emplace<byte_array>(std::forward<T>(item));
+                type = msgpack::type::BIN;
+            } else if constexpr (std::is_same_v<item_t, double_array_t> || std::is_same_v<item_t, integer_array_t>) {
+                value.emplace<item_t>(std::forward<T>(item));
+                type = msgpack::type::ARRAY;
+            } else if constexpr (std::is_same_v<item_t, array_t>) {
+                value.emplace<value_box<array_t> >(std::forward<T>(item));
+                type = msgpack::type::ARRAY;
+            } else if constexpr (std::is_same_v<item_t, map_t>) {
+                value.emplace<value_box<map_t> >(std::forward<T>(item));
+                type = msgpack::type::MAP;
+            } else if constexpr (std::is_same_v<item_t, std::map<std::string, std::string> >) {
+                value.emplace<value_box<map_t> >(map_t(item));
+                type = msgpack::type::MAP;
+            } else {
+                value.emplace<std::string>(std::forward<T>(item));
+                type = msgpack::type::STR;
+            }
+        }
+
         std::string to_string() const override;
 
-        void pack(msgpack::packer<msgpack::sbuffer>&) const override;
+        void to_json(JsonWriter&) const override;
+
+        void pack(Packer&) const override;
+        std::size_t encoded_size() const override;
         void unpack(const msgpack::object&) override;
+        void unpack(const msgpack::object&, const DecodeOptions&) override;
+        void read(MessageReader&, const DecodeOptions&) override;
         void validate() const override;
+
+    private:
+        void unpack_value(const msgpack::object& obj, bool numeric_arrays);
     };
 
     /*3*/
@@ -172,6 +689,7 @@ namespace gds_types {
             std::optional<std::string> version;
             std::optional<std::vector<GdsFieldValue> > values;
             std::string to_string() const override;
+            void to_json(JsonWriter&) const override;
         };
 
         struct GdsEventResult : public Stringable {
@@ -180,13 +698,18 @@ namespace gds_types {
             std::vector<field_descriptor> fieldDescriptor;
             std::vector<EventSubResult> subResults;
             std::string to_string() const override;
+            void to_json(JsonWriter&) const override;
         };
 
         std::vector<GdsEventResult> results;
-        void pack(msgpack::packer<msgpack::sbuffer>&) const override;
+        void pack(Packer&) const override;
+        std::size_t encoded_size() const override;
         void unpack(const msgpack::object&) override;
+        void unpack(const msgpack::object&, const DecodeOptions&) override;
+        void read(MessageReader&, const DecodeOptions&) override;
         void validate() const override;
         std::string to_string() const override;
+        void to_json(JsonWriter&) const override;
     };
 
     struct AttachmentResult : public Packable {
@@ -199,10 +722,14 @@ namespace gds_types {
         std::optional<int64_t> to_valid;
         std::optional<byte_array> attachment;
 
-        void pack(msgpack::packer<msgpack::sbuffer>&) const override;
+        void pack(Packer&) const override;
+        std::size_t encoded_size() const override;
         void unpack(const msgpack::object&) override;
+        void unpack(const msgpack::object&, const DecodeOptions&) override;
+        void read(MessageReader&, const DecodeOptions&) override;
         void validate() const override;
         std::string to_string() const override;
+        void to_json(JsonWriter&) const override;
     };
 
     struct AttachmentRequestBody : public Packable {
@@ -210,10 +737,14 @@ namespace gds_types {
         AttachmentResult result;
         std::optional<int64_t> waitTime;
 
-        void pack(msgpack::packer<msgpack::sbuffer>&) const override;
+        void pack(Packer&) const override;
+        std::size_t encoded_size() const override;
         void unpack(const msgpack::object&) override;
+        void unpack(const msgpack::object&, const DecodeOptions&) override;
+        void read(MessageReader&, const DecodeOptions&) override;
         void validate() const override;
         std::string to_string() const override;
+        void to_json(JsonWriter&) const override;
     };
 
     struct AttachmentResponse : public Packable {
@@ -221,31 +752,42 @@ namespace gds_types {
         std::string ownerTable;
         std::string attachmentID;
 
-        void pack(msgpack::packer<msgpack::sbuffer>&) const override;
+        void pack(Packer&) const override;
+        std::size_t encoded_size() const override;
         void unpack(const msgpack::object&) override;
+        void unpack(const msgpack::object&, const DecodeOptions&) override;
+        void read(MessageReader&, const DecodeOptions&) override;
         void validate() const override;
         std::string to_string() const override;
+        void to_json(JsonWriter&) const override;
     };
 
     struct AttachmentResponseBody : public Packable {
         int32_t status;
         AttachmentResponse result;
 
-        void pack(msgpack::packer<msgpack::sbuffer>&) const override;
+        void pack(Packer&) const override;
+        std::size_t encoded_size() const override;
         void unpack(const msgpack::object&) override;
+        void unpack(const msgpack::object&, const DecodeOptions&) override;
+        void read(MessageReader&, const DecodeOptions&) override;
         void validate() const override;
         std::string to_string() const override;
+        void to_json(JsonWriter&) const override;
     };
 
     struct EventDocumentResult : public Packable {
         int32_t status_code;
         std::optional<std::string> notification;
-        std::map<std::string, GdsFieldValue> returnings;
+        flat_map<std::string, GdsFieldValue> returnings;
 
-        void pack(msgpack::packer<msgpack::sbuffer>&) const override;
+        void pack(Packer&) const override;
+        std::size_t encoded_size() const override;
         void unpack(const msgpack::object&) override;
+        void unpack(const msgpack::object&, const DecodeOptions&) override;
         void validate() const override;
         std::string to_string() const override;
+        void to_json(JsonWriter&) const override;
     };
 
     struct QueryContextDescriptor : public Packable {
@@ -259,10 +801,203 @@ namespace gds_types {
         std::vector<GdsFieldValue> field_values;
         std::vector<std::string> partition_names;
 
-        void pack(msgpack::packer<msgpack::sbuffer>&) const override;
+        void pack(Packer&) const override;
+        std::size_t encoded_size() const override;
         void unpack(const msgpack::object&) override;
+        void read(MessageReader&, const DecodeOptions&) override;
         void validate() const override;
         std::string to_string() const override;
+        void to_json(JsonWriter&) const override;
+    };
+
+    /**
+ * The distinct strings of the dictionary encoded columns. Every string is stored once, the cells hold its code.
+ * Strings are only added, their codes never change and their bytes never move, so the views stay valid as long as
+ * the dictionary is alive (the columns referring to it keep it alive). Code 0 is the empty string, the nil cells have it.
+ * Thread safe, the strings are looked up without a lock, so the pages already decoded can be read while the next page
+ * of the scroll is decoded into the same dictionary. Once max_size strings were added it is full, no more are added.
+ */
+    class StringDictionary {
+        static constexpr std::size_t BLOCK_SIZE = 256; // the views of the strings are allocated in blocks of this many
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<std::string_view, uint32_t> m_codes; // the keys are the stored strings
+        std::vector<std::unique_ptr<std::string_view[]> > m_blocks; // sized up front, so it is never reallocated
+        std::pmr::monotonic_buffer_resource m_bytes; // the bytes of the strings
+        std::size_t m_size = 0;
+        std::size_t m_byte_count = 0;
+        std::size_t m_max_size;
+
+    public:
+        static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+        explicit StringDictionary(std::size_t max_size = 65536);
+
+        StringDictionary(const StringDictionary&) = delete;
+        StringDictionary& operator=(const StringDictionary&) = delete;
+
+        // the code of the string, it is added if it is not in the dictionary yet. npos if it is not and the dictionary is full
+        uint32_t intern(std::string_view word);
+        // the string of a code returned by intern(), no lock is taken
+        std::string_view word(uint32_t code) const noexcept { return m_blocks[code / BLOCK_SIZE][code % BLOCK_SIZE]; }
+
+        std::size_t size() const;
+        // the bytes of the strings, without the views and the lookup table
+        std::size_t byte_count() const;
+        std::size_t max_size() const noexcept { return m_max_size; }
+    };
+
+    /**
+ * Holds the string dictionaries of the recent scrolls by their scroll id, so the pages of a scroll are encoded with
+ * the same dictionaries (one for each field): a value repeated on every page is stored once for the whole result.
+ * Thread safe, it can be shared by the clients. If it is full, the dictionaries of the least recently started scroll
+ * are dropped (the pages holding them keep them alive, the next page of that scroll starts new ones).
+ */
+    class DictionaryCache {
+        using dictionaries_t = std::vector<std::shared_ptr<StringDictionary> >; // by the index of the field
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<std::string, dictionaries_t> m_scrolls;
+        std::vector<std::string> m_order; // the scroll ids in the order they were added, used as a ring
+        std::size_t m_next = 0;
+        std::size_t m_capacity;
+        std::size_t m_dictionary_size;
+
+    public:
+        explicit DictionaryCache(std::size_t capacity = 16, std::size_t dictionary_size = 65536);
+
+        DictionaryCache(const DictionaryCache&) = delete;
+        DictionaryCache& operator=(const DictionaryCache&) = delete;
+
+        // the dictionary of a field of the scroll, a new one if the cache has none for it. A page without a scroll id gets new ones
+        std::shared_ptr<StringDictionary> dictionary(const std::string& scroll_id, std::size_t field);
+
+        // the number of scrolls with dictionaries
+        std::size_t size() const;
+        std::size_t capacity() const noexcept { return m_capacity; }
+        std::size_t dictionary_size() const noexcept { return m_dictionary_size; }
+        void clear();
+    };
+
+    /**
+ * The values of a single field of the query hits, stored column-wise.
+ * The storage is picked by the field type in the descriptor. Nil cells are marked in the validity bitmap,
+ * the typed arrays hold a zero (or empty) placeholder for them, so the row index can be used everywhere.
+ */
+    struct GdsColumn : public Stringable {
+        struct Type {
+            enum Enum {
+                INTEGER = 0, // INTEGER, LONG and DATETIME fields (integers)
+                DOUBLE = 1, // DOUBLE fields (doubles)
+                BOOLEAN = 2, // BOOLEAN fields (booleans)
+                STRING = 3, // KEYWORD and TEXT fields (offsets + bytes, or codes into the dictionary)
+                BINARY = 4, // BINARY fields (offsets + bytes)
+                VALUE = 5 // arrays, maps and unknown field types (values)
+            };
+        };
+
+        Type::Enum type = Type::VALUE;
+        std::size_t size = 0;
+        std::size_t nil_count = 0;
+        std::pmr::vector<uint64_t> validity; // bit ii is set if the value in row ii is not nil
+        std::pmr::vector<int64_t> integers;
+        std::pmr::vector<double> doubles;
+        std::pmr::vector<uint8_t> booleans;
+        std::pmr::vector<uint32_t> offsets; // size + 1 entries, row ii is bytes[offsets[ii], offsets[ii + 1])
+        std::pmr::string bytes;
+        std::pmr::vector<GdsFieldValue> values;
+        // set for a dictionary encoded string column, the cells are codes of the dictionary instead of offsets + bytes.
+        // If the dictionary gets full while the column is decoded, the column falls back to offsets + bytes
+        std::shared_ptr<StringDictionary> dictionary;
+        std::pmr::vector<uint32_t> codes;
+
+        GdsColumn() = default;
+        // the arrays of the column are allocated from the resource
+        explicit GdsColumn(const field_descriptor& descriptor, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+        static Type::Enum type_of(const std::string& field_type);
+
+        bool is_nil(std::size_t row) const noexcept { return !((validity[row >> 6] >> (row & 63)) & 1); }
+        int64_t integer(std::size_t row) const noexcept { return integers[row]; }
+        double floating(std::size_t row) const noexcept { return doubles[row]; }
+        bool boolean(std::size_t row) const noexcept { return booleans[row] != 0; }
+        std::string_view string(std::size_t row) const noexcept
+        {
+            if (dictionary) {
+                return dictionary->word(codes[row]);
+            }
+            return std::string_view(bytes.data() + offsets[row], offsets[row + 1] - offsets[row]);
+        }
+        byte_view binary(std::size_t row) const noexcept
+        {
+            return byte_view{ reinterpret_cast<const uint8_t*>(bytes.data()) + offsets[row], offsets[row + 1] - offsets[row] };
+        }
+        // the cell as a field value (copies strings and binaries)
+        GdsFieldValue value(std::size_t row) const;
+
+        // empties the column for the field, the arrays keep their capacity
+        void reset(const field_descriptor& descriptor);
+        void reserve(std::size_t rows, std::size_t byte_count = 0);
+        // throws msgpack::type_error if the value does not fit the type of the column
+        void push_back(const msgpack::object& cell);
+        void push_back(MessageReader& reader);
+        void pack(Packer&, std::size_t row) const;
+        // the number of bytes pack() writes for the row
+        std::size_t encoded_size(std::size_t row) const;
+        std::string to_string() const override;
+        void to_json(JsonWriter&) const override;
+    };
+
+    /**
+ * The field descriptors of a query result. Every page of a query carries the same descriptors,
+ * with a SchemaCache they are decoded once and the pages share the (immutable) schema.
+ */
+    struct GdsSchema {
+        std::vector<field_descriptor> fields;
+        std::string packed; // the descriptors as they were received, the key of the cache
+        uint64_t hash = 0;
+
+        // the schema of the packed descriptor array, throws msgpack::type_error if it is not one
+        static std::shared_ptr<const GdsSchema> decode(std::string_view packed, uint64_t hash);
+    };
+
+    struct SchemaCacheStats {
+        std::size_t hits = 0; // the descriptors found in the cache
+        std::size_t misses = 0; // the descriptors decoded
+        std::size_t schemas = 0; // the schemas held by the cache
+    };
+
+    /**
+ * Interns the field descriptors of the query replies by the hash of their packed form, so the pages of a paged query
+ * (and the replies of the same select) share one schema object instead of decoding and storing the descriptors again.
+ * The lookup compares the packed bytes too, so a hash collision never hands out a wrong schema.
+ * Thread safe, the cache can be shared by the clients. If it is full, the least recently added schema is dropped
+ * (the replies holding it keep it alive).
+ */
+    class SchemaCache {
+        mutable std::mutex m_mutex;
+        std::unordered_map<uint64_t, std::shared_ptr<const GdsSchema> > m_schemas;
+        std::vector<uint64_t> m_order; // the keys of the cache in the order they were added, used as a ring
+        std::size_t m_next = 0; // the oldest key of the ring once it is full
+        std::size_t m_capacity;
+        SchemaCacheStats m_stats;
+
+    public:
+        explicit SchemaCache(std::size_t capacity = 64);
+
+        SchemaCache(const SchemaCache&) = delete;
+        SchemaCache& operator=(const SchemaCache&) = delete;
+
+        // the schema of the packed descriptor array, decoded only if it is not in the cache yet
+        std::shared_ptr<const GdsSchema> intern(std::string_view packed);
+        // the schema of the descriptor array of a msgpack object, it is hashed and compared without storing its packed form
+        std::shared_ptr<const GdsSchema> intern(const msgpack::object& descriptors);
+        // the schema of the descriptors, packs them to look them up
+        std::shared_ptr<const GdsSchema> intern(const std::vector<field_descriptor>& descriptors);
+
+        SchemaCacheStats stats() const;
+        std::size_t capacity() const noexcept { return m_capacity; }
+        void clear();
     };
 
     struct QueryReplyBody : public Packable {
@@ -270,14 +1005,28 @@ namespace gds_types {
         int64_t filteredHits;
         bool hasMorePages;
         QueryContextDescriptor queryContextDescriptor;
+        // filled with either decode, a copy of the descriptors of the schema if the message was decoded with a SchemaCache
         std::vector<field_descriptor> fieldDescriptors;
+        std::shared_ptr<const GdsSchema> schema;
         std::vector<std::vector<GdsFieldValue> > hits;
+        // set instead of the hits if the message was decoded with HitsLayout::COLUMNS, in the order of the field descriptors,
+        // allocated from the resource of the DecodeOptions
+        std::optional<std::pmr::vector<GdsColumn> > columns;
         int64_t totalNumberOfHits;
 
-        void pack(msgpack::packer<msgpack::sbuffer>&) const override;
+        // the field descriptors, from the schema if the body has one (that is what is packed then)
+        const std::vector<field_descriptor>& descriptors() const noexcept { return schema ? schema->fields : fieldDescriptors; }
+        // the hit at the given index, regardless of the layout
+        std::vector<GdsFieldValue> row(std::size_t index) const;
+
+        void pack(Packer&) const override;
+        std::size_t encoded_size() const override;
         void unpack(const msgpack::object&) override;
+        void unpack(const msgpack::object&, const DecodeOptions&) override;
+        void read(MessageReader&, const DecodeOptions&) override;
         void validate() const override;
         std::string to_string() const override;
+        void to_json(JsonWriter&) const override;
     };
 
     // There's a total of 13 different messages that can be sent - from LOGIN (0) to
@@ -312,41 +1061,93 @@ namespace gds_types {
         {
             return GdsMsgType::LOGIN;
         }
-        void pack(msgpack::packer<msgpack::sbuffer>&) const override;
+        void pack(Packer&) const override;
+        std::size_t encoded_size() const override;
         void unpack(const msgpack::object&) override;
+        void unpack(const msgpack::object&, const DecodeOptions&) override;
         void validate() const override;
         std::string to_string() const override;
+        void to_json(JsonWriter&) const override;
     };
 
     /*1*/
     struct GdsLoginReplyMessage : public GdsACKMessage {
         std::optional<GdsLoginMessage> loginReply;
-        std::optional<std::map<int32_t, std::string> > errorDetails;
+        std::optional<flat_map<int32_t, std::string> > errorDetails;
 
         inline GdsMsgType::Enum type() const noexcept override
         {
             return GdsMsgType::LOGIN_REPLY;
         }
-        void pack(msgpack::packer<msgpack::sbuffer>&) const override;
+        void pack(Packer&) const override;
+        std::size_t encoded_size() const override;
         void unpack(const msgpack::object&) override;
+        void unpack(const msgpack::object&, const DecodeOptions&) override;
         void validate() const override;
         std::string to_string() const override;
+        void to_json(JsonWriter&) const override;
     };
 
     /*2*/
     struct GdsEventMessage : public GdsMessageData {
         std::string operations;
-        std::map<std::string, byte_array> binaryContents;
-        std::vector<std::vector<std::map<int32_t, bool> > > priorityLevels;
+        flat_map<std::string, byte_array> binaryContents;
+        std::vector<std::vector<flat_map<int32_t, bool> > > priorityLevels;
 
         inline GdsMsgType::Enum type() const noexcept override
         {
             return GdsMsgType::EVENT;
         }
-        void pack(msgpack::packer<msgpack::sbuffer>&) const override;
+        void pack(Packer&) const override;
+        std::size_t encoded_size() const override;
         void unpack(const msgpack::object&) override;
+        void unpack(const msgpack::object&, const DecodeOptions&) override;
+        void read(MessageReader&, const DecodeOptions&) override;
         void validate() const override;
         std::string to_string() const override;
+        void to_json(JsonWriter&) const override;
+    };
+
+    /**
+ * Builds the body of an EVENT message incrementally, it can be sent instead of a GdsEventMessage.
+ * The statements are joined into the operations string, the attachments are packed into the buffer
+ * of the builder as they are added, so their bytes are copied only once before the message is sent.
+ */
+    class EventBuilder : public GdsMessageData {
+        std::string m_operations;
+        std::string m_attachments; // the packed id - binary pairs of the binary contents
+        std::vector<std::pair<std::string, std::size_t> > m_attachment_ids; // the ids and sizes, in the order they were added
+
+        void begin_attachment(std::string_view id, std::size_t size);
+
+    public:
+        std::vector<std::vector<flat_map<int32_t, bool> > > priorityLevels;
+
+        explicit EventBuilder(std::size_t operations_capacity = 0, std::size_t attachments_capacity = 0);
+
+        // the statements are separated by a semicolon
+        EventBuilder& add_statement(std::string_view statement);
+        // throws std::invalid_argument if an attachment with the same id was already added
+        EventBuilder& add_attachment(std::string_view id, const uint8_t* data, std::size_t size);
+        EventBuilder& add_attachment(std::string_view id, const byte_array& data) { return add_attachment(id, data.data(), data.size()); }
+        // adds an attachment of `size` bytes and returns where its content has to be written (for example read from a file),
+        // the pointer is valid until the next attachment is added
+        uint8_t* reserve_attachment(std::string_view id, std::size_t size);
+
+        const std::string& operations() const noexcept { return m_operations; }
+        std::size_t attachment_count() const noexcept { return m_attachment_ids.size(); }
+        // empties the builder, keeping its capacity for the next event
+        void clear() noexcept;
+
+        inline GdsMsgType::Enum type() const noexcept override
+        {
+            return GdsMsgType::EVENT;
+        }
+        void pack(Packer&) const override;
+        std::size_t encoded_size() const override;
+        void unpack(const msgpack::object&) override;
+        std::string to_string() const override;
+        void to_json(JsonWriter&) const override;
     };
 
     /*3*/
@@ -357,10 +1158,14 @@ namespace gds_types {
         {
             return GdsMsgType::EVENT_REPLY;
         }
-        void pack(msgpack::packer<msgpack::sbuffer>&) const override;
+        void pack(Packer&) const override;
+        std::size_t encoded_size() const override;
         void unpack(const msgpack::object&) override;
+        void unpack(const msgpack::object&, const DecodeOptions&) override;
+        void read(MessageReader&, const DecodeOptions&) override;
         void validate() const override;
         std::string to_string() const override;
+        void to_json(JsonWriter&) const override;
     };
 
     /*4*/
@@ -370,20 +1175,27 @@ namespace gds_types {
         {
             return GdsMsgType::ATTACHMENT_REQUEST;
         }
-        void pack(msgpack::packer<msgpack::sbuffer>&) const override;
+        void pack(Packer&) const override;
+        std::size_t encoded_size() const override;
         void unpack(const msgpack::object&) override;
+        void unpack(const msgpack::object&, const DecodeOptions&) override;
         void validate() const override;
         std::string to_string() const override;
+        void to_json(JsonWriter&) const override;
     };
 
     /*5*/
     struct GdsAttachmentRequestReplyMessage : public GdsACKMessage {
         std::optional<AttachmentRequestBody> request;
 
-        void pack(msgpack::packer<msgpack::sbuffer>&) const override;
+        void pack(Packer&) const override;
+        std::size_t encoded_size() const override;
         void unpack(const msgpack::object&) override;
+        void unpack(const msgpack::object&, const DecodeOptions&) override;
+        void read(MessageReader&, const DecodeOptions&) override;
         void validate() const override;
         std::string to_string() const override;
+        void to_json(JsonWriter&) const override;
 
         inline GdsMsgType::Enum type() const noexcept override
         {
@@ -395,10 +1207,14 @@ namespace gds_types {
     struct GdsAttachmentResponseMessage : public GdsMessageData {
         AttachmentResult result;
 
-        void pack(msgpack::packer<msgpack::sbuffer>&) const override;
+        void pack(Packer&) const override;
+        std::size_t encoded_size() const override;
         void unpack(const msgpack::object&) override;
+        void unpack(const msgpack::object&, const DecodeOptions&) override;
+        void read(MessageReader&, const DecodeOptions&) override;
         void validate() const override;
         std::string to_string() const override;
+        void to_json(JsonWriter&) const override;
 
         inline GdsMsgType::Enum type() const noexcept override
         {
@@ -410,10 +1226,14 @@ namespace gds_types {
     struct GdsAttachmentResponseResultMessage : public GdsACKMessage {
         std::optional<AttachmentResponseBody> response;
 
-        void pack(msgpack::packer<msgpack::sbuffer>&) const override;
+        void pack(Packer&) const override;
+        std::size_t encoded_size() const override;
         void unpack(const msgpack::object&) override;
+        void unpack(const msgpack::object&, const DecodeOptions&) override;
+        void read(MessageReader&, const DecodeOptions&) override;
         void validate() const override;
         std::string to_string() const override;
+        void to_json(JsonWriter&) const override;
 
         inline GdsMsgType::Enum type() const noexcept override
         {
@@ -426,12 +1246,15 @@ namespace gds_types {
         std::string tableName;
         std::vector<field_descriptor> fieldDescriptors;
         std::vector<std::vector<GdsFieldValue> > records;
-        std::map<int32_t, std::vector<std::string> > returnings;
+        flat_map<int32_t, std::vector<std::string> > returnings;
 
-        void pack(msgpack::packer<msgpack::sbuffer>&) const override;
+        void pack(Packer&) const override;
+        std::size_t encoded_size() const override;
         void unpack(const msgpack::object&) override;
+        void unpack(const msgpack::object&, const DecodeOptions&) override;
         void validate() const override;
         std::string to_string() const override;
+        void to_json(JsonWriter&) const override;
 
         inline GdsMsgType::Enum type() const noexcept override
         {
@@ -443,10 +1266,13 @@ namespace gds_types {
     struct GdsEventDocumentReplyMessage : public GdsACKMessage {
         std::optional<std::vector<EventDocumentResult> > results;
 
-        void pack(msgpack::packer<msgpack::sbuffer>&) const override;
+        void pack(Packer&) const override;
+        std::size_t encoded_size() const override;
         void unpack(const msgpack::object&) override;
+        void unpack(const msgpack::object&, const DecodeOptions&) override;
         void validate() const override;
         std::string to_string() const override;
+        void to_json(JsonWriter&) const override;
 
         inline GdsMsgType::Enum type() const noexcept override
         {
@@ -466,10 +1292,13 @@ namespace gds_types {
         {
             return GdsMsgType::QUERY;
         }
-        void pack(msgpack::packer<msgpack::sbuffer>&) const override;
+        void pack(Packer&) const override;
+        std::size_t encoded_size() const override;
         void unpack(const msgpack::object&) override;
+        void unpack(const msgpack::object&, const DecodeOptions&) override;
         void validate() const override;
         std::string to_string() const override;
+        void to_json(JsonWriter&) const override;
     };
 
     /*11*/
@@ -480,10 +1309,14 @@ namespace gds_types {
         {
             return GdsMsgType::QUERY_REPLY;
         }
-        void pack(msgpack::packer<msgpack::sbuffer>&) const override;
+        void pack(Packer&) const override;
+        std::size_t encoded_size() const override;
         void unpack(const msgpack::object&) override;
+        void unpack(const msgpack::object&, const DecodeOptions&) override;
+        void read(MessageReader&, const DecodeOptions&) override;
         void validate() const override;
         std::string to_string() const override;
+        void to_json(JsonWriter&) const override;
     };
 
     /*12*/
@@ -494,10 +1327,93 @@ namespace gds_types {
         {
             return GdsMsgType::GET_NEXT_QUERY;
         }
-        void pack(msgpack::packer<msgpack::sbuffer>&) const override;
+        void pack(Packer&) const override;
+        std::size_t encoded_size() const override;
         void unpack(const msgpack::object&) override;
+        void unpack(const msgpack::object&, const DecodeOptions&) override;
+        void read(MessageReader&, const DecodeOptions&) override;
         void validate() const override;
         std::string to_string() const override;
+        void to_json(JsonWriter&) const override;
+    };
+
+    /**
+ * The header of a received message, decoded without its body.
+ * The DATA element is kept as packed bytes, pointing into the buffer the header was peeked from,
+ * so it is only valid while that buffer is. The body is decoded on request, by decode_body().
+ */
+    struct GdsMessageHeader : public Stringable {
+        std::string userName;
+        std::string messageId;
+        int64_t createTime;
+        int64_t requestTime;
+        bool isFragmented;
+        std::optional<std::string> firstFragment;
+        std::optional<std::string> lastFragment;
+        std::optional<int32_t> offset;
+        std::optional<int32_t> fds;
+        int32_t dataType;
+        std::string_view body; // the packed DATA element
+
+        // decodes and validates the header of the packed message, the body is not parsed
+        static GdsMessageHeader peek(const char* data, std::size_t size, ValidationLevel::Enum validation = ValidationLevel::FULL);
+
+        // the body decoded by the dataType, nullptr if the type is unknown or the message is a fragment
+        std::shared_ptr<GdsMessageData> decode_body(const DecodeOptions& options = DecodeOptions{}) const;
+        // throws invalid_message_error if the message is not of the type of T
+        template <typename T>
+        std::shared_ptr<T> decode_body(const DecodeOptions& options = DecodeOptions{}) const
+        {
+            static_assert(std::is_base_of_v<GdsMessageData, T>, "the body has to be a GdsMessageData");
+            std::shared_ptr<T> data = std::make_shared<T>();
+            decode_body_into(*data, options);
+            return data;
+        }
+        // the whole message, with the decoded body
+        void decode(GdsMessage& message, const DecodeOptions& options = DecodeOptions{}) const;
+
+        std::string to_string() const override;
+
+        void to_json(JsonWriter&) const override;
+
+    private:
+        void decode_body_into(GdsMessageData& data, const DecodeOptions& options) const;
+    };
+
+    /**
+ * Pre-encoded header for the messages of a single user.
+ * The array header, the user name and the fields of a not fragmented message are packed once,
+ * only the message id, the timestamps and the type are packed for each message.
+ */
+    class GdsHeaderTemplate {
+        std::string m_userName;
+        std::string m_prefix; // the array header and the user name
+
+    public:
+        explicit GdsHeaderTemplate(const std::string& userName);
+
+        const std::string& userName() const noexcept { return m_userName; }
+        // the header of the message can be packed from the template (same user, not fragmented, has a body)
+        bool matches(const GdsMessage& message) const noexcept;
+
+        // packs the header from the template, followed by the body
+        void pack(PackBuffer& buffer, std::string_view messageId, int64_t createTime, int64_t requestTime, int32_t dataType, const Packable& body,
+            const EncodeOptions& options = EncodeOptions{}) const;
+        // packs the message from the template if it matches, by GdsMessage::pack() otherwise
+        void pack(PackBuffer& buffer, const GdsMessage& message, const EncodeOptions& options = EncodeOptions{}) const;
+        // the number of bytes pack() writes for the message, the size of the packed prefix is known
+        std::size_t encoded_size(const GdsMessage& message) const;
+
+        template <typename Buffer>
+        void pack_into(Buffer& buffer, const GdsMessage& message, const EncodeOptions& options = EncodeOptions{}) const
+        {
+            if constexpr (std::is_base_of_v<PackBuffer, Buffer>) {
+                pack(buffer, message, options);
+            } else {
+                PackBufferAdapter<Buffer> adapter(buffer);
+                pack(adapter, message, options);
+            }
+        }
     };
 
 } // namespace gds_types
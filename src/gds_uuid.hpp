@@ -1,41 +1,191 @@
 #ifndef GDS_UUID_HPP
 #define GDS_UUID_HPP
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <optional>
 #include <random>
-#include <sstream>
+#include <string>
+#include <string_view>
 
 namespace uuid {
-static std::mt19937 gen(std::random_device{}());
-static std::uniform_int_distribution<> dis{ 0, 15 };
-static std::uniform_int_distribution<> dis2{ 8, 11 };
-
-static std::string generate_uuid_v4()
-{
-    std::stringstream ss;
-    int i;
-    ss << std::hex;
-    for (i = 0; i < 8; i++) {
-        ss << dis(gen);
+
+    /**
+ * A version 4 UUID in its 16 byte binary form, for correlating the messages without keeping their text ids.
+ * The bytes are in the order of the text form.
+ */
+    struct binary_uuid {
+        std::array<uint8_t, 16> bytes{};
+
+        // the 36 characters of the text form, written to out (not terminated)
+        void format(char* out) const noexcept;
+        std::string to_string() const
+        {
+            std::string text(36, '\0');
+            format(&text[0]);
+            return text;
+        }
+        // the UUID of its text form (either case), nullopt if the text is not a UUID
+        static std::optional<binary_uuid> parse(std::string_view text) noexcept;
+
+        bool operator==(const binary_uuid& other) const noexcept { return bytes == other.bytes; }
+        bool operator!=(const binary_uuid& other) const noexcept { return bytes != other.bytes; }
+        bool operator<(const binary_uuid& other) const noexcept { return bytes < other.bytes; }
+    };
+
+    namespace detail {
+        /**
+ * xoshiro256** seeded from std::random_device. Not thread safe, every thread has a generator of its own,
+ * so generating the ids needs no lock and the threads do not share a cache line.
+ */
+        class random_generator {
+            uint64_t m_state[4];
+
+            static uint64_t rotl(uint64_t value, int bits) noexcept { return (value << bits) | (value >> (64 - bits)); }
+
+        public:
+            random_generator()
+            {
+                std::random_device device;
+                for (uint64_t& word : m_state) {
+                    word = (uint64_t(device()) << 32) | device();
+                }
+                // the state must not be all zero
+                if ((m_state[0] | m_state[1] | m_state[2] | m_state[3]) == 0) {
+                    m_state[0] = 0x9e3779b97f4a7c15ULL;
+                }
+            }
+
+            uint64_t next() noexcept
+            {
+                const uint64_t result = rotl(m_state[1] * 5, 7) * 9;
+                const uint64_t shifted = m_state[1] << 17;
+                m_state[2] ^= m_state[0];
+                m_state[3] ^= m_state[1];
+                m_state[1] ^= m_state[2];
+                m_state[0] ^= m_state[3];
+                m_state[2] ^= shifted;
+                m_state[3] = rotl(m_state[3], 45);
+                return result;
+            }
+        };
+
+        inline random_generator& thread_generator()
+        {
+            thread_local random_generator generator;
+            return generator;
+        }
+
+        // the two hex digits of every byte
+        struct hex_table {
+            char digits[256][2];
+            constexpr hex_table()
+                : digits()
+            {
+                constexpr char hex[] = "0123456789abcdef";
+                for (int value = 0; value < 256; ++value) {
+                    digits[value][0] = hex[value >> 4];
+                    digits[value][1] = hex[value & 0x0f];
+                }
+            }
+        };
+        inline constexpr hex_table hex_digits{};
+
+        inline int hex_value(char digit) noexcept
+        {
+            if (digit >= '0' && digit <= '9') {
+                return digit - '0';
+            }
+            if (digit >= 'a' && digit <= 'f') {
+                return digit - 'a' + 10;
+            }
+            if (digit >= 'A' && digit <= 'F') {
+                return digit - 'A' + 10;
+            }
+            return -1;
+        }
+
+        // the positions of the dashes in the text form
+        inline constexpr bool is_dash(std::size_t position) noexcept
+        {
+            return position == 8 || position == 13 || position == 18 || position == 23;
+        }
+    } // namespace detail
+
+    inline void binary_uuid::format(char* out) const noexcept
+    {
+        for (std::size_t ii = 0; ii < bytes.size(); ++ii) {
+            if (ii == 4 || ii == 6 || ii == 8 || ii == 10) {
+                *out++ = '-';
+            }
+            std::memcpy(out, detail::hex_digits.digits[bytes[ii]], 2);
+            out += 2;
+        }
     }
-    ss << "-";
-    for (i = 0; i < 4; i++) {
-        ss << dis(gen);
+
+    inline std::optional<binary_uuid> binary_uuid::parse(std::string_view text) noexcept
+    {
+        if (text.size() != 36) {
+            return std::nullopt;
+        }
+        binary_uuid id;
+        std::size_t byte = 0;
+        for (std::size_t position = 0; position < text.size(); position += 2) {
+            if (detail::is_dash(position)) {
+                if (text[position] != '-') {
+                    return std::nullopt;
+                }
+                ++position;
+            }
+            const int high = detail::hex_value(text[position]);
+            const int low = detail::hex_value(text[position + 1]);
+            if (high < 0 || low < 0) {
+                return std::nullopt;
+            }
+            id.bytes[byte++] = static_cast<uint8_t>((high << 4) | low);
+        }
+        return id;
     }
-    ss << "-4";
-    for (i = 0; i < 3; i++) {
-        ss << dis(gen);
+
+    // a random (version 4, RFC 4122 variant) UUID from the generator of the calling thread
+    inline binary_uuid generate_binary_uuid_v4() noexcept
+    {
+        detail::random_generator& generator = detail::thread_generator();
+        const uint64_t high = generator.next();
+        const uint64_t low = generator.next();
+        binary_uuid id;
+        for (std::size_t ii = 0; ii < 8; ++ii) {
+            id.bytes[ii] = static_cast<uint8_t>(high >> (56 - 8 * ii));
+            id.bytes[8 + ii] = static_cast<uint8_t>(low >> (56 - 8 * ii));
+        }
+        id.bytes[6] = static_cast<uint8_t>((id.bytes[6] & 0x0f) | 0x40);
+        id.bytes[8] = static_cast<uint8_t>((id.bytes[8] & 0x3f) | 0x80);
+        return id;
     }
-    ss << "-";
-    ss << dis2(gen);
-    for (i = 0; i < 3; i++) {
-        ss << dis(gen);
+
+    // the text form of a random UUID, the message ids are generated by this. Thread safe
+    inline std::string generate_uuid_v4()
+    {
+        return generate_binary_uuid_v4().to_string();
     }
-    ss << "-";
-    for (i = 0; i < 12; i++) {
-        ss << dis(gen);
-    };
-    return ss.str();
-}
-}
+} // namespace uuid
+
+namespace std {
+template <>
+struct hash<uuid::binary_uuid> {
+    std::size_t operator()(const uuid::binary_uuid& id) const noexcept
+    {
+        // the bits are random already, except the version and the variant
+        uint64_t high;
+        uint64_t low;
+        std::memcpy(&high, id.bytes.data(), sizeof(high));
+        std::memcpy(&low, id.bytes.data() + sizeof(high), sizeof(low));
+        return static_cast<std::size_t>(high ^ (low * 0x9e3779b97f4a7c15ULL));
+    }
+};
+} // namespace std
 
 #endif // GDS_UUID_HPP
@@ -0,0 +1,504 @@
+#include "gds_views.hpp"
+
+#include <algorithm>
+
+namespace gds_lib {
+namespace gds_types {
+
+  namespace {
+    // STR, BIN and EXT objects point into the original buffer instead of the zone.
+    bool reference_everything(msgpack::type::object_type, std::size_t, void*)
+    {
+      return true;
+    }
+
+    const msgpack::object* array_of(const msgpack::object& object,
+                                    std::size_t minimum_size,
+                                    GdsMsgType::Enum type)
+    {
+      if (object.type != msgpack::type::ARRAY ||
+          object.via.array.size < minimum_size)
+      {
+        throw invalid_message_error(type);
+      }
+      return object.via.array.ptr;
+    }
+
+    std::size_t array_size(const msgpack::object& object, GdsMsgType::Enum type)
+    {
+      if (object.type != msgpack::type::ARRAY)
+      {
+        throw invalid_message_error(type);
+      }
+      return object.via.array.size;
+    }
+
+    std::string_view string_of(const msgpack::object& object)
+    {
+      if (object.type != msgpack::type::STR)
+      {
+        throw msgpack::type_error();
+      }
+      return std::string_view(object.via.str.ptr, object.via.str.size);
+    }
+
+    std::optional<std::string_view> optional_string_of(const msgpack::object& object)
+    {
+      if (object.is_nil())
+      {
+        return std::nullopt;
+      }
+      return string_of(object);
+    }
+
+    std::vector<std::string_view> strings_of(const msgpack::object& object)
+    {
+      if (object.type != msgpack::type::ARRAY)
+      {
+        throw msgpack::type_error();
+      }
+      std::vector<std::string_view> items;
+      items.reserve(object.via.array.size);
+      for (uint32_t ii = 0; ii < object.via.array.size; ++ii)
+      {
+        items.emplace_back(string_of(object.via.array.ptr[ii]));
+      }
+      return items;
+    }
+
+    field_descriptor_view descriptor_of(const msgpack::object& object)
+    {
+      if (object.type != msgpack::type::ARRAY || object.via.array.size < 3)
+      {
+        throw msgpack::type_error();
+      }
+      const msgpack::object* items = object.via.array.ptr;
+      return {string_of(items[0]), string_of(items[1]), string_of(items[2])};
+    }
+  } // namespace
+
+
+  std::shared_ptr<const MessageBuffer>
+  MessageBuffer::unpack(std::shared_ptr<const void> owner, const char* data,
+                        std::size_t size)
+  {
+    std::shared_ptr<MessageBuffer> buffer(new MessageBuffer());
+    buffer->m_owner = std::move(owner);
+    buffer->m_data = data;
+    buffer->m_size = size;
+    msgpack::unpack(buffer->m_handle, data, size, &reference_everything);
+    return buffer;
+  }
+
+  std::shared_ptr<const MessageBuffer> MessageBuffer::unpack(std::string frame)
+  {
+    std::shared_ptr<const std::string> owner =
+        std::make_shared<const std::string>(std::move(frame));
+    return unpack(owner, owner->data(), owner->size());
+  }
+
+
+  bool FieldValueView::as_bool() const { return m_object->as<bool>(); }
+  int64_t FieldValueView::as_int64() const { return m_object->as<int64_t>(); }
+  uint64_t FieldValueView::as_uint64() const { return m_object->as<uint64_t>(); }
+  double FieldValueView::as_double() const { return m_object->as<double>(); }
+  std::string_view FieldValueView::as_string() const { return string_of(*m_object); }
+
+  byte_view FieldValueView::as_binary() const
+  {
+    if (m_object->type != msgpack::type::BIN)
+    {
+      throw msgpack::type_error();
+    }
+    return {reinterpret_cast<const uint8_t*>(m_object->via.bin.ptr),
+            m_object->via.bin.size};
+  }
+
+  std::size_t FieldValueView::size() const
+  {
+    switch (m_object->type)
+    {
+    case msgpack::type::ARRAY:
+      return m_object->via.array.size;
+    case msgpack::type::MAP:
+      return m_object->via.map.size;
+    default:
+      throw msgpack::type_error();
+    }
+  }
+
+  FieldValueView FieldValueView::operator[](std::size_t index) const
+  {
+    if (m_object->type != msgpack::type::ARRAY)
+    {
+      throw msgpack::type_error();
+    }
+    if (index >= m_object->via.array.size)
+    {
+      throw std::out_of_range("FieldValueView::operator[]");
+    }
+    return FieldValueView{m_object->via.array.ptr[index]};
+  }
+
+  GdsFieldValue FieldValueView::to_value() const
+  {
+    GdsFieldValue value;
+    value.unpack(*m_object);
+    return value;
+  }
+
+
+  RowView::RowView(const msgpack::object& row)
+  {
+    if (row.type != msgpack::type::ARRAY)
+    {
+      throw msgpack::type_error();
+    }
+    m_begin = row.via.array.ptr;
+    m_size = row.via.array.size;
+  }
+
+  FieldValueView RowView::at(std::size_t index) const
+  {
+    if (index >= m_size)
+    {
+      throw std::out_of_range("RowView::at");
+    }
+    return FieldValueView{m_begin[index]};
+  }
+
+  std::vector<GdsFieldValue> RowView::to_values() const
+  {
+    std::vector<GdsFieldValue> values(m_size);
+    for (std::size_t ii = 0; ii < m_size; ++ii)
+    {
+      values[ii].unpack(m_begin[ii]);
+    }
+    return values;
+  }
+
+
+  GdsMessageView::GdsMessageView(message_buffer_t buffer)
+      : MessageViewBase(buffer, buffer->root()),
+        m_fields(array_of(buffer->root(), 11, GdsMsgType::HEADER_MESSAGE)) {}
+
+  std::string_view GdsMessageView::userName() const
+  {
+    return string_of(m_fields[GdsHeader::USER]);
+  }
+
+  std::string_view GdsMessageView::messageId() const
+  {
+    return string_of(m_fields[GdsHeader::ID]);
+  }
+
+  int64_t GdsMessageView::createTime() const
+  {
+    return m_fields[GdsHeader::CREATE_TIME].as<int64_t>();
+  }
+
+  int64_t GdsMessageView::requestTime() const
+  {
+    return m_fields[GdsHeader::REQUEST_TIME].as<int64_t>();
+  }
+
+  bool GdsMessageView::isFragmented() const
+  {
+    return m_fields[GdsHeader::FRAGMENTED].as<bool>();
+  }
+
+  std::optional<std::string_view> GdsMessageView::firstFragment() const
+  {
+    return optional_string_of(m_fields[GdsHeader::FIRST_FRAGMENT]);
+  }
+
+  std::optional<std::string_view> GdsMessageView::lastFragment() const
+  {
+    return optional_string_of(m_fields[GdsHeader::LAST_FRAGMENT]);
+  }
+
+  std::optional<int32_t> GdsMessageView::offset() const
+  {
+    return m_fields[GdsHeader::OFFSET].as<std::optional<int32_t>>();
+  }
+
+  std::optional<int32_t> GdsMessageView::fds() const
+  {
+    return m_fields[GdsHeader::FULL_DATA_SIZE].as<std::optional<int32_t>>();
+  }
+
+  int32_t GdsMessageView::dataType() const
+  {
+    return m_fields[GdsHeader::DATA_TYPE].as<int32_t>();
+  }
+
+  void GdsMessageView::unpack(GdsMessage& message, const DecodeOptions& options) const
+  {
+    message.unpack(*m_object, options);
+  }
+
+
+  AckView::AckView(message_buffer_t buffer, const msgpack::object& object)
+      : MessageViewBase(std::move(buffer), object),
+        m_fields(array_of(object, 3, GdsMsgType::UNKNOWN)) {}
+
+  int32_t AckView::ackStatus() const
+  {
+    return m_fields[GdsReplyMsg::STATUS].as<int32_t>();
+  }
+
+  std::optional<std::string_view> AckView::ackException() const
+  {
+    return optional_string_of(m_fields[GdsReplyMsg::EXCEPTION]);
+  }
+
+
+  AttachmentResultView::AttachmentResultView(message_buffer_t buffer,
+                                             const msgpack::object& object)
+      : MessageViewBase(std::move(buffer), object)
+  {
+    if (object.type != msgpack::type::MAP)
+    {
+      throw invalid_message_error(GdsMsgType::ATTACHMENT);
+    }
+  }
+
+  const msgpack::object* AttachmentResultView::find(std::string_view key) const
+  {
+    const msgpack::object_kv* begin = m_object->via.map.ptr;
+    const msgpack::object_kv* end = begin + m_object->via.map.size;
+    for (const msgpack::object_kv* it = begin; it != end; ++it)
+    {
+      if (it->key.type == msgpack::type::STR && string_of(it->key) == key)
+      {
+        return &it->val;
+      }
+    }
+    return nullptr;
+  }
+
+  const msgpack::object& AttachmentResultView::get(std::string_view key) const
+  {
+    const msgpack::object* value = find(key);
+    if (!value)
+    {
+      throw std::out_of_range(std::string(key));
+    }
+    return *value;
+  }
+
+  std::vector<std::string_view> AttachmentResultView::requestIDs() const
+  {
+    return strings_of(get("requestids"));
+  }
+
+  std::string_view AttachmentResultView::ownerTable() const
+  {
+    return string_of(get("ownertable"));
+  }
+
+  std::string_view AttachmentResultView::attachmentID() const
+  {
+    return string_of(get("attachmentid"));
+  }
+
+  std::vector<std::string_view> AttachmentResultView::ownerIDs() const
+  {
+    return strings_of(get("ownerids"));
+  }
+
+  std::optional<std::string_view> AttachmentResultView::meta() const
+  {
+    const msgpack::object* value = find("meta");
+    return value ? optional_string_of(*value) : std::nullopt;
+  }
+
+  std::optional<int64_t> AttachmentResultView::ttl() const
+  {
+    const msgpack::object* value = find("ttl");
+    return value ? value->as<std::optional<int64_t>>() : std::nullopt;
+  }
+
+  std::optional<int64_t> AttachmentResultView::to_valid() const
+  {
+    const msgpack::object* value = find("to_valid");
+    return value ? value->as<std::optional<int64_t>>() : std::nullopt;
+  }
+
+  std::optional<byte_view> AttachmentResultView::attachment() const
+  {
+    const msgpack::object* value = find("attachment");
+    if (!value || value->is_nil())
+    {
+      return std::nullopt;
+    }
+    return FieldValueView{*value}.as_binary();
+  }
+
+
+  int32_t AttachmentRequestReplyView::status() const
+  {
+    return array_of(data(), 3, TYPE)[0].as<int32_t>();
+  }
+
+  AttachmentResultView AttachmentRequestReplyView::result() const
+  {
+    return AttachmentResultView(m_buffer, array_of(data(), 3, TYPE)[1]);
+  }
+
+  std::optional<int64_t> AttachmentRequestReplyView::waitTime() const
+  {
+    return array_of(data(), 3, TYPE)[2].as<std::optional<int64_t>>();
+  }
+
+
+  AttachmentResponseView::AttachmentResponseView(message_buffer_t buffer,
+                                                 const msgpack::object& object)
+      : MessageViewBase(std::move(buffer), object)
+  {
+    array_of(object, 1, TYPE);
+  }
+
+  AttachmentResultView AttachmentResponseView::result() const
+  {
+    return AttachmentResultView(m_buffer, m_object->via.array.ptr[0]);
+  }
+
+
+  EventDocumentView::EventDocumentView(message_buffer_t buffer,
+                                       const msgpack::object& object)
+      : MessageViewBase(std::move(buffer), object),
+        m_fields(array_of(object, 3, TYPE)) {}
+
+  std::string_view EventDocumentView::tableName() const
+  {
+    return string_of(m_fields[0]);
+  }
+
+  std::size_t EventDocumentView::fieldCount() const
+  {
+    return array_size(m_fields[1], TYPE);
+  }
+
+  field_descriptor_view EventDocumentView::fieldDescriptor(std::size_t index) const
+  {
+    if (index >= fieldCount())
+    {
+      throw std::out_of_range("EventDocumentView::fieldDescriptor");
+    }
+    return descriptor_of(m_fields[1].via.array.ptr[index]);
+  }
+
+  std::size_t EventDocumentView::recordCount() const
+  {
+    return array_size(m_fields[2], TYPE);
+  }
+
+  RowView EventDocumentView::record(std::size_t index) const
+  {
+    if (index >= recordCount())
+    {
+      throw std::out_of_range("EventDocumentView::record");
+    }
+    return RowView(m_fields[2].via.array.ptr[index]);
+  }
+
+
+  QueryReplyView::QueryReplyView(message_buffer_t buffer,
+                                 const msgpack::object& object)
+      : AckView(std::move(buffer), object)
+  {
+    if (has_data())
+    {
+      array_of(data(), 6, TYPE);
+    }
+  }
+
+  const msgpack::object* QueryReplyView::body(std::size_t index) const
+  {
+    if (!has_data())
+    {
+      throw invalid_message_error(TYPE, "the reply has no response body");
+    }
+    return &data().via.array.ptr[index];
+  }
+
+  int64_t QueryReplyView::numberOfHits() const { return body(0)->as<int64_t>(); }
+  int64_t QueryReplyView::filteredHits() const { return body(1)->as<int64_t>(); }
+  bool QueryReplyView::hasMorePages() const { return body(2)->as<bool>(); }
+
+  QueryContextDescriptor QueryReplyView::queryContextDescriptor() const
+  {
+    QueryContextDescriptor descriptor;
+    descriptor.unpack(*body(3));
+    return descriptor;
+  }
+
+  std::size_t QueryReplyView::fieldCount() const
+  {
+    return array_size(*body(4), TYPE);
+  }
+
+  field_descriptor_view QueryReplyView::fieldDescriptor(std::size_t index) const
+  {
+    if (index >= fieldCount())
+    {
+      throw std::out_of_range("QueryReplyView::fieldDescriptor");
+    }
+    return descriptor_of(body(4)->via.array.ptr[index]);
+  }
+
+  std::size_t QueryReplyView::hitCount() const
+  {
+    return array_size(*body(5), TYPE);
+  }
+
+  RowView QueryReplyView::hit(std::size_t index) const
+  {
+    if (index >= hitCount())
+    {
+      throw std::out_of_range("QueryReplyView::hit");
+    }
+    return RowView(body(5)->via.array.ptr[index]);
+  }
+
+  std::optional<int64_t> QueryReplyView::totalNumberOfHits() const
+  {
+    if (!has_data() || data().via.array.size < 7)
+    {
+      return std::nullopt;
+    }
+    return body(6)->as<int64_t>();
+  }
+
+
+  QueryRowCursor::QueryRowCursor(QueryReplyView reply)
+      : m_reply(std::move(reply)),
+        m_size(m_reply.hitCount()) {}
+
+  RowView QueryRowCursor::next_view()
+  {
+    if (!has_next())
+    {
+      throw std::out_of_range("QueryRowCursor::next_view");
+    }
+    return m_reply.hit(m_position++);
+  }
+
+  bool QueryRowCursor::next(std::vector<GdsFieldValue>& row)
+  {
+    if (!has_next())
+    {
+      return false;
+    }
+    RowView view = next_view();
+    row.resize(view.size());
+    for (std::size_t ii = 0; ii < view.size(); ++ii)
+    {
+      row[ii].unpack(view[ii].object());
+    }
+    return true;
+  }
+
+} // namespace gds_types
+} // namespace gds_lib
@@ -0,0 +1,264 @@
+#ifndef GDS_VIEWS_HPP
+#define GDS_VIEWS_HPP
+
+#include "gds_types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include <msgpack.hpp>
+
+namespace gds_lib {
+namespace gds_types {
+
+    /**
+ * Owns a received frame and the msgpack zone unpacked over it.
+ * Strings and binaries in the unpacked tree reference the frame bytes instead of
+ * being copied, so everything handed out by the views below stays valid as long as
+ * a shared pointer to this buffer is alive.
+ */
+    class MessageBuffer {
+    public:
+        // the owner keeps `data` alive (for example the WebSocket message that holds the bytes).
+        static std::shared_ptr<const MessageBuffer> unpack(std::shared_ptr<const void> owner, const char* data, std::size_t size);
+        // takes ownership of an already received frame.
+        static std::shared_ptr<const MessageBuffer> unpack(std::string frame);
+
+        const msgpack::object& root() const noexcept { return m_handle.get(); }
+        const char* data() const noexcept { return m_data; }
+        std::size_t size() const noexcept { return m_size; }
+
+        MessageBuffer(const MessageBuffer&) = delete;
+        MessageBuffer& operator=(const MessageBuffer&) = delete;
+
+    private:
+        MessageBuffer() = default;
+
+        std::shared_ptr<const void> m_owner;
+        const char* m_data = nullptr;
+        std::size_t m_size = 0;
+        msgpack::object_handle m_handle;
+    };
+
+    using message_buffer_t = std::shared_ptr<const MessageBuffer>;
+
+    /**
+ * A single GDS field value (cell) inside a received message.
+ * Views of this kind, just like the row views, are only valid while the message buffer they come from is alive.
+ */
+    class FieldValueView {
+        const msgpack::object* m_object;
+
+    public:
+        explicit FieldValueView(const msgpack::object& object) noexcept
+            : m_object(&object)
+        {
+        }
+
+        msgpack::type::object_type type() const noexcept { return m_object->type; }
+        bool is_nil() const noexcept { return m_object->is_nil(); }
+
+        bool as_bool() const;
+        int64_t as_int64() const;
+        uint64_t as_uint64() const;
+        double as_double() const;
+        std::string_view as_string() const;
+        byte_view as_binary() const;
+
+        std::size_t size() const; // number of elements for ARRAY and MAP values
+        FieldValueView operator[](std::size_t index) const; // ARRAY elements
+
+        GdsFieldValue to_value() const;
+        const msgpack::object& object() const noexcept { return *m_object; }
+    };
+
+    class RowView {
+        const msgpack::object* m_begin;
+        std::size_t m_size;
+
+    public:
+        explicit RowView(const msgpack::object& row);
+
+        std::size_t size() const noexcept { return m_size; }
+        FieldValueView operator[](std::size_t index) const { return FieldValueView{ m_begin[index] }; }
+        FieldValueView at(std::size_t index) const;
+
+        std::vector<GdsFieldValue> to_values() const;
+    };
+
+    using field_descriptor_view = std::array<std::string_view, 3>;
+
+    /**
+ * Shared part of the views, holds the buffer and the object the view was created over.
+ */
+    class MessageViewBase {
+    protected:
+        message_buffer_t m_buffer;
+        const msgpack::object* m_object;
+
+        MessageViewBase(message_buffer_t buffer, const msgpack::object& object)
+            : m_buffer(std::move(buffer)),
+              m_object(&object)
+        {
+        }
+
+    public:
+        const message_buffer_t& buffer() const noexcept { return m_buffer; }
+        const msgpack::object& object() const noexcept { return *m_object; }
+    };
+
+    /**
+ * Header view over a received message. The DATA part can be accessed through the typed body views.
+ */
+    class GdsMessageView : public MessageViewBase {
+        const msgpack::object* m_fields;
+
+    public:
+        explicit GdsMessageView(message_buffer_t buffer);
+
+        std::string_view userName() const;
+        std::string_view messageId() const;
+        int64_t createTime() const;
+        int64_t requestTime() const;
+        bool isFragmented() const;
+        std::optional<std::string_view> firstFragment() const;
+        std::optional<std::string_view> lastFragment() const;
+        std::optional<int32_t> offset() const;
+        std::optional<int32_t> fds() const;
+        int32_t dataType() const;
+        const msgpack::object& data() const noexcept { return m_fields[GdsHeader::DATA]; }
+
+        // the body view has to match the dataType of the message
+        template <typename BodyView>
+        BodyView body() const
+        {
+            if (dataType() != BodyView::TYPE) {
+                throw invalid_message_error(BodyView::TYPE, "the message has a different data type");
+            }
+            return BodyView(m_buffer, data());
+        }
+
+        // decodes the message into the owned structures
+        void unpack(GdsMessage& message, const DecodeOptions& options = DecodeOptions{}) const;
+    };
+
+    /**
+ * Common part of the ACK messages (status, data, exception).
+ */
+    class AckView : public MessageViewBase {
+    protected:
+        const msgpack::object* m_fields;
+
+    public:
+        AckView(message_buffer_t buffer, const msgpack::object& object);
+
+        int32_t ackStatus() const;
+        std::optional<std::string_view> ackException() const;
+        bool has_data() const noexcept { return !m_fields[GdsReplyMsg::DATA].is_nil(); }
+        const msgpack::object& data() const noexcept { return m_fields[GdsReplyMsg::DATA]; }
+    };
+
+    class AttachmentResultView : public MessageViewBase {
+        const msgpack::object* find(std::string_view key) const;
+        const msgpack::object& get(std::string_view key) const;
+
+    public:
+        AttachmentResultView(message_buffer_t buffer, const msgpack::object& object);
+
+        std::vector<std::string_view> requestIDs() const;
+        std::string_view ownerTable() const;
+        std::string_view attachmentID() const;
+        std::vector<std::string_view> ownerIDs() const;
+        std::optional<std::string_view> meta() const;
+        std::optional<int64_t> ttl() const;
+        std::optional<int64_t> to_valid() const;
+        std::optional<byte_view> attachment() const;
+    };
+
+    /*5*/
+    class AttachmentRequestReplyView : public AckView {
+    public:
+        static constexpr GdsMsgType::Enum TYPE = GdsMsgType::ATTACHMENT_REQUEST_REPLY;
+        using AckView::AckView;
+
+        int32_t status() const;
+        AttachmentResultView result() const;
+        std::optional<int64_t> waitTime() const;
+    };
+
+    /*6*/
+    class AttachmentResponseView : public MessageViewBase {
+    public:
+        static constexpr GdsMsgType::Enum TYPE = GdsMsgType::ATTACHMENT;
+        AttachmentResponseView(message_buffer_t buffer, const msgpack::object& object);
+
+        AttachmentResultView result() const;
+    };
+
+    /*8*/
+    class EventDocumentView : public MessageViewBase {
+        const msgpack::object* m_fields;
+
+    public:
+        static constexpr GdsMsgType::Enum TYPE = GdsMsgType::EVENT_DOCUMENT;
+        EventDocumentView(message_buffer_t buffer, const msgpack::object& object);
+
+        std::string_view tableName() const;
+        std::size_t fieldCount() const;
+        field_descriptor_view fieldDescriptor(std::size_t index) const;
+        std::size_t recordCount() const;
+        RowView record(std::size_t index) const;
+    };
+
+    /*11*/
+    class QueryReplyView : public AckView {
+        const msgpack::object* body(std::size_t index) const;
+
+    public:
+        static constexpr GdsMsgType::Enum TYPE = GdsMsgType::QUERY_REPLY;
+        QueryReplyView(message_buffer_t buffer, const msgpack::object& object);
+
+        int64_t numberOfHits() const;
+        int64_t filteredHits() const;
+        bool hasMorePages() const;
+        // the context is needed for the next page request, so it is decoded into the owned structure
+        QueryContextDescriptor queryContextDescriptor() const;
+        std::size_t fieldCount() const;
+        field_descriptor_view fieldDescriptor(std::size_t index) const;
+        std::size_t hitCount() const;
+        RowView hit(std::size_t index) const;
+        std::optional<int64_t> totalNumberOfHits() const;
+    };
+
+    /**
+ * Forward-only cursor over the hits of a query reply. Every row is decoded only when it is reached,
+ * so the decoded page does not have to be kept in memory.
+ */
+    class QueryRowCursor {
+        QueryReplyView m_reply;
+        std::size_t m_size;
+        std::size_t m_position = 0;
+
+    public:
+        explicit QueryRowCursor(QueryReplyView reply);
+
+        // the rest of the reply (status, field descriptors, context of the next page)
+        const QueryReplyView& reply() const noexcept { return m_reply; }
+        std::size_t size() const noexcept { return m_size; }
+        std::size_t position() const noexcept { return m_position; }
+        bool has_next() const noexcept { return m_position < m_size; }
+
+        // the next row without decoding it, throws std::out_of_range at the end of the hits
+        RowView next_view();
+        // decodes the next row into `row` (reusing its capacity), returns false at the end of the hits
+        bool next(std::vector<GdsFieldValue>& row);
+    };
+
+} // namespace gds_types
+} // namespace gds_lib
+
+#endif // GDS_VIEWS_HPP
@@ -0,0 +1,90 @@
+#ifndef GDS_FIXTURES_HPP
+#define GDS_FIXTURES_HPP
+
+#include "gds_types.hpp"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Sample messages shared by the tests and the benchmarks.
+ */
+namespace gds_fixtures {
+
+    // a message with a filled header of the given type and no body
+    inline gds_lib::gds_types::GdsMessage make_header(int32_t type)
+    {
+        gds_lib::gds_types::GdsMessage message;
+        message.userName = "user";
+        message.messageId = "message-1";
+        message.createTime = 1;
+        message.requestTime = 2;
+        message.isFragmented = false;
+        message.dataType = type;
+        return message;
+    }
+
+    // a query reply with the given number of rows of 6 fields: keyword, integer, double (or nil), boolean, binary, keyword
+    inline gds_lib::gds_types::GdsMessage make_query_reply(std::size_t rows)
+    {
+        using namespace gds_lib::gds_types;
+
+        GdsMessage message = make_header(GdsMsgType::QUERY_REPLY);
+        auto body = std::make_shared<GdsQueryReplyMessage>();
+        body->ackStatus = 200;
+
+        QueryReplyBody reply;
+        reply.numberOfHits = static_cast<int64_t>(rows);
+        reply.filteredHits = 0;
+        reply.hasMorePages = true;
+        reply.totalNumberOfHits = static_cast<int64_t>(rows);
+        QueryContextDescriptor& context = reply.queryContextDescriptor;
+        context.scroll_id = "scroll";
+        context.select_query = "SELECT * FROM multi_event";
+        context.delivered_hits = static_cast<int64_t>(rows);
+        context.query_start_time = 5;
+        context.consistency_type = "PAGES";
+        context.last_bucket_id = "bucket";
+        context.gds_holder = {"cluster", "node"};
+        context.partition_names = {"multi_event_1"};
+        reply.fieldDescriptors = {{"id", "KEYWORD", "text/plain"}, {"count", "INTEGER", ""}, {"speed", "DOUBLE", ""},
+                                  {"ok", "BOOLEAN", ""}, {"image", "BINARY", ""}, {"status", "KEYWORD", ""}};
+
+        const char* statuses[] = {"active", "inactive", "unknown"};
+        reply.hits.reserve(rows);
+        for (std::size_t row = 0; row < rows; ++row) {
+            std::vector<GdsFieldValue> hit;
+            hit.reserve(6);
+            hit.emplace_back(std::string("id") + std::to_string(row));
+            hit.emplace_back(static_cast<int64_t>(row) - 3);
+            hit.emplace_back(row % 5 == 0 ? GdsFieldValue() : GdsFieldValue(double(row) * 0.5));
+            hit.emplace_back(row % 2 == 1);
+            hit.emplace_back(byte_array(row % 7, static_cast<uint8_t>(row)));
+            hit.emplace_back(std::string(statuses[row % 3]));
+            reply.hits.push_back(std::move(hit));
+        }
+        body->response = std::move(reply);
+        message.messageBody = body;
+        return message;
+    }
+
+    // the packed bytes of the message
+    inline std::string pack_message(const gds_lib::gds_types::GdsMessage& message)
+    {
+        msgpack::sbuffer buffer;
+        message.pack_into(buffer);
+        return std::string(buffer.data(), buffer.size());
+    }
+
+    inline gds_lib::gds_types::GdsMessage unpack_message(const std::string& packed)
+    {
+        gds_lib::gds_types::GdsMessage message;
+        message.unpack(packed.data(), packed.size());
+        return message;
+    }
+
+} // namespace gds_fixtures
+
+#endif // GDS_FIXTURES_HPP
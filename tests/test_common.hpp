@@ -0,0 +1,54 @@
+#ifndef GDS_TEST_COMMON_HPP
+#define GDS_TEST_COMMON_HPP
+
+#include "fixtures.hpp"
+
+#include <cstdio>
+#include <string>
+
+/**
+ * A minimal harness for the tests: CHECK records a failure and goes on, EXPECT_THROW checks the type of the exception.
+ * Every test program returns the number of failed checks, so ctest reports it as failed.
+ */
+namespace gds_test {
+
+    inline int& failures()
+    {
+        static int count = 0;
+        return count;
+    }
+
+    inline void fail(const char* expression, const char* file, int line)
+    {
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+        ++failures();
+    }
+
+    using gds_fixtures::make_header;
+    using gds_fixtures::make_query_reply;
+    using gds_fixtures::pack_message;
+    using gds_fixtures::unpack_message;
+
+} // namespace gds_test
+
+#define CHECK(expression) \
+    do { \
+        if (!(expression)) { \
+            gds_test::fail(#expression, __FILE__, __LINE__); \
+        } \
+    } while (0)
+
+#define EXPECT_THROW(statement, exception) \
+    do { \
+        bool thrown = false; \
+        try { \
+            statement; \
+        } catch (const exception&) { \
+            thrown = true; \
+        } \
+        if (!thrown) { \
+            gds_test::fail(#statement " throws " #exception, __FILE__, __LINE__); \
+        } \
+    } while (0)
+
+#endif // GDS_TEST_COMMON_HPP
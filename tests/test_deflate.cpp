@@ -0,0 +1,146 @@
+// The permessage-deflate extension: the handshake parameters, and the messages compressed and inflated again
+// with and without context takeover, up to the inflated size limit, and the inflater failing when the context is lost
+#include "test_common.hpp"
+#include "gds_deflate.hpp"
+
+using namespace gds_lib::connection;
+using gds_lib::gds_types::invalid_message_error;
+
+namespace {
+  // a payload that compresses like the messages do: repeated names with changing values
+  std::string sample_payload(std::size_t rows)
+  {
+    std::string payload;
+    for (std::size_t row = 0; row < rows; ++row)
+    {
+      payload += "multi_event_id_" + std::to_string(row) + "\xa6" + "active" + std::to_string(row * 7919 % 1000);
+    }
+    return payload;
+  }
+
+  void test_offer()
+  {
+    DeflateOptions options;
+    options.enabled = true;
+    CHECK(DeflateParameters::offer(options) == "permessage-deflate; client_max_window_bits");
+    options.client_max_window_bits = 12;
+    options.server_no_context_takeover = true;
+    const std::string offer = DeflateParameters::offer(options);
+    CHECK(offer.find("client_max_window_bits=12") != std::string::npos);
+    CHECK(offer.find("server_no_context_takeover") != std::string::npos);
+  }
+
+  void test_accept()
+  {
+    DeflateOptions options;
+    options.enabled = true;
+    CHECK(!DeflateParameters::accept("x-webkit-deflate-frame", options));
+
+    auto parameters = DeflateParameters::accept("foo, permessage-deflate; client_max_window_bits=10; server_no_context_takeover", options);
+    CHECK(parameters && parameters->client_max_window_bits == 10);
+    CHECK(parameters && parameters->server_no_context_takeover && !parameters->client_no_context_takeover);
+
+    EXPECT_THROW(DeflateParameters::accept("permessage-deflate; unknown_parameter", options), std::invalid_argument);
+    EXPECT_THROW(DeflateParameters::accept("permessage-deflate; server_max_window_bits=7", options), std::invalid_argument);
+    EXPECT_THROW(DeflateParameters::accept("permessage-deflate; server_max_window_bits=10; server_max_window_bits=10", options),
+                 std::invalid_argument);
+
+    // the server has to compress with the window it was asked for or a smaller one
+    options.server_max_window_bits = 10;
+    parameters = DeflateParameters::accept("permessage-deflate; server_max_window_bits=9", options);
+    CHECK(parameters && parameters->server_max_window_bits == 9);
+    EXPECT_THROW(DeflateParameters::accept("permessage-deflate; server_max_window_bits=12", options), std::invalid_argument);
+    EXPECT_THROW(DeflateParameters::accept("permessage-deflate", options), std::invalid_argument);
+  }
+
+  void test_round_trip()
+  {
+    // shorter than the window, so a repeated message can refer to the previous one
+    const std::string payload = sample_payload(500);
+    const std::string large = sample_payload(20000);
+    const std::string small = sample_payload(2);
+    for (bool no_context_takeover : {false, true})
+    {
+      MessageDeflater deflater(-1, 15, no_context_takeover);
+      MessageInflater inflater(no_context_takeover, 64 * 1024 * 1024);
+      std::string compressed, inflated;
+
+      deflater.compress(payload.data(), payload.size(), compressed);
+      const std::size_t first_size = compressed.size();
+      CHECK(first_size < payload.size());
+      inflater.decompress(compressed.data(), compressed.size(), inflated);
+      CHECK(inflated == payload);
+
+      // with context takeover the second copy refers to the first one, so it is much shorter
+      deflater.compress(payload.data(), payload.size(), compressed);
+      CHECK(no_context_takeover ? compressed.size() == first_size : compressed.size() < first_size / 2);
+      inflater.decompress(compressed.data(), compressed.size(), inflated);
+      CHECK(inflated == payload);
+
+      deflater.compress(large.data(), large.size(), compressed);
+      inflater.decompress(compressed.data(), compressed.size(), inflated);
+      CHECK(inflated == large);
+
+      deflater.compress(small.data(), small.size(), compressed);
+      inflater.decompress(compressed.data(), compressed.size(), inflated);
+      CHECK(inflated == small);
+    }
+    EXPECT_THROW(MessageDeflater(-1, 8, false), std::invalid_argument);
+  }
+
+  void test_limits()
+  {
+    const std::string payload = sample_payload(20000);
+    MessageDeflater deflater(-1, 15, true);
+    std::string compressed, inflated;
+    deflater.compress(payload.data(), payload.size(), compressed);
+
+    MessageInflater limited(true, payload.size() - 1);
+    EXPECT_THROW(limited.decompress(compressed.data(), compressed.size(), inflated), invalid_message_error);
+    // the inflater is reset after the error, the next message is inflated
+    const std::string small = sample_payload(2);
+    std::string compressed_small;
+    deflater.compress(small.data(), small.size(), compressed_small);
+    limited.decompress(compressed_small.data(), compressed_small.size(), inflated);
+    CHECK(inflated == small);
+
+    MessageInflater inflater(true, 64 * 1024 * 1024);
+    const std::string corrupt(100, '\xff');
+    EXPECT_THROW(inflater.decompress(corrupt.data(), corrupt.size(), inflated), invalid_message_error);
+    inflater.decompress(compressed.data(), compressed.size(), inflated);
+    CHECK(inflated == payload);
+    CHECK(!inflater.failed());
+  }
+
+  // with context takeover the inflater cannot skip a message, it fails for the rest of the connection
+  void test_context_lost()
+  {
+    MessageDeflater deflater(-1, 15, false);
+    const std::string payload = sample_payload(20000);
+    const std::string small = sample_payload(2);
+    std::string compressed, compressed_small, inflated;
+    deflater.compress(payload.data(), payload.size(), compressed);
+    deflater.compress(small.data(), small.size(), compressed_small);
+
+    MessageInflater limited(false, payload.size() - 1);
+    CHECK(!limited.failed());
+    EXPECT_THROW(limited.decompress(compressed.data(), compressed.size(), inflated), invalid_message_error);
+    CHECK(limited.failed());
+    EXPECT_THROW(limited.decompress(compressed_small.data(), compressed_small.size(), inflated), invalid_message_error);
+
+    MessageInflater inflater(false, 64 * 1024 * 1024);
+    const std::string corrupt(100, '\xff');
+    EXPECT_THROW(inflater.decompress(corrupt.data(), corrupt.size(), inflated), invalid_message_error);
+    CHECK(inflater.failed());
+  }
+}
+
+int main()
+{
+  test_offer();
+  test_accept();
+  test_round_trip();
+  test_limits();
+  test_context_lost();
+  return gds_test::failures();
+}
@@ -0,0 +1,264 @@
+// encoded_size() is computed from the structure of the values, it has to be the number of bytes pack() writes:
+// for every message type, at the boundaries of the msgpack header and integer widths, in both hit layouts,
+// with the parts packed already (the attachments of an EventBuilder, the prefix of a GdsHeaderTemplate)
+#include "test_common.hpp"
+
+#include <limits>
+
+using namespace gds_lib::gds_types;
+
+namespace {
+  // packed without the checks, some of the values are at the edges of the protocol
+  EncodeOptions trusted()
+  {
+    EncodeOptions options;
+    options.validation = ValidationLevel::TRUSTED;
+    return options;
+  }
+
+  std::size_t packed_bytes(const Packable& value)
+  {
+    msgpack::sbuffer buffer;
+    value.pack_into(buffer, trusted());
+    return buffer.size();
+  }
+
+  void check_size(const Packable& value)
+  {
+    CHECK(value.encoded_size() == packed_bytes(value));
+  }
+
+  GdsMessage with_body(int32_t type, std::shared_ptr<Packable> body)
+  {
+    GdsMessage message = gds_test::make_header(type);
+    message.messageBody = std::move(body);
+    return message;
+  }
+
+  // the values at the boundaries of the widths the packer picks
+  void test_field_values()
+  {
+    const int64_t integers[] = {0, 127, 128, 255, 256, 65535, 65536, 4294967295LL, 4294967296LL, std::numeric_limits<int64_t>::max(),
+                                -1, -32, -33, -128, -129, -32768, -32769, -2147483648LL, -2147483649LL, std::numeric_limits<int64_t>::min()};
+    for (int64_t number : integers) {
+      check_size(GdsFieldValue(number));
+      check_size(GdsFieldValue(static_cast<uint64_t>(number)));
+    }
+    for (std::size_t length : {0, 31, 32, 255, 256, 65535, 65536}) {
+      check_size(GdsFieldValue(std::string(length, 'x')));
+      check_size(GdsFieldValue(byte_array(length, 1)));
+    }
+    check_size(GdsFieldValue());
+    check_size(GdsFieldValue(true));
+    check_size(GdsFieldValue(1.5f));
+    check_size(GdsFieldValue(2.5));
+    for (std::size_t count : {0, 15, 16, 65535, 65536}) {
+      check_size(GdsFieldValue(GdsFieldValue::double_array_t(count, 0.5)));
+      check_size(GdsFieldValue(GdsFieldValue::integer_array_t(count, -200)));
+      check_size(GdsFieldValue(GdsFieldValue::array_t(count, GdsFieldValue(int64_t(300)))));
+    }
+    GdsFieldValue::map_t items;
+    for (int index = 0; index < 20; ++index) {
+      items[std::to_string(index)] = std::string(index * 2, 'v');
+    }
+    check_size(GdsFieldValue(items));
+  }
+
+  void test_headers()
+  {
+    GdsMessage message = with_body(GdsMsgType::ATTACHMENT_REQUEST, nullptr);
+    check_size(message);
+    message.isFragmented = true;
+    message.firstFragment = "first";
+    message.lastFragment = std::string(40, 'l');
+    message.offset = 70000;
+    message.fds = 1 << 20;
+    message.userName = std::string(300, 'u');
+    message.createTime = -5;
+    check_size(message);
+  }
+
+  void test_messages()
+  {
+    auto login = std::make_shared<GdsLoginMessage>();
+    login->serve_on_the_same_connection = false;
+    login->protocol_version_number = (2 << 16) | 9;
+    login->fragmentation_supported = false;
+    check_size(with_body(GdsMsgType::LOGIN, login));
+    login->cluster_name = "cluster";
+    login->fragmentation_supported = true;
+    login->fragment_transmission_unit = 4096;
+    login->reserved_fields = std::vector<std::string>{"password"};
+    check_size(with_body(GdsMsgType::LOGIN, login));
+
+    auto loginReply = std::make_shared<GdsLoginReplyMessage>();
+    loginReply->ackStatus = 401;
+    loginReply->errorDetails = flat_map<int32_t, std::string>{};
+    loginReply->errorDetails.value()[3] = "wrong password";
+    loginReply->ackException = "unauthorized";
+    check_size(with_body(GdsMsgType::LOGIN_REPLY, loginReply));
+    loginReply->ackStatus = 200;
+    loginReply->errorDetails.reset();
+    loginReply->ackException.reset();
+    loginReply->loginReply = *login;
+    check_size(with_body(GdsMsgType::LOGIN_REPLY, loginReply));
+
+    auto event = std::make_shared<GdsEventMessage>();
+    event->operations = "INSERT INTO multi_event VALUES('id1')";
+    event->binaryContents["small"] = byte_array(10, 1);
+    event->binaryContents["large"] = byte_array(70000, 2);
+    event->priorityLevels = {{flat_map<int32_t, bool>{}}};
+    event->priorityLevels[0][0][1] = true;
+    event->priorityLevels[0][0][300] = false;
+    check_size(with_body(GdsMsgType::EVENT, event));
+
+    auto eventReply = std::make_shared<GdsEventReplyMessage>();
+    eventReply->ackStatus = 200;
+    check_size(with_body(GdsMsgType::EVENT_REPLY, eventReply));
+    EventReplyBody replyBody;
+    EventReplyBody::GdsEventResult result;
+    result.status = 201;
+    result.notification = "";
+    result.fieldDescriptor = {{"id", "KEYWORD", ""}};
+    EventReplyBody::EventSubResult subResult;
+    subResult.status = 201;
+    subResult.id = "id1";
+    subResult.created = true;
+    subResult.values = std::vector<GdsFieldValue>{GdsFieldValue(int64_t(-40)), GdsFieldValue(std::string("text"))};
+    result.subResults = {subResult, subResult};
+    replyBody.results = {result};
+    eventReply->reply = replyBody;
+    check_size(with_body(GdsMsgType::EVENT_REPLY, eventReply));
+
+    auto attachmentRequest = std::make_shared<GdsAttachmentRequestMessage>();
+    attachmentRequest->request = "SELECT meta, data FROM multi_event-@attachment WHERE id='a1' and ownerid='id1'";
+    check_size(with_body(GdsMsgType::ATTACHMENT_REQUEST, attachmentRequest));
+
+    AttachmentResult attachment;
+    attachment.requestIDs = {"request-1"};
+    attachment.ownerTable = "multi_event";
+    attachment.attachmentID = "a1";
+    attachment.ownerIDs = {"id1", "id2"};
+    attachment.meta = "image/png";
+    attachment.ttl = 100000;
+    attachment.attachment = byte_array(300, 3);
+
+    auto attachmentReply = std::make_shared<GdsAttachmentRequestReplyMessage>();
+    attachmentReply->ackStatus = 200;
+    AttachmentRequestBody requestBody;
+    requestBody.status = 200;
+    requestBody.result = attachment;
+    attachmentReply->request = requestBody;
+    check_size(with_body(GdsMsgType::ATTACHMENT_REQUEST_REPLY, attachmentReply));
+    attachmentReply->request.reset();
+    attachmentReply->ackException = "not found";
+    check_size(with_body(GdsMsgType::ATTACHMENT_REQUEST_REPLY, attachmentReply));
+
+    auto attachmentResponse = std::make_shared<GdsAttachmentResponseMessage>();
+    attachmentResponse->result = attachment;
+    check_size(with_body(GdsMsgType::ATTACHMENT, attachmentResponse));
+
+    auto responseResult = std::make_shared<GdsAttachmentResponseResultMessage>();
+    responseResult->ackStatus = 200;
+    AttachmentResponseBody responseBody;
+    responseBody.status = 201;
+    responseBody.result.requestIDs = {"request-1"};
+    responseBody.result.ownerTable = "multi_event";
+    responseBody.result.attachmentID = "a1";
+    responseResult->response = responseBody;
+    check_size(with_body(GdsMsgType::ATTACHMENT_REPLY, responseResult));
+
+    auto document = std::make_shared<GdsEventDocumentMessage>();
+    document->tableName = "multi_event";
+    document->fieldDescriptors = {{"id", "KEYWORD", ""}, {"count", "INTEGER", ""}};
+    for (int row = 0; row < 20; ++row) {
+      document->records.push_back({GdsFieldValue(std::to_string(row)), GdsFieldValue(int64_t(row * 1000))});
+    }
+    check_size(with_body(GdsMsgType::EVENT_DOCUMENT, document));
+
+    auto documentReply = std::make_shared<GdsEventDocumentReplyMessage>();
+    documentReply->ackStatus = 200;
+    EventDocumentResult documentResult;
+    documentResult.status_code = 201;
+    documentResult.notification = "created";
+    documentReply->results = std::vector<EventDocumentResult>{documentResult, documentResult};
+    check_size(with_body(GdsMsgType::EVENT_DOCUMENT_REPLY, documentReply));
+
+    auto query = std::make_shared<GdsQueryRequestMessage>();
+    query->selectString = "SELECT * FROM multi_event";
+    query->consistency = "PAGES";
+    query->timeout = 60000;
+    check_size(with_body(GdsMsgType::QUERY, query));
+    query->queryPageSize = 300;
+    query->queryType = 1;
+    check_size(with_body(GdsMsgType::QUERY, query));
+
+    check_size(gds_test::make_query_reply(0));
+    check_size(gds_test::make_query_reply(70000));
+
+    auto nextQuery = std::make_shared<GdsNextQueryRequestMessage>();
+    nextQuery->contextDescriptor = std::static_pointer_cast<GdsQueryReplyMessage>(gds_test::make_query_reply(3).messageBody)->response->queryContextDescriptor;
+    nextQuery->contextDescriptor.field_values = {GdsFieldValue(std::string("last")), GdsFieldValue(int64_t(-1))};
+    nextQuery->timeout = 60000;
+    check_size(with_body(GdsMsgType::GET_NEXT_QUERY, nextQuery));
+  }
+
+  // the columns of a reply decoded in the COLUMNS layout, with and without the dictionaries of the strings
+  void test_columns()
+  {
+    const std::string packed = gds_test::pack_message(gds_test::make_query_reply(1000));
+    for (bool dictionary : {false, true}) {
+      DecodeOptions options;
+      options.hits = HitsLayout::COLUMNS;
+      options.dictionary_strings = dictionary;
+      GdsMessage message;
+      message.unpack(packed.data(), packed.size(), options);
+      CHECK(message.encoded_size() == packed.size());
+      CHECK(packed_bytes(message) == packed.size());
+    }
+  }
+
+  void test_packed_parts()
+  {
+    auto builder = std::make_shared<EventBuilder>();
+    builder->add_statement("INSERT INTO multi_event VALUES('id1')");
+    builder->add_attachment("a1", byte_array(100000, 4));
+    builder->add_attachment("a2", byte_array(5, 5));
+    GdsMessage event = with_body(GdsMsgType::EVENT, builder);
+    check_size(event);
+
+    const GdsHeaderTemplate header("user");
+    CHECK(header.matches(event));
+    msgpack::sbuffer buffer;
+    header.pack_into(buffer, event, trusted());
+    CHECK(header.encoded_size(event) == buffer.size());
+    event.userName = "other";
+    CHECK(!header.matches(event));
+    CHECK(header.encoded_size(event) == event.encoded_size());
+  }
+
+  // a Packable of an application is counted by packing it
+  struct Custom : public Packable {
+    std::string text = std::string(100, 'c');
+    void pack(Packer& packer) const override { packer.pack(text); }
+    void unpack(const msgpack::object& obj) override { obj.convert(text); }
+    std::string to_string() const override { return text; }
+  };
+
+  void test_custom()
+  {
+    check_size(Custom());
+    check_size(with_body(GdsMsgType::ATTACHMENT_REQUEST, std::make_shared<Custom>()));
+  }
+}
+
+int main()
+{
+  test_field_values();
+  test_headers();
+  test_messages();
+  test_columns();
+  test_packed_parts();
+  test_custom();
+  return gds_test::failures();
+}
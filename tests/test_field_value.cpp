@@ -0,0 +1,83 @@
+// GdsFieldValue::set keeps the alternative of the value it is given, the MAP values convert to an std::map, and the values survive a pack and unpack
+#include "test_common.hpp"
+
+#include <map>
+#include <variant>
+
+using namespace gds_lib::gds_types;
+
+namespace {
+  GdsFieldValue round_trip(const GdsFieldValue& value)
+  {
+    msgpack::sbuffer buffer;
+    value.pack_into(buffer);
+    const msgpack::object_handle handle = msgpack::unpack(buffer.data(), buffer.size());
+    GdsFieldValue decoded;
+    decoded.unpack(handle.get());
+    return decoded;
+  }
+
+  void test_set_keeps_the_alternative()
+  {
+    GdsFieldValue value;
+    value.set(int64_t(5));
+    CHECK(value.type == msgpack::type::POSITIVE_INTEGER);
+    CHECK(value.as<int64_t>() == 5);
+    CHECK(value.get_if<uint64_t>() == nullptr);
+
+    value.set(int64_t(-5));
+    CHECK(value.type == msgpack::type::NEGATIVE_INTEGER);
+    CHECK(value.as<int64_t>() == -5);
+
+    value.set(int32_t(7));
+    CHECK(value.as<int64_t>() == 7);
+
+    value.set(uint64_t(9));
+    CHECK(value.type == msgpack::type::POSITIVE_INTEGER);
+    CHECK(value.as<uint64_t>() == 9);
+    EXPECT_THROW(value.as<int64_t>(), std::bad_variant_access);
+
+    value.set(std::string("text"));
+    CHECK(value.type == msgpack::type::STR);
+    CHECK(value.as<std::string>() == "text");
+  }
+
+  using string_map = std::map<std::string, std::string>;
+
+  void test_std_map()
+  {
+    const string_map entries = {{"b", "2"}, {"a", "1"}};
+    GdsFieldValue value;
+    value.set(entries);
+    CHECK(value.type == msgpack::type::MAP);
+    CHECK(value.as<GdsFieldValue::map_t>().at("a") == "1");
+    CHECK(value.as<string_map>() == entries);
+    CHECK(round_trip(value).as<string_map>() == entries);
+
+    value.set(std::string("text"));
+    EXPECT_THROW(value.as<string_map>(), std::bad_variant_access);
+  }
+
+  void test_round_trip()
+  {
+    // the decoded integers are uint64_t if positive and int64_t if negative, whatever they were packed from
+    const GdsFieldValue positive = round_trip(GdsFieldValue(int64_t(5)));
+    CHECK(positive.type == msgpack::type::POSITIVE_INTEGER);
+    CHECK(positive.as<uint64_t>() == 5);
+    const GdsFieldValue negative = round_trip(GdsFieldValue(int64_t(-5)));
+    CHECK(negative.as<int64_t>() == -5);
+
+    const GdsFieldValue speed = round_trip(GdsFieldValue(2.5));
+    CHECK(speed.as<double>() == 2.5);
+    const GdsFieldValue nil = round_trip(GdsFieldValue());
+    CHECK(nil.is_nil());
+  }
+}
+
+int main()
+{
+  test_set_keeps_the_alternative();
+  test_std_map();
+  test_round_trip();
+  return gds_test::failures();
+}
@@ -0,0 +1,153 @@
+// MessageFragmenter and FragmentAssembler: a fragmented message is reassembled byte for byte, also interleaved with
+// another one, and the fragments out of order or over the limits are rejected
+#include "test_common.hpp"
+#include "gds_fragments.hpp"
+
+#include <vector>
+
+using namespace gds_lib::gds_types;
+
+namespace {
+  std::string packed_event(const std::string& id, std::size_t bytes)
+  {
+    GdsMessage message = gds_test::make_header(GdsMsgType::EVENT);
+    message.messageId = id;
+    auto body = std::make_shared<GdsEventMessage>();
+    body->operations = "INSERT INTO multi_event (id) VALUES('x')";
+    byte_array data(bytes);
+    for (std::size_t index = 0; index < bytes; ++index)
+    {
+      data[index] = static_cast<uint8_t>(index * 7);
+    }
+    body->binaryContents["attachment"] = data;
+    message.messageBody = body;
+    return gds_test::pack_message(message);
+  }
+
+  std::vector<std::string> fragments_of(const std::string& packed, std::size_t unit)
+  {
+    MessageFragmenter fragmenter(packed.data(), packed.size(), unit);
+    std::vector<std::string> fragments;
+    for (std::size_t index = 0; index < fragmenter.count(); ++index)
+    {
+      msgpack::sbuffer buffer;
+      fragmenter.pack_into(buffer, index);
+      fragments.emplace_back(buffer.data(), buffer.size());
+    }
+    return fragments;
+  }
+
+  std::shared_ptr<const std::string> add(FragmentAssembler& assembler, const std::string& fragment)
+  {
+    return assembler.add(GdsMessageHeader::peek(fragment.data(), fragment.size()));
+  }
+
+  void test_fragmenter()
+  {
+    const std::string packed = packed_event("msg-a", 200000);
+    const std::vector<std::string> fragments = fragments_of(packed, 65536);
+    CHECK(fragments.size() == (GdsMessageHeader::peek(packed.data(), packed.size()).body.size() + 65535) / 65536);
+    CHECK(fragments_of(packed_event("msg-b", 10), 65536).size() == 1);
+    for (const std::string& fragment : fragments)
+    {
+      GdsMessage message = gds_test::unpack_message(fragment);
+      CHECK(message.isFragmented);
+      CHECK(message.firstFragment == std::optional<std::string>("msg-a"));
+      CHECK(message.lastFragment == std::optional<std::string>(gds_test::unpack_message(fragments.back()).messageId));
+    }
+    EXPECT_THROW(MessageFragmenter(packed.data(), packed.size(), 0), std::invalid_argument);
+  }
+
+  void test_round_trip()
+  {
+    const std::string first = packed_event("msg-a", 300000);
+    const std::string second = packed_event("msg-b", 100000);
+    const std::vector<std::string> first_fragments = fragments_of(first, 65536);
+    const std::vector<std::string> second_fragments = fragments_of(second, 65536);
+
+    // the fragments of the two messages are interleaved
+    FragmentAssembler assembler;
+    std::shared_ptr<const std::string> first_result, second_result;
+    for (std::size_t index = 0; index < std::max(first_fragments.size(), second_fragments.size()); ++index)
+    {
+      if (index < first_fragments.size())
+      {
+        auto result = add(assembler, first_fragments[index]);
+        CHECK(!result == (index + 1 < first_fragments.size()));
+        if (result)
+        {
+          first_result = result;
+        }
+      }
+      if (index < second_fragments.size())
+      {
+        auto result = add(assembler, second_fragments[index]);
+        CHECK(!result == (index + 1 < second_fragments.size()));
+        if (result)
+        {
+          second_result = result;
+        }
+      }
+    }
+    CHECK(first_result && *first_result == first);
+    CHECK(second_result && *second_result == second);
+
+    FragmentStats stats = assembler.stats();
+    CHECK(stats.messages == 2);
+    CHECK(stats.pending == 0);
+    CHECK(stats.dropped == 0);
+    CHECK(stats.fragments == first_fragments.size() + second_fragments.size());
+  }
+
+  void test_out_of_order()
+  {
+    const std::vector<std::string> fragments = fragments_of(packed_event("msg-a", 300000), 65536);
+    {
+      // a message has to start with its first fragment
+      FragmentAssembler assembler;
+      EXPECT_THROW(add(assembler, fragments[1]), invalid_message_error);
+      CHECK(assembler.stats().dropped == 1);
+    }
+    {
+      // a skipped fragment drops the partial message, so the rest of it is rejected too
+      FragmentAssembler assembler;
+      CHECK(!add(assembler, fragments[0]));
+      EXPECT_THROW(add(assembler, fragments[2]), invalid_message_error);
+      CHECK(assembler.stats().pending == 0);
+      EXPECT_THROW(add(assembler, fragments[1]), invalid_message_error);
+    }
+  }
+
+  void test_limits()
+  {
+    const std::vector<std::string> large = fragments_of(packed_event("msg-a", 600000), 65536);
+    const std::vector<std::string> small = fragments_of(packed_event("msg-b", 100000), 65536);
+    {
+      FragmentOptions options;
+      options.max_message_size = 500000;
+      FragmentAssembler assembler(options);
+      EXPECT_THROW(add(assembler, large[0]), invalid_message_error);
+      CHECK(!add(assembler, small[0]));
+    }
+    {
+      // the oldest partial message is dropped for a new one
+      FragmentOptions options;
+      options.max_pending = 1;
+      FragmentAssembler assembler(options);
+      CHECK(!add(assembler, large[0]));
+      CHECK(!add(assembler, small[0]));
+      CHECK(assembler.stats().dropped == 1);
+      CHECK(assembler.stats().pending == 1);
+      EXPECT_THROW(add(assembler, large[1]), invalid_message_error);
+    }
+  }
+}
+
+int main()
+{
+  test_fragmenter();
+  test_round_trip();
+  test_out_of_order();
+  test_limits();
+  return gds_test::failures();
+}
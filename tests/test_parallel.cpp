@@ -0,0 +1,105 @@
+// The rows packed and decoded on the threads of a WorkerPool give the same bytes as on the calling thread,
+// and an invalid row in any chunk throws. On a single core the rows are handled by the calling thread
+#include "test_common.hpp"
+
+#include <thread>
+
+using namespace gds_lib::gds_types;
+
+namespace {
+  GdsMessage make_event_document(std::size_t rows)
+  {
+    GdsMessage message = gds_test::make_header(GdsMsgType::EVENT_DOCUMENT);
+    auto body = std::make_shared<GdsEventDocumentMessage>();
+    body->tableName = "multi_event";
+    body->fieldDescriptors = {{"id", "KEYWORD", ""}, {"count", "INTEGER", ""}};
+    body->records.reserve(rows);
+    for (std::size_t row = 0; row < rows; ++row)
+    {
+      std::vector<GdsFieldValue> record;
+      record.emplace_back("id" + std::to_string(row));
+      record.emplace_back(static_cast<int64_t>(row));
+      body->records.push_back(std::move(record));
+    }
+    message.messageBody = body;
+    return message;
+  }
+
+  std::string pack_with(const GdsMessage& message, const EncodeOptions& options)
+  {
+    msgpack::sbuffer buffer;
+    message.pack_into(buffer, options);
+    return std::string(buffer.data(), buffer.size());
+  }
+
+  ParallelOptions make_parallel()
+  {
+    ParallelOptions parallel;
+    parallel.pool = std::make_shared<WorkerPool>(3);
+    parallel.min_rows = 100;
+    return parallel;
+  }
+
+  void test_same_bytes()
+  {
+    const ParallelOptions parallel = make_parallel();
+    EncodeOptions encode;
+    encode.parallel = parallel;
+    DecodeOptions decode;
+    decode.parallel = parallel;
+
+    const GdsMessage reply = gds_test::make_query_reply(20000);
+    const GdsMessage document = make_event_document(20000);
+    const std::string packed_reply = gds_test::pack_message(reply);
+    const std::string packed_document = gds_test::pack_message(document);
+
+    // the messages packed and decoded at the same time share the pool
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < 3; ++thread)
+    {
+      threads.emplace_back([&]() {
+        CHECK(pack_with(reply, encode) == packed_reply);
+        CHECK(pack_with(document, encode) == packed_document);
+
+        GdsMessage read;
+        read.unpack(packed_reply.data(), packed_reply.size(), decode);
+        CHECK(gds_test::pack_message(read) == packed_reply);
+
+        const msgpack::object_handle handle = msgpack::unpack(packed_document.data(), packed_document.size());
+        GdsMessage unpacked;
+        unpacked.unpack(handle.get(), decode);
+        CHECK(gds_test::pack_message(unpacked) == packed_document);
+      });
+    }
+    for (std::thread& thread : threads)
+    {
+      thread.join();
+    }
+  }
+
+  void test_invalid_chunk()
+  {
+    const ParallelOptions parallel = make_parallel();
+    GdsMessage document = make_event_document(20000);
+    std::static_pointer_cast<GdsEventDocumentMessage>(document.messageBody)->records[15000].pop_back();
+
+    EncodeOptions encode;
+    encode.parallel = parallel;
+    EXPECT_THROW(pack_with(document, encode), invalid_message_error);
+
+    EncodeOptions trusted;
+    trusted.validation = ValidationLevel::TRUSTED;
+    const std::string packed = pack_with(document, trusted);
+    DecodeOptions decode;
+    decode.parallel = parallel;
+    GdsMessage message;
+    EXPECT_THROW(message.unpack(packed.data(), packed.size(), decode), invalid_message_error);
+  }
+}
+
+int main()
+{
+  test_same_bytes();
+  test_invalid_chunk();
+  return gds_test::failures();
+}
@@ -0,0 +1,87 @@
+// binary_uuid::parse and format, and the generated ids: their version and variant bits, and no repeats across threads
+#include "test_common.hpp"
+#include "gds_uuid.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+  void test_parse_format()
+  {
+    const std::string text = "0123abcd-4567-4def-89ab-0123456789ab";
+    const std::optional<uuid::binary_uuid> id = uuid::binary_uuid::parse(text);
+    CHECK(id.has_value());
+    CHECK(id && id->bytes[0] == 0x01 && id->bytes[3] == 0xcd && id->bytes[6] == 0x4d && id->bytes[15] == 0xab);
+    CHECK(id && id->to_string() == text);
+
+    std::string upper = text;
+    std::transform(upper.begin(), upper.end(), upper.begin(), [](unsigned char ch) { return static_cast<char>(std::toupper(ch)); });
+    CHECK(uuid::binary_uuid::parse(upper) == id);
+
+    CHECK(!uuid::binary_uuid::parse(""));
+    CHECK(!uuid::binary_uuid::parse(text.substr(1)));
+    CHECK(!uuid::binary_uuid::parse(text + "0"));
+    CHECK(!uuid::binary_uuid::parse(std::string(36, 'a')));
+    std::string wrong = text;
+    wrong[0] = 'g';
+    CHECK(!uuid::binary_uuid::parse(wrong));
+    wrong = text;
+    wrong[8] = '0';
+    CHECK(!uuid::binary_uuid::parse(wrong));
+  }
+
+  void test_generate()
+  {
+    const std::string text = uuid::generate_uuid_v4();
+    CHECK(text.size() == 36);
+    CHECK(text[14] == '4');
+    CHECK(std::string("89ab").find(text[19]) != std::string::npos);
+    const std::optional<uuid::binary_uuid> id = uuid::binary_uuid::parse(text);
+    CHECK(id && id->to_string() == text);
+  }
+
+  void test_unique_across_threads()
+  {
+    constexpr int threads = 4;
+    constexpr int per_thread = 50000;
+    std::mutex mutex;
+    std::unordered_set<uuid::binary_uuid> ids;
+    bool versions = true;
+    std::vector<std::thread> workers;
+    for (int thread = 0; thread < threads; ++thread)
+    {
+      workers.emplace_back([&]() {
+        std::vector<uuid::binary_uuid> generated;
+        generated.reserve(per_thread);
+        for (int index = 0; index < per_thread; ++index)
+        {
+          generated.push_back(uuid::generate_binary_uuid_v4());
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const uuid::binary_uuid& id : generated)
+        {
+          versions = versions && (id.bytes[6] >> 4) == 4 && (id.bytes[8] & 0xc0) == 0x80;
+          ids.insert(id);
+        }
+      });
+    }
+    for (std::thread& worker : workers)
+    {
+      worker.join();
+    }
+    CHECK(versions);
+    CHECK(ids.size() == std::size_t(threads) * per_thread);
+  }
+}
+
+int main()
+{
+  test_parse_format();
+  test_generate();
+  test_unique_across_threads();
+  return gds_test::failures();
+}
@@ -0,0 +1,75 @@
+// The validation level given in the options reaches the bodies of the messages, when packing and when decoding
+#include "test_common.hpp"
+
+using namespace gds_lib::gds_types;
+
+namespace {
+  // a login breaking a rule of the protocol: the reserved fields are present, but empty
+  GdsMessage make_invalid_login()
+  {
+    GdsMessage message = gds_test::make_header(GdsMsgType::LOGIN);
+    auto body = std::make_shared<GdsLoginMessage>();
+    body->serve_on_the_same_connection = false;
+    body->protocol_version_number = 1;
+    body->fragmentation_supported = false;
+    body->reserved_fields.emplace();
+    message.messageBody = body;
+    return message;
+  }
+
+  std::string pack_with(const GdsMessage& message, ValidationLevel::Enum level)
+  {
+    EncodeOptions options;
+    options.validation = level;
+    msgpack::sbuffer buffer;
+    message.pack_into(buffer, options);
+    return std::string(buffer.data(), buffer.size());
+  }
+
+  void test_pack()
+  {
+    const GdsMessage message = make_invalid_login();
+    EXPECT_THROW(gds_test::pack_message(message), invalid_message_error);
+    EXPECT_THROW(pack_with(message, ValidationLevel::FULL), invalid_message_error);
+    CHECK(!pack_with(message, ValidationLevel::STRUCTURAL).empty());
+
+    const GdsHeaderTemplate header("user");
+    msgpack::sbuffer buffer;
+    EXPECT_THROW(header.pack_into(buffer, message), invalid_message_error);
+    EncodeOptions trusted;
+    trusted.validation = ValidationLevel::TRUSTED;
+    msgpack::sbuffer trusted_buffer;
+    header.pack_into(trusted_buffer, message, trusted);
+    CHECK(std::string(trusted_buffer.data(), trusted_buffer.size()) == pack_with(message, ValidationLevel::TRUSTED));
+  }
+
+  void test_decode()
+  {
+    const std::string packed = pack_with(make_invalid_login(), ValidationLevel::TRUSTED);
+    EXPECT_THROW(gds_test::unpack_message(packed), invalid_message_error);
+
+    DecodeOptions structural;
+    structural.validation = ValidationLevel::STRUCTURAL;
+    GdsMessage read;
+    read.unpack(packed.data(), packed.size(), structural);
+    CHECK(read.messageBody != nullptr);
+
+    const msgpack::object_handle handle = msgpack::unpack(packed.data(), packed.size());
+    GdsMessage full;
+    EXPECT_THROW(full.unpack(handle.get()), invalid_message_error);
+    GdsMessage unpacked;
+    unpacked.unpack(handle.get(), structural);
+    CHECK(unpacked.messageBody != nullptr);
+
+    const GdsMessageHeader header = GdsMessageHeader::peek(packed.data(), packed.size(), ValidationLevel::TRUSTED);
+    EXPECT_THROW(header.decode_body(), invalid_message_error);
+    CHECK(header.decode_body(structural) != nullptr);
+  }
+}
+
+int main()
+{
+  test_pack();
+  test_decode();
+  return gds_test::failures();
+}